@@ -40,24 +40,76 @@ struct ConstraintsStatistic {
 
     void update(const Constraint& constraint);
 
+    /// Update with a fulfilled state that is not stored in the constraint itself
+    void update(const Constraint& constraint, const bool isFulfilled);
+
     size_t numFulfilledHierarchyConstraints() const;
 
     size_t numFulFilledMergeSplitConstraints() const;
 };
 
+/// Constraints stored as flat arrays such that checking them runs over contiguous memory
+struct IVW_MODULE_TEMPORALTREEMAPS_API FlatConstraints {
+    /// Leaves of all constraints, constraint i owns [leafOffsets[i], leafOffsets[i+1])
+    std::vector<size_t> leafBuffer;
+    std::vector<size_t> leafOffsets;
+
+    /// Time window per constraint
+    std::vector<uint64_t> startTimes;
+    std::vector<uint64_t> endTimes;
+
+    /// Start and end time per node of the tree
+    std::vector<uint64_t> nodeStartTimes;
+    std::vector<uint64_t> nodeEndTimes;
+
+    void build(const TemporalTree& tree, const std::vector<Constraint>& constraints);
+
+    size_t size() const { return startTimes.size(); }
+
+    size_t numNodes() const { return nodeStartTimes.size(); }
+
+    size_t numLeaves(const size_t constraintId) const {
+        return leafOffsets[constraintId + 1] - leafOffsets[constraintId];
+    }
+
+    /// Leaves of a constraint (sorted)
+    const size_t* leavesBegin(const size_t constraintId) const {
+        return leafBuffer.data() + leafOffsets[constraintId];
+    }
+    const size_t* leavesEnd(const size_t constraintId) const {
+        return leafBuffer.data() + leafOffsets[constraintId + 1];
+    }
+};
+
+/// Start and end times of the nodes in the order in which they are placed
+void timesByPosition(const FlatConstraints& constraints, const treeorder::Permutation& order,
+                     std::vector<uint64_t>& startByPosition, std::vector<uint64_t>& endByPosition);
+
+/// Checks if the constraint with the given index is fulfilled, times per position
+/// as given by timesByPosition
+bool isFulFilled(const FlatConstraints& constraints, const size_t constraintId,
+                 const treeorder::Permutation& order, const std::vector<uint64_t>& startByPosition,
+                 const std::vector<uint64_t>& endByPosition);
+
 /// Sums over the given vector
 size_t numConstraints(const std::vector<size_t>& numByLevel);
 
+/// Lower bound on the weighted sum of unfulfilled constraints that holds for any order.
+/// Two constraints can always be fulfilled together, conflicts need at least three:
+/// constraints sharing a single leaf with each other leaf overlapping the others in time
+/// (the shared leaf has only two sides) and triangles of constraints on two leaves.
+/// Disjoint conflicts are packed greedily, each one adds its smallest weight.
+double lowerBoundUnfulfilled(const FlatConstraints& constraints,
+                             const std::vector<double>& weights);
+
 /// CHecks if the given constraints if fulfilled
 bool isFulFilled(Constraint& constraint, std::shared_ptr<const TemporalTree>& tree,
-                 const TemporalTree::TTreeOrder& order,
-                 const TemporalTree::TTreeOrderMap& orderMap);
+                 const treeorder::Permutation& order);
 
 /// Get the number of fulfilled constraints, where constraints are given as a set of leaves and a
 /// time interval at which the constraint has to be fulfilled
 size_t numFulfilledConstraints(std::shared_ptr<const TemporalTree>& tree,
-                               const TemporalTree::TTreeOrder& order,
-                               const TemporalTree::TTreeOrderMap& orderMap,
+                               const treeorder::Permutation& order,
                                std::vector<Constraint>& constraints,
                                ConstraintsStatistic& statistic);
 
@@ -73,6 +125,10 @@ bool isRedundant(const Constraint& constraint, const std::vector<Constraint>& co
 
 bool isOverlappingWithConstraint(const TemporalTree::TNode& leaf, const Constraint& constraint);
 
+/// Same as above, but for a leaf that is only given by its start and end time
+bool isOverlappingWithConstraint(const uint64_t leafStartTime, const uint64_t leafEndTime,
+                                 const Constraint& constraint);
+
 }  // namespace constraint
 
 }  // namespace kth
@@ -0,0 +1,192 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 10:12:40
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#pragma once
+
+#include <modules/temporaltreemaps/temporaltreemapsmoduledefine.h>
+#include <inviwo/core/common/inviwo.h>
+#include <modules/temporaltreemaps/datastructures/tree.h>
+#include <modules/temporaltreemaps/datastructures/constraint.h>
+#include <random>
+
+namespace inviwo {
+namespace kth {
+
+namespace constraint {
+
+/** \class IncrementalEvaluator
+    \brief Evaluates the weighted number of unfulfilled constraints for a leaf order incrementally
+
+    The evaluator keeps a reference order together with the fulfilled state of every constraint.
+    For each leaf, an inverted index stores all constraints whose state can change when that leaf
+    moves: the constraints containing the leaf and the constraints overlapping with it in time.
+    When a new order is given, only the constraints indexed by leaves that changed their position
+    are checked again and the change in value is returned.
+
+    The evaluator does not modify the constraints, such that several evaluators can share them.
+    Copies of an evaluator share the index as well.
+
+    @author Tino Weinkauf and Wiebke Koepp
+*/
+class IVW_MODULE_TEMPORALTREEMAPS_API IncrementalEvaluator {
+    // Friends
+    // Types
+public:
+    // Construction / Deconstruction
+public:
+    IncrementalEvaluator() = default;
+    IncrementalEvaluator(const IncrementalEvaluator&) = default;
+    IncrementalEvaluator(IncrementalEvaluator&&) = default;
+    IncrementalEvaluator& operator=(const IncrementalEvaluator&) = default;
+    /// Moving keeps exchanging the evaluators of two replicas cheap
+    IncrementalEvaluator& operator=(IncrementalEvaluator&&) = default;
+    virtual ~IncrementalEvaluator() = default;
+
+    // Methods
+public:
+    /// Build the inverted index from leaves to constraints, the flat constraints
+    /// need to be built from the given ones and both need to outlive the evaluator
+    void initialize(const TemporalTree& tree, const FlatConstraints& flatConstraints,
+                    const std::vector<Constraint>& constraints);
+
+    /// Has the index been built
+    bool isInitialized() const { return pFlatConstraints != nullptr; }
+
+    /// Evaluate the order from scratch with the given weights per constraint
+    /// and make it the reference for subsequent updates
+    double evaluate(const TemporalTree::TTreeOrder& order, const std::vector<double>& weights,
+                    ConstraintsStatistic* statistic);
+
+    /// Check only those constraints that are affected by the changes between the given order
+    /// and the reference order, the given order becomes the new reference.
+    /// Returns the change in value.
+    double update(const TemporalTree::TTreeOrder& order, ConstraintsStatistic* statistic);
+
+    /// Same as above, but the order is known to differ from the reference order
+    /// only within the positions [firstPosition, endPosition)
+    double update(const TemporalTree::TTreeOrder& order, const size_t firstPosition,
+                  const size_t endPosition, ConstraintsStatistic* statistic);
+
+    /// Estimate the change in value from a sample of the affected constraints. The sample takes
+    /// every n-th affected constraint per level and type, such that all of these strata are
+    /// represented. Unsampled constraints keep their state, so the value of the evaluator is
+    /// only approximate until the next call to evaluate.
+    double estimate(const TemporalTree::TTreeOrder& order, const size_t firstPosition,
+                    const size_t endPosition, const size_t sampleEvery,
+                    std::mt19937& generator);
+
+    /// Go back to the reference order before the last update. A statistic given
+    /// to that update is reverted if it is given here as well (not after an estimate).
+    void revert(ConstraintsStatistic* statistic = nullptr);
+
+    /// Value of the reference order
+    double value() const { return currentValue; }
+
+    /// Is the constraint fulfilled in the reference order
+    bool isFulfilled(const size_t constraintId) const { return fulfilled[constraintId] != 0; }
+
+    /// The reference order
+    const treeorder::Permutation& getPermutation() const { return permutation; }
+
+    /// Indices of all constraints that are unfulfilled in the reference order
+    const std::vector<size_t>& getUnfulfilled() const { return unfulfilled; }
+
+    /// Number of constraints checked during the last update
+    size_t numCheckedLastUpdate() const { return numChecked; }
+
+protected:
+    /// Check the constraint against the reference order
+    bool check(const size_t constraintId) const;
+
+    /// Change the fulfilled state of a constraint and keep track of everything depending on it
+    void setFulfilled(const size_t constraintId, const bool isFulfilled,
+                      ConstraintsStatistic* statistic);
+
+    /// Put a leaf at the given position of the reference order
+    void setLeafAt(const size_t position, const size_t leaf);
+
+    /// Bring the reference order up to date within the given range, returns false if
+    /// nothing changed
+    bool applyOrder(const TemporalTree::TTreeOrder& order, const size_t firstPosition,
+                    const size_t endPosition);
+
+    /// New stamp such that each constraint is checked only once
+    void nextStamp();
+
+    // Attributes
+protected:
+    /// Constraints to evaluate
+    const FlatConstraints* pFlatConstraints = nullptr;
+
+    /// Same constraints for updating statistics
+    const std::vector<Constraint>* pConstraints = nullptr;
+
+    /// Weight of each constraint when it is not fulfilled
+    std::vector<double> weights;
+
+    /// For each leaf the constraints whose state depends on the position of that leaf
+    std::shared_ptr<const std::vector<std::vector<size_t>>> pConstraintsByLeaf;
+
+    /// Reference order with the position of each leaf
+    treeorder::Permutation permutation;
+
+    /// Start and end time of the leaf at each position of the reference order
+    std::vector<uint64_t> startByPosition;
+    std::vector<uint64_t> endByPosition;
+
+    /// Fulfilled state per constraint for the reference order
+    std::vector<char> fulfilled;
+
+    /// All unfulfilled constraints and the index of each constraint in that list
+    std::vector<size_t> unfulfilled;
+    std::vector<size_t> unfulfilledIndex;
+
+    /// Number of unfulfilled constraints a leaf is part of
+    std::vector<size_t> numUnfulfilledByLeaf;
+
+    /// Weighted sum of unfulfilled constraints
+    double currentValue = 0.0;
+
+    /// Value before the last update
+    double lastValue = 0.0;
+
+    /// Positions changed in the last update together with the leaf that was there before
+    std::vector<std::pair<size_t, size_t>> changedPositions;
+
+    /// Constraints that changed their state in the last update
+    std::vector<size_t> changedConstraints;
+
+    /// Marks constraints that have been checked during an update
+    std::vector<size_t> checkedStamp;
+    size_t currentStamp = 0;
+
+    /// Number of constraints checked during the last update
+    size_t numChecked = 0;
+
+    /// Was the last update an estimate
+    bool isLastEstimate = false;
+
+    /// Stratum of each constraint given by its level and type
+    std::vector<size_t> stratumByConstraint;
+
+    /// Memory for estimates: affected constraints, and per stratum the number of affected
+    /// and sampled constraints, the start of the sample and the change in value
+    std::vector<size_t> affectedConstraints;
+    std::vector<size_t> numAffectedByStratum;
+    std::vector<size_t> numSampledByStratum;
+    std::vector<size_t> sampleStartByStratum;
+    std::vector<double> deltaByStratum;
+    std::vector<size_t> touchedStrata;
+};
+
+}  // namespace constraint
+
+}  // namespace kth
+}  // namespace inviwo
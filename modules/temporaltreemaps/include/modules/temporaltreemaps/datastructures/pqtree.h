@@ -0,0 +1,145 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 16:21:37
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#pragma once
+
+#include <modules/temporaltreemaps/temporaltreemapsmoduledefine.h>
+#include <inviwo/core/common/inviwo.h>
+#include <modules/temporaltreemaps/datastructures/tree.h>
+
+namespace inviwo {
+namespace kth {
+
+namespace treeorder {
+
+/** \class PQTree
+    \brief Set of all leaf orders in which given sets of leaves are consecutive
+
+    A PQ-tree after Booth and Lueker. The children of a P-node can be permuted arbitrarily,
+    the children of a Q-node can only be reversed. Reducing the tree with a set of leaves
+    removes all orders from the set in which these leaves are not consecutive. The reduction
+    follows the bottom-up templates of Booth and Lueker on the pertinent subtree, but keeps
+    the children of a node in an array with parent pointers for all of them.
+
+    @author Tino Weinkauf and Wiebke Koepp
+*/
+class IVW_MODULE_TEMPORALTREEMAPS_API PQTree {
+    // Types
+public:
+    enum class NodeType : uint8_t { Leaf, P, Q };
+
+    static constexpr size_t InvalidNode = std::numeric_limits<size_t>::max();
+
+protected:
+    enum class Label : uint8_t { Empty, Partial, Full };
+
+    struct Node {
+        NodeType type = NodeType::P;
+        size_t parent = InvalidNode;
+        size_t indexInParent = 0;
+        std::vector<size_t> children;
+        /// Node index in the temporal tree for leaves
+        size_t treeNode = InvalidNode;
+    };
+
+    // Construction / Deconstruction
+public:
+    PQTree() = default;
+    virtual ~PQTree() = default;
+
+    // Methods
+public:
+    /// Start with all orders of the given leaves, leaves are node indices
+    /// of a tree with the given number of nodes
+    void initialize(const TemporalTree::TTreeOrder& leaves, const size_t numTreeNodes);
+
+    /// Restrict the orders such that the given leaves are consecutive.
+    /// Returns false and leaves the tree untouched if no order allows that.
+    bool reduce(const std::vector<size_t>& leaves);
+
+    /// One of the orders, P-nodes keep their children in the order given initially
+    /// as far as possible
+    void frontier(TemporalTree::TTreeOrder& order) const;
+
+    /// Number of leaves
+    size_t numLeaves() const { return leafCount; }
+
+protected:
+    /// Label the pertinent subtree bottom-up and check whether the templates apply
+    bool labelPertinent(const std::vector<size_t>& leaves);
+
+    /// Apply the templates to the labeled pertinent subtree
+    void applyTemplates();
+
+    /// Reset everything used for one reduction
+    void clearLabels();
+
+    /// Add a new node of the given type
+    size_t addNode(const NodeType type);
+
+    /// Set all children of a node at once
+    void setChildren(const size_t node, std::vector<size_t>&& children);
+
+    /// Remove a child from a P-node, the last child takes its place
+    void removeFromP(const size_t node, const size_t child);
+
+    /// Append a child to a node
+    void appendChild(const size_t node, const size_t child);
+
+    /// Put the node at the place of another one in the tree
+    void replaceNode(const size_t oldNode, const size_t newNode);
+
+    /// Single node for the given nodes: the node itself or a P-node holding all of them
+    size_t group(const std::vector<size_t>& members);
+
+    /// Pattern of a Q-node, empty children first, then at most one partial,
+    /// then full children until the end. Tells whether the children need to be reversed for that.
+    bool isPartialQ(const size_t node, bool& reversed) const;
+
+    /// Pattern of a Q-node at the root of the pertinent subtree: the non-empty children are
+    /// consecutive, only the outermost of them may be partial
+    bool isRootQ(const size_t node) const;
+
+    /// Children of a partial child replace it in a Q-node, reversed if needed
+    void spliceChild(std::vector<size_t>& sequence, const size_t child, const bool reversed);
+
+    Label labelOf(const size_t node) const { return labels[node]; }
+
+    // Attributes
+protected:
+    /// All nodes, some might not be part of the tree anymore
+    std::vector<Node> nodes;
+
+    /// Root of the tree
+    size_t root = InvalidNode;
+
+    /// Node for each tree node that is a leaf
+    std::vector<size_t> leafNodes;
+
+    /// Number of leaves
+    size_t leafCount = 0;
+
+    /// Labels and bookkeeping of the current reduction, only valid for touched nodes
+    std::vector<Label> labels;
+    std::vector<size_t> numPertinentLeaves;
+    std::vector<size_t> numPendingChildren;
+    std::vector<char> isTouched;
+    std::vector<std::vector<size_t>> fullChildren;
+    std::vector<std::vector<size_t>> partialChildren;
+    std::vector<size_t> touched;
+
+    /// Pertinent nodes in bottom-up order, the last one is the pertinent root
+    std::vector<size_t> pertinent;
+};
+
+}  // namespace treeorder
+
+}  // namespace kth
+}  // namespace inviwo
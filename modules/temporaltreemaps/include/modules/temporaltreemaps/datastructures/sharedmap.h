@@ -0,0 +1,169 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 21:05:12
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#pragma once
+
+#include <modules/temporaltreemaps/temporaltreemapsmoduledefine.h>
+#include <inviwo/core/common/inviwo.h>
+
+namespace inviwo {
+namespace kth {
+
+/** \class SharedMap
+    \brief Map that is shared between copies until one of them is modified
+
+    Copies of a SharedMap refer to the same map. Reading through a const object never copies.
+    Any non-const access first copies the map if it is still shared with another object, so
+    that changes never show up in the copies. Iterators and references from a non-const access
+    stay valid until the object is copied again.
+
+    The per-node maps and the edges of a TemporalTree are held this way. A processor that
+    copies its input tree and adds, e.g., drawing limits only allocates the limits, while the
+    values and edges stay shared with the input.
+
+    @author Tino Weinkauf and Wiebke Koepp
+*/
+template <typename TMap>
+class SharedMap {
+    // Friends
+    // Types
+public:
+    using key_type = typename TMap::key_type;
+    using mapped_type = typename TMap::mapped_type;
+    using value_type = typename TMap::value_type;
+    using size_type = typename TMap::size_type;
+    using iterator = typename TMap::iterator;
+    using const_iterator = typename TMap::const_iterator;
+    using reverse_iterator = typename TMap::reverse_iterator;
+    using const_reverse_iterator = typename TMap::const_reverse_iterator;
+
+    // Construction / Deconstruction
+public:
+    SharedMap() = default;
+    SharedMap(const TMap& map) : pMap(std::make_shared<TMap>(map)) {}
+    SharedMap(TMap&& map) : pMap(std::make_shared<TMap>(std::move(map))) {}
+    SharedMap(std::initializer_list<value_type> init) : pMap(std::make_shared<TMap>(init)) {}
+
+    SharedMap& operator=(const TMap& map) {
+        pMap = std::make_shared<TMap>(map);
+        return *this;
+    }
+
+    SharedMap& operator=(TMap&& map) {
+        pMap = std::make_shared<TMap>(std::move(map));
+        return *this;
+    }
+
+    // Methods
+public:
+    /// Read access to the map
+    const TMap& get() const { return pMap ? *pMap : emptyMap(); }
+
+    /// Write access to the map, copies it if it is shared
+    TMap& get() {
+        detach();
+        return *pMap;
+    }
+
+    operator const TMap&() const { return get(); }
+
+    /// Is the map shared with another object
+    bool isShared() const { return pMap && pMap.use_count() > 1; }
+
+    /// Do both refer to the same map
+    bool isSharedWith(const SharedMap& other) const { return pMap && pMap == other.pMap; }
+
+    bool empty() const { return get().empty(); }
+    size_type size() const { return get().size(); }
+
+    const_iterator begin() const { return get().begin(); }
+    const_iterator end() const { return get().end(); }
+    const_iterator cbegin() const { return get().cbegin(); }
+    const_iterator cend() const { return get().cend(); }
+    const_reverse_iterator rbegin() const { return get().rbegin(); }
+    const_reverse_iterator rend() const { return get().rend(); }
+    const_reverse_iterator crbegin() const { return get().crbegin(); }
+    const_reverse_iterator crend() const { return get().crend(); }
+
+    iterator begin() { return get().begin(); }
+    iterator end() { return get().end(); }
+    reverse_iterator rbegin() { return get().rbegin(); }
+    reverse_iterator rend() { return get().rend(); }
+
+    const_iterator find(const key_type& key) const { return get().find(key); }
+    iterator find(const key_type& key) { return get().find(key); }
+    size_type count(const key_type& key) const { return get().count(key); }
+    const_iterator lower_bound(const key_type& key) const { return get().lower_bound(key); }
+    iterator lower_bound(const key_type& key) { return get().lower_bound(key); }
+    const_iterator upper_bound(const key_type& key) const { return get().upper_bound(key); }
+    iterator upper_bound(const key_type& key) { return get().upper_bound(key); }
+
+    const mapped_type& at(const key_type& key) const { return get().at(key); }
+    mapped_type& at(const key_type& key) { return get().at(key); }
+    mapped_type& operator[](const key_type& key) { return get()[key]; }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        return get().emplace(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    iterator emplace_hint(const_iterator hint, Args&&... args) {
+        return get().emplace_hint(hint, std::forward<Args>(args)...);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) { return get().insert(value); }
+
+    template <typename InputIt>
+    void insert(InputIt first, InputIt last) {
+        get().insert(first, last);
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& value) {
+        return get().insert_or_assign(key, std::forward<M>(value));
+    }
+
+    iterator erase(const_iterator pos) { return get().erase(pos); }
+    iterator erase(const_iterator first, const_iterator last) { return get().erase(first, last); }
+    size_type erase(const key_type& key) { return get().erase(key); }
+
+    /// Releases the map, does not copy it
+    void clear() { pMap.reset(); }
+
+    bool operator==(const SharedMap& other) const {
+        return pMap == other.pMap || get() == other.get();
+    }
+    bool operator!=(const SharedMap& other) const { return !(*this == other); }
+
+protected:
+    /// Make sure this object is the only one holding the map
+    void detach() {
+        if (!pMap) {
+            pMap = std::make_shared<TMap>();
+        } else if (pMap.use_count() > 1) {
+            pMap = std::make_shared<TMap>(*pMap);
+        }
+    }
+
+    /// Map returned for reading before anything has been added
+    static const TMap& emptyMap() {
+        static const TMap empty;
+        return empty;
+    }
+
+    // Attributes
+protected:
+    /// The map, nullptr as long as nothing has been added
+    std::shared_ptr<TMap> pMap;
+};
+
+}  // namespace kth
+}  // namespace inviwo
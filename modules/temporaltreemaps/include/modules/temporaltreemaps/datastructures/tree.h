@@ -11,16 +11,24 @@
 #pragma once
 
 #include <set>
+#include <mutex>
 #include <modules/temporaltreemaps/temporaltreemapsmoduledefine.h>
 #include <inviwo/core/common/inviwo.h>
 #include <inviwo/core/datastructures/datatraits.h>
+#include <modules/temporaltreemaps/datastructures/sharedmap.h>
+#include <modules/temporaltreemaps/datastructures/treelayoutresult.h>
 
 namespace inviwo {
 namespace kth {
 
+class TemporalTreeIntervalIndex;
+
 /** \class TemporalTree
     \brief Describes a tree data structure with time-dependent values at the nodes.
 
+    Copies of a tree share the per-node maps and the edges until they are modified,
+    so copying a tree mainly copies the node names. See SharedMap.
+
     @author Tino Weinkauf and Wiebke Köpp
 */
 class IVW_MODULE_TEMPORALTREEMAPS_API TemporalTree {
@@ -29,12 +37,6 @@ class IVW_MODULE_TEMPORALTREEMAPS_API TemporalTree {
 public:
     typedef std::map<uint64_t, float> TValueMap;
 
-    typedef std::map<uint64_t, std::pair<float, float>> TDrawingLimitMap;
-
-    typedef std::map<uint64_t, std::pair<vec3, vec3>> TCushionMap;
-
-    typedef std::map<uint64_t, vec4> TColorPerTimeMap;
-
     /// Single node in a time-dependent tree. Can be inner node or leaf.
     struct TNode {
         /// Some application-specific text
@@ -47,24 +49,17 @@ public:
         /// If computeAccumulated has been called inner nodes
         /// hold values accumulated from the values of children
         /// and leaves are filled with values for each timestep
-        TValueMap values;
-
-        /// Drawing information for the node for each timestep;
-        TDrawingLimitMap lowerLimit;
-        TDrawingLimitMap upperLimit;
-        TCushionMap cushion;
-        /// Map has the same number of values as upperLimit, lowerLimit and cushion
-        TColorPerTimeMap colors;
+        SharedMap<TValueMap> values;
 
         /// In case someone computes a single color for the entire leaf
         vec3 color;
 
         /// Simple constructor
-        TNode() : name(""), values(), lowerLimit(), upperLimit(), cushion(), colors() {}
+        TNode() : name(""), values() {}
 
         /// Element constructor
         TNode(const std::string& argname, const std::map<uint64_t, float>& argvalues = {})
-            : name(argname), values(argvalues), lowerLimit(), upperLimit(), cushion(), colors() {}
+            : name(argname), values(argvalues) {}
 
         /// Returns the time of the first element of this node
         /// or the maximum uint64_t value if the node does not have any values
@@ -80,7 +75,7 @@ public:
         /// Add values from one map to another one with left neighbor interpolation
         ///(Add values to add for all time points in between the current and next one)
         void fillWithLeftNeighborInterpolation(const std::set<uint64_t>& times) {
-            fillWithLeftNeighborInterpolation(times, values);
+            fillWithLeftNeighborInterpolation(times, values.get());
         }
 
         static void fillWithLeftNeighborInterpolation(const std::set<uint64_t>& times,
@@ -99,14 +94,54 @@ public:
     /// Maps a leaf index to its order index
     using TTreeOrderMap = std::map<size_t, size_t>;
 
+    /// Sorted times of the tree for one version, copies of a tree share them
+    struct TTimesCache {
+        TTimesCache() = default;
+        TTimesCache(const TTimesCache& other) {
+            std::lock_guard<std::mutex> lock(other.mutex);
+            version = other.version;
+            times = other.times;
+        }
+        TTimesCache& operator=(const TTimesCache& other) {
+            if (this != &other) {
+                std::lock(mutex, other.mutex);
+                std::lock_guard<std::mutex> lock(mutex, std::adopt_lock);
+                std::lock_guard<std::mutex> lockOther(other.mutex, std::adopt_lock);
+                version = other.version;
+                times = other.times;
+            }
+            return *this;
+        }
+
+        mutable std::mutex mutex;
+        uint64_t version = 0;
+        std::shared_ptr<const std::vector<uint64_t>> times;
+    };
+
     // Construction / Deconstruction
 public:
-    TemporalTree() {}
+    TemporalTree() { touch(); }
 
     virtual ~TemporalTree() = default;
 
     // Methods
 public:
+    /** @name Versioning
+
+            The version changes with every modification through the methods of the tree and
+            identifies the state of nodes and edges across all trees. Cached information is
+            kept for one version. Call touch() after modifying nodes or edges directly.
+    */
+    //@{
+
+    /// Version of the nodes and edges
+    uint64_t getVersion() const { return version; }
+
+    /// Mark nodes or edges as modified
+    void touch();
+
+    //@}
+
     /** @name Access to Tree Elements
 
             Utility functions for accessing parts of the tree.
@@ -123,6 +158,8 @@ public:
     /// leaf, the result is 0.
     size_t getNumLevels(const size_t nodeIndex) const;
 
+    /// Split inner nodes at the times where none of their children exists, so that they are
+    /// leaves there. All nodes are handled in a single sweep, edges are rewired in one batch.
     void splitTemporaryLeaves();
 
     void leafDepthStatistic(const size_t nodeIndex, std::vector<bool>& visited,
@@ -209,7 +246,8 @@ protected:
     /// Get the edges pointing to a node.
     std::vector<size_t> getEdgesTo(const size_t nodeIndex, const TAdjacency& Edges) const;
 
-    /// Compute components
+    /// Compute components, i.e., the id of the connected component of each node
+    /// starting with 1, in near-linear time without recursion
     std::vector<unsigned int> computeComponents(const TAdjacency& Edges) const;
 
     //@}
@@ -226,6 +264,7 @@ public:
         @returns the index of the newly created node.
     */
     size_t addNode(const TNode& node) {
+        touch();
         nodes.push_back(node);
         return nodes.size() - 1;
     }
@@ -238,6 +277,7 @@ public:
         @returns the index of the newly created node.
     */
     size_t addNode(const std::string& name, const std::map<uint64_t, float>& values) {
+        touch();
         nodes.emplace_back(name, values);
         // if (values.size() < 1)
         //{
@@ -252,6 +292,7 @@ public:
 
     /// Add a hierarchical edge to the tree
     void addHierarchyEdge(const size_t from, const size_t to) {
+        touch();
         // Add edge to the map (create either a new entry or update the entry for the from-key)
         auto itToAdd = edgesHierarchy.find(from);
         if (itToAdd == edgesHierarchy.end()) {
@@ -273,6 +314,7 @@ public:
 
     /// Add a temporal edge to the tree
     void addTemporalEdge(const size_t from, const size_t to) {
+        touch();
         // Add edge to the map (create either a new entry or update the entry for the from-key)
         std::map<size_t, std::vector<size_t>>::iterator itToAdd = edgesTime.find(from);
         if (itToAdd == edgesTime.end()) {
@@ -285,6 +327,7 @@ public:
 
     /// Adds a data value to a node.
     void addDataValue(const uint64_t Time, const size_t nodeIndex, const float dataValue) {
+        touch();
         TNode& Node = nodes[nodeIndex];
         Node.values.emplace(Time, dataValue);
     }
@@ -304,6 +347,7 @@ public:
     /// We can specify a set of nodes that are not updated (usually ones that are not active
     /// anymore)
     void finalizeTree(const uint64_t Time, std::set<size_t> excludeNodes = {}) {
+        touch();
         for (size_t nodeIndex(0); nodeIndex < nodes.size(); nodeIndex++) {
             auto& node = nodes[nodeIndex];
             // Make sure we actually want to process this node
@@ -334,22 +378,29 @@ public:
     */
     //@{
 
-    /// Compute accumulated values for the tree, initialization has to happen prior to this
-    void computeAccumulated(const bool justLeaves = true) {
-        std::vector<bool> processed(nodes.size(), false);
-        computeAccumulated(0, getTimes(), processed, justLeaves);
-    }
+    /// Compute accumulated values for the tree, initialization has to happen prior to this.
+    /// Goes up from the leaves, all nodes with the same height are accumulated in parallel
+    /// on dense buffers over the times of the tree.
+    void computeAccumulated(const bool justLeaves = true);
 
     // Shorthand for times
     std::set<uint64_t> getTimes() const {
-        std::set<uint64_t> times;
-        getTimes(0, times);
-        return times;
+        auto sortedTimes = getSortedTimes();
+        return std::set<uint64_t>(sortedTimes->begin(), sortedTimes->end());
     }
 
+    /// All times of the tree in increasing order, same as getTimes.
+    /// Computed once per version of the tree.
+    std::shared_ptr<const std::vector<uint64_t>> getSortedTimes() const;
+
+    /// Index of a time in getSortedTimes, the number of times if it is not a time of the tree
+    size_t getTimeRank(const uint64_t time) const;
+
     std::map<uint64_t, float> computeAccumulatedRootOnly(const std::set<uint64_t>& times) const;
 
     /** Computes all nodes taking part in splits/merges.
+        A cluster is a connected set of node ends and starts joined by temporal edges,
+        e.g., a split, a merge or a direct correspondence.
 
         @returns Number of clusters and fills the @c Cluster variable:
         for each node, it contains whether it takes part in a split/merge cluster (>= 0)
@@ -392,22 +443,18 @@ public:
     /// thus are not part of a split or merge
     TemporalTree aggregate() const;
 
-    /* LATER, WHEN WE ACTUALLY NEED IT
-    ///Compute the tree at a given time
-    ///The tree is empty if no nodes exist at that time
-    TemporalTree getHierarchyAt(const uint64_t time, const bool accumulate, const uint64_t
-    deltaTime) const;
+    /// Compute the tree at a given time, each node holds its value at that time for the
+    /// interval [time, time + deltaTime]. The tree is empty if the root does not exist then.
+    TemporalTree getHierarchyAt(const uint64_t time, const bool accumulate = true,
+                                const uint64_t deltaTime = 1) const;
 
-    */
+    /// Same as above using an interval index that has been built for this tree,
+    /// use this for several snapshots of the same tree
+    TemporalTree getHierarchyAt(const TemporalTreeIntervalIndex& index, const uint64_t time,
+                                const bool accumulate = true, const uint64_t deltaTime = 1) const;
 
     //@}
 
-private:
-    /// Compute accumulated values from values at the leafs for a subtree given its root
-    /// Initialize each map with the time point in the set
-    void computeAccumulated(const size_t subtreeIndex, const std::set<uint64_t>& times,
-                            std::vector<bool>& processed, const bool justLeaves);
-
     // Attributes
 public:
     /// All nodes of the tree. The first one is the root.
@@ -415,23 +462,33 @@ public:
 
     /// Hierarchical edges, edges are valid for a specific time and thus
     /// come with a start and end time
-    TAdjacency edgesHierarchy;
+    SharedMap<TAdjacency> edgesHierarchy;
 
     /// Cache for reverse hierarchy edges
-    TAdjacency reverseEdgesHierachy;
+    SharedMap<TAdjacency> reverseEdgesHierachy;
 
     /// Edges in time encoding merges and splits (essentially active at discrete time points)
     /// A node can either have a single successor in time,
     /// then is merges with a sibling, or it has multiple successors
     /// then it has split into multiple siblings
     /// For non-aggregated version a single successor is also possible for a usual node
-    TAdjacency edgesTime;
+    SharedMap<TAdjacency> edgesTime;
 
     /// Cache for reverse temporal edges
-    TAdjacency reverseEdgesTime;
+    SharedMap<TAdjacency> reverseEdgesTime;
 
     /// Order on the leaves of this tree
     TTreeOrder order;
+
+    /// Drawing information per node and time: limits, cushions and colors
+    TemporalTreeLayoutResult layout;
+
+private:
+    /// Version of nodes and edges, unique across all trees
+    uint64_t version = 0;
+
+    /// Sorted times for a version
+    mutable TTimesCache timesCache;
 };
 
 }  // namespace kth
@@ -0,0 +1,107 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 19:02:48
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#pragma once
+
+#include <modules/temporaltreemaps/temporaltreemapsmoduledefine.h>
+#include <inviwo/core/common/inviwo.h>
+#include <modules/temporaltreemaps/datastructures/tree.h>
+
+namespace inviwo {
+namespace kth {
+
+/** \class TemporalTreeIntervalIndex
+    \brief Index over the lifetimes of all nodes of a TemporalTree for time slice queries
+
+    The lifetimes are stored in a centered interval tree. Each tree node holds the lifetimes
+    containing its center time, once sorted by start time and once by end time, the others go
+    to the left or right subtree. A query at a time goes down a single path and stops scanning
+    each sorted list at the first node that is not alive, so it takes O(log n + k) for k nodes.
+    A query for an interval adds the nodes starting within it from a list sorted by start time.
+
+    Lifetimes are closed intervals [startTime, endTime] as in TNode::isOverlappingTemporally.
+    Nodes without values are never reported. The index also keeps the hierarchical parents of
+    all nodes, so a snapshot can be built from a query alone. The index needs to be built again
+    after the values or edges of the tree change.
+
+    @author Tino Weinkauf and Wiebke Koepp
+*/
+class IVW_MODULE_TEMPORALTREEMAPS_API TemporalTreeIntervalIndex {
+    // Friends
+    // Types
+    // Construction / Deconstruction
+public:
+    TemporalTreeIntervalIndex() = default;
+    explicit TemporalTreeIntervalIndex(const TemporalTree& tree) { build(tree); }
+    virtual ~TemporalTreeIntervalIndex() = default;
+
+    // Methods
+public:
+    /// Build the index for the given tree
+    void build(const TemporalTree& tree);
+
+    /// Number of nodes in the index
+    size_t size() const { return sortedNodes.size(); }
+
+    /// Nodes alive at the given time, in no particular order
+    void getNodesAt(const uint64_t time, std::vector<size_t>& nodeIndices) const;
+
+    /// Nodes overlapping with [startTime, endTime], in no particular order
+    void getNodesIn(const uint64_t startTime, const uint64_t endTime,
+                    std::vector<size_t>& nodeIndices) const;
+
+    /// Hierarchical parents of a node in the indexed tree
+    std::vector<size_t> getHierarchicalParents(const size_t nodeIndex) const {
+        auto itParents = parents.find(nodeIndex);
+        return itParents != parents.end() ? itParents->second : std::vector<size_t>();
+    }
+
+protected:
+    /// Node of the centered interval tree
+    struct CenterNode {
+        /// All lifetimes of this node contain the center time
+        uint64_t center;
+        /// Range of this node in centerByStart and centerByEnd
+        size_t first;
+        size_t last;
+        /// Subtrees with the lifetimes ending before and starting after the center
+        size_t left;
+        size_t right;
+    };
+
+    /// Marks a missing subtree
+    static constexpr size_t NoChild = std::numeric_limits<size_t>::max();
+
+    /// Build the subtree for the given positions in the sorted lists, returns its root
+    size_t buildCenterNode(const std::vector<size_t>& positions);
+
+    // Attributes
+protected:
+    /// Node indices sorted by start time
+    std::vector<size_t> sortedNodes;
+
+    /// Start and end times in the same order
+    std::vector<uint64_t> sortedStartTimes;
+    std::vector<uint64_t> sortedEndTimes;
+
+    /// Nodes of the centered interval tree, the first one is the root
+    std::vector<CenterNode> centerNodes;
+
+    /// Positions in the sorted lists held by the center nodes,
+    /// sorted by increasing start time and by decreasing end time per center node
+    std::vector<size_t> centerByStart;
+    std::vector<size_t> centerByEnd;
+
+    /// Hierarchical parents of each node with a parent
+    std::map<size_t, std::vector<size_t>> parents;
+};
+
+}  // namespace kth
+}  // namespace inviwo
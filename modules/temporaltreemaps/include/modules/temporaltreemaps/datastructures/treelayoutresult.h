@@ -0,0 +1,363 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 22:03:47
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#pragma once
+
+#include <modules/temporaltreemaps/temporaltreemapsmoduledefine.h>
+#include <inviwo/core/common/inviwo.h>
+
+namespace inviwo {
+namespace kth {
+
+class TemporalTree;
+
+/** \class TemporalTreeLayoutResult
+    \brief Drawing information of all nodes of a TemporalTree in dense arrays
+
+    Holds what the layout, cushion and coloring processors compute: the lower and upper limit
+    of each band, its cushion coefficients and its color. Each of them is a pair of values
+    left and right of a time, except for the color.
+
+    Every node has one slot for each time of the tree within its lifetime. The slots of all
+    nodes are contiguous in one array per kind of information, indexed by node and time index.
+    The time index refers to the sorted times of the tree. A flag per slot tells whether it
+    has been set, since, e.g., a parent only gets limits where one of its children is drawn.
+
+    Copies share the arrays until one of them writes, like SharedMap does for the node maps.
+    Adding cushions to a tree thus does not copy its limits.
+
+    @author Tino Weinkauf and Wiebke Koepp
+*/
+class IVW_MODULE_TEMPORALTREEMAPS_API TemporalTreeLayoutResult {
+    // Friends
+    // Types
+public:
+    static constexpr size_t InvalidIndex = std::numeric_limits<size_t>::max();
+
+    /// Value left and right of a time
+    using TLimit = std::pair<float, float>;
+
+    /// Lower and upper limit of a band at a time
+    struct TBandLimits {
+        TLimit lower;
+        TLimit upper;
+    };
+
+    /// Cushion coefficients left and right of a time
+    using TCushion = std::pair<vec3, vec3>;
+
+protected:
+    /// Slots of all nodes on the time axis
+    struct TAxis {
+        /// All times of the tree, sorted
+        std::shared_ptr<const std::vector<uint64_t>> times;
+
+        /// Lifetime of each node on the time axis, InvalidIndex for nodes without values
+        std::vector<size_t> firstIndices;
+        std::vector<size_t> lastIndices;
+
+        /// Position of the slots of each node
+        std::vector<size_t> offsets;
+
+        /// Number of slots of all nodes
+        size_t numSlots = 0;
+    };
+
+    /// One kind of drawing information for all slots
+    template <typename T>
+    struct TLayer {
+        std::vector<T> values;
+
+        /// Has the slot been set
+        std::vector<uint8_t> isSet;
+
+        /// First and last set time index of each node, InvalidIndex if none is set
+        std::vector<size_t> startIndices;
+        std::vector<size_t> endIndices;
+    };
+
+    // Construction / Deconstruction
+public:
+    TemporalTreeLayoutResult() = default;
+    virtual ~TemporalTreeLayoutResult() = default;
+
+    // Methods
+public:
+    /// Create the slots for the nodes and times of the tree, removes all drawing information
+    void reset(const TemporalTree& tree);
+
+    /// Has the result been created for a tree with these nodes
+    bool fitsWithTree(const TemporalTree& tree) const;
+
+    /// All times of the tree, sorted
+    const std::vector<uint64_t>& times() const { return *axis->times; }
+
+    /// Number of times on the axis
+    size_t numTimes() const { return axis ? axis->times->size() : 0; }
+
+    /// Index of a time on the axis or InvalidIndex if the time is not on it
+    size_t timeIndex(const uint64_t time) const;
+
+    /// Number of nodes
+    size_t numNodes() const { return axis ? axis->firstIndices.size() : 0; }
+
+    /// Index of the start time of a node on the axis
+    size_t firstIndex(const size_t nodeIndex) const { return axis->firstIndices[nodeIndex]; }
+
+    /// Index of the end time of a node on the axis
+    size_t lastIndex(const size_t nodeIndex) const { return axis->lastIndices[nodeIndex]; }
+
+    /** @name Limits
+        Lower and upper limit of the band of a node. The start and end index are the
+        first and last time index with limits. */
+    ///@{
+    bool hasLimits(const size_t nodeIndex) const { return hasAny(limitLayer, nodeIndex); }
+    size_t startIndex(const size_t nodeIndex) const { return limitLayer->startIndices[nodeIndex]; }
+    size_t endIndex(const size_t nodeIndex) const { return limitLayer->endIndices[nodeIndex]; }
+
+    bool isSet(const size_t nodeIndex, const size_t timeIdx) const {
+        return has(limitLayer, nodeIndex, timeIdx);
+    }
+
+    const TBandLimits& limits(const size_t nodeIndex, const size_t timeIdx) const {
+        return limitLayer->values[slot(nodeIndex, timeIdx)];
+    }
+
+    /// Write access to limits that have been set before
+    TBandLimits& limits(const size_t nodeIndex, const size_t timeIdx) {
+        return detach(limitLayer).values[slot(nodeIndex, timeIdx)];
+    }
+
+    /// Marks the limits as set and returns them for writing
+    TBandLimits& setLimits(const size_t nodeIndex, const size_t timeIdx) {
+        return set(limitLayer, nodeIndex, timeIdx);
+    }
+
+    /// Marks the limits between two time indices as set and returns the first of them,
+    /// the others follow contiguously
+    TBandLimits* setLimits(const size_t nodeIndex, const size_t startIdx, const size_t endIdx) {
+        return setRange(limitLayer, nodeIndex, startIdx, endIdx);
+    }
+
+    /// Make sure the limits are not shared with another result. Afterwards, limits of
+    /// different nodes can be set from several threads.
+    void detachLimits() { detach(limitLayer); }
+
+    /// Removes the limits of one node
+    void clearLimits(const size_t nodeIndex) { clear(limitLayer, nodeIndex); }
+
+    /// Do both have the same limits for the node
+    bool hasSameLimits(const TemporalTreeLayoutResult& other, const size_t nodeIndex) const;
+    ///@}
+
+    /** @name Changes
+        The layout can update the limits of a previous result instead of computing them from
+        scratch. A downstream stage that has processed the previous result then only needs to
+        update the changed nodes. */
+    ///@{
+    /// Identifies the limits across all results, changes whenever limits are computed
+    uint64_t getLimitsVersion() const { return limitsVersion; }
+
+    /// Version of the limits this result has been updated from, 0 if computed from scratch
+    uint64_t getPreviousLimitsVersion() const { return previousLimitsVersion; }
+
+    /// Nodes whose limits differ from the previous version
+    const std::vector<size_t>& getChangedNodes() const { return changedNodes; }
+
+    /// Has this result been updated from the given one
+    bool isUpdateOf(const TemporalTreeLayoutResult& previous) const {
+        return previousLimitsVersion != 0 && previousLimitsVersion == previous.limitsVersion;
+    }
+
+    /// Continue from the limits of another result on the same nodes and times. Cushions and
+    /// colors are removed, just like a reset does before limits are computed from scratch.
+    void adoptLimits(const TemporalTreeLayoutResult& other);
+
+    /// Mark the limits as computed from scratch
+    void markLimitsComputed();
+
+    /// Mark the limits as updated from the current version, only the given nodes changed
+    void markLimitsUpdated(std::vector<size_t> changedNodeIndices);
+    ///@}
+
+    /** @name Cushions */
+    ///@{
+    bool hasCushions(const size_t nodeIndex) const { return hasAny(cushionLayer, nodeIndex); }
+    size_t cushionStartIndex(const size_t nodeIndex) const {
+        return cushionLayer->startIndices[nodeIndex];
+    }
+    size_t cushionEndIndex(const size_t nodeIndex) const {
+        return cushionLayer->endIndices[nodeIndex];
+    }
+
+    bool hasCushion(const size_t nodeIndex, const size_t timeIdx) const {
+        return has(cushionLayer, nodeIndex, timeIdx);
+    }
+
+    const TCushion& cushion(const size_t nodeIndex, const size_t timeIdx) const {
+        return cushionLayer->values[slot(nodeIndex, timeIdx)];
+    }
+
+    TCushion& cushion(const size_t nodeIndex, const size_t timeIdx) {
+        return detach(cushionLayer).values[slot(nodeIndex, timeIdx)];
+    }
+
+    TCushion& setCushion(const size_t nodeIndex, const size_t timeIdx) {
+        return set(cushionLayer, nodeIndex, timeIdx);
+    }
+
+    /// Removes the cushions of all nodes
+    void clearCushions() { cushionLayer.reset(); }
+
+    /// Removes the cushions of one node
+    void clearCushions(const size_t nodeIndex) { clear(cushionLayer, nodeIndex); }
+
+    /// Use the cushions of another result on the same nodes and times
+    void shareCushions(const TemporalTreeLayoutResult& other) {
+        cushionLayer = other.cushionLayer;
+    }
+    ///@}
+
+    /** @name Colors */
+    ///@{
+    bool hasColors(const size_t nodeIndex) const { return hasAny(colorLayer, nodeIndex); }
+
+    bool hasColor(const size_t nodeIndex, const size_t timeIdx) const {
+        return has(colorLayer, nodeIndex, timeIdx);
+    }
+
+    const vec4& color(const size_t nodeIndex, const size_t timeIdx) const {
+        return colorLayer->values[slot(nodeIndex, timeIdx)];
+    }
+
+    vec4& color(const size_t nodeIndex, const size_t timeIdx) {
+        return detach(colorLayer).values[slot(nodeIndex, timeIdx)];
+    }
+
+    vec4& setColor(const size_t nodeIndex, const size_t timeIdx) {
+        return set(colorLayer, nodeIndex, timeIdx);
+    }
+
+    /// Removes the colors of all nodes
+    void clearColors() { colorLayer.reset(); }
+    ///@}
+
+    /// Memory used by the drawing information in bytes
+    size_t memory() const;
+
+protected:
+    /// Position of the slot of a node for a time index within its lifetime
+    size_t slot(const size_t nodeIndex, const size_t timeIdx) const {
+        ivwAssert(timeIdx >= axis->firstIndices[nodeIndex] &&
+                      timeIdx <= axis->lastIndices[nodeIndex],
+                  "Time index is outside of the lifetime of the node.");
+        return axis->offsets[nodeIndex] + timeIdx - axis->firstIndices[nodeIndex];
+    }
+
+    /// Is the time index within the lifetime of the node
+    bool isInLifetime(const size_t nodeIndex, const size_t timeIdx) const {
+        return axis->firstIndices[nodeIndex] != InvalidIndex &&
+               timeIdx >= axis->firstIndices[nodeIndex] && timeIdx <= axis->lastIndices[nodeIndex];
+    }
+
+    template <typename T>
+    bool hasAny(const std::shared_ptr<TLayer<T>>& layer, const size_t nodeIndex) const {
+        return layer && layer->startIndices[nodeIndex] != InvalidIndex;
+    }
+
+    template <typename T>
+    bool has(const std::shared_ptr<TLayer<T>>& layer, const size_t nodeIndex,
+             const size_t timeIdx) const {
+        return layer && isInLifetime(nodeIndex, timeIdx) &&
+               layer->isSet[slot(nodeIndex, timeIdx)] != 0;
+    }
+
+    /// Make sure this object is the only one holding the layer, creates it if needed
+    template <typename T>
+    TLayer<T>& detach(std::shared_ptr<TLayer<T>>& layer) {
+        if (!layer) {
+            layer = std::make_shared<TLayer<T>>();
+            layer->values.resize(axis->numSlots);
+            layer->isSet.assign(axis->numSlots, 0);
+            layer->startIndices.assign(numNodes(), InvalidIndex);
+            layer->endIndices.assign(numNodes(), InvalidIndex);
+        } else if (layer.use_count() > 1) {
+            layer = std::make_shared<TLayer<T>>(*layer);
+        }
+        return *layer;
+    }
+
+    template <typename T>
+    T& set(std::shared_ptr<TLayer<T>>& layer, const size_t nodeIndex, const size_t timeIdx) {
+        TLayer<T>& writeLayer = detach(layer);
+        const size_t slotIndex = slot(nodeIndex, timeIdx);
+        writeLayer.isSet[slotIndex] = 1;
+        size_t& startIdx = writeLayer.startIndices[nodeIndex];
+        size_t& endIdx = writeLayer.endIndices[nodeIndex];
+        if (startIdx == InvalidIndex) {
+            startIdx = timeIdx;
+            endIdx = timeIdx;
+        } else {
+            startIdx = std::min(startIdx, timeIdx);
+            endIdx = std::max(endIdx, timeIdx);
+        }
+        return writeLayer.values[slotIndex];
+    }
+
+    template <typename T>
+    T* setRange(std::shared_ptr<TLayer<T>>& layer, const size_t nodeIndex, const size_t startIdx,
+                const size_t endIdx) {
+        TLayer<T>& writeLayer = detach(layer);
+        const size_t startSlot = slot(nodeIndex, startIdx);
+        const size_t endSlot = slot(nodeIndex, endIdx);
+        std::fill(writeLayer.isSet.begin() + startSlot, writeLayer.isSet.begin() + endSlot + 1, 1);
+        size_t& firstSetIdx = writeLayer.startIndices[nodeIndex];
+        size_t& lastSetIdx = writeLayer.endIndices[nodeIndex];
+        if (firstSetIdx == InvalidIndex) {
+            firstSetIdx = startIdx;
+            lastSetIdx = endIdx;
+        } else {
+            firstSetIdx = std::min(firstSetIdx, startIdx);
+            lastSetIdx = std::max(lastSetIdx, endIdx);
+        }
+        return writeLayer.values.data() + startSlot;
+    }
+
+    template <typename T>
+    void clear(std::shared_ptr<TLayer<T>>& layer, const size_t nodeIndex) {
+        if (!hasAny(layer, nodeIndex)) return;
+
+        TLayer<T>& writeLayer = detach(layer);
+        const size_t startSlot = slot(nodeIndex, writeLayer.startIndices[nodeIndex]);
+        const size_t endSlot = slot(nodeIndex, writeLayer.endIndices[nodeIndex]);
+        std::fill(writeLayer.isSet.begin() + startSlot, writeLayer.isSet.begin() + endSlot + 1, 0);
+        writeLayer.startIndices[nodeIndex] = InvalidIndex;
+        writeLayer.endIndices[nodeIndex] = InvalidIndex;
+    }
+
+    // Attributes
+protected:
+    std::shared_ptr<const TAxis> axis;
+
+    /// Drawing information, nullptr if nothing has been set
+    std::shared_ptr<TLayer<TBandLimits>> limitLayer;
+    std::shared_ptr<TLayer<TCushion>> cushionLayer;
+    std::shared_ptr<TLayer<vec4>> colorLayer;
+
+    /// Version of the limits and the one they have been updated from
+    uint64_t limitsVersion = 0;
+    uint64_t previousLimitsVersion = 0;
+
+    /// Nodes whose limits changed in the last update
+    std::vector<size_t> changedNodes;
+};
+
+}  // namespace kth
+}  // namespace inviwo
@@ -18,6 +18,76 @@ namespace inviwo {
 namespace kth {
 
 namespace treeorder {
+
+/** \class Permutation
+    \brief Order of nodes together with its inverse, both stored as arrays
+
+    The order holds the node index for each position and the inverse holds the position for each
+    node index. This allows to look up positions and to swap nodes in constant time. Nodes that
+    are not part of the order have an invalid position.
+*/
+class IVW_MODULE_TEMPORALTREEMAPS_API Permutation {
+    // Types
+public:
+    static constexpr size_t InvalidPosition = std::numeric_limits<size_t>::max();
+
+    // Construction / Deconstruction
+public:
+    Permutation() = default;
+
+    /// Order of some of the given number of nodes, such as the order of the leaves of a tree
+    Permutation(const TemporalTree::TTreeOrder& order, const size_t numNodes);
+
+    virtual ~Permutation() = default;
+
+    // Methods
+public:
+    /// Reset to the given order, reuses memory
+    void set(const TemporalTree::TTreeOrder& order, const size_t numNodes);
+
+    /// Number of ordered nodes
+    size_t size() const { return order.size(); }
+
+    /// Number of nodes for which we can look up positions
+    size_t numNodes() const { return positions.size(); }
+
+    /// Node at the given position
+    size_t nodeAt(const size_t position) const { return order[position]; }
+
+    /// Position of the given node
+    size_t positionOf(const size_t nodeIndex) const { return positions[nodeIndex]; }
+
+    /// Is the node part of the order (or has a position assigned)
+    bool contains(const size_t nodeIndex) const {
+        return nodeIndex < positions.size() && positions[nodeIndex] != InvalidPosition;
+    }
+
+    /// Swap the nodes at two positions
+    void swapPositions(const size_t positionA, const size_t positionB);
+
+    /// Swap the positions of two nodes
+    void swapNodes(const size_t nodeA, const size_t nodeB);
+
+    /// Put the node at the given position, the node previously there needs to be
+    /// placed elsewhere by the caller
+    void setNodeAt(const size_t position, const size_t nodeIndex);
+
+    /// Assign a position to a node without putting it into the order,
+    /// used to give inner nodes the position of their leaves
+    void setPosition(const size_t nodeIndex, const size_t position);
+
+    /// The order as a simple vector
+    const TemporalTree::TTreeOrder& getOrder() const { return order; }
+
+    // Attributes
+protected:
+    /// Node index per position
+    TemporalTree::TTreeOrder order;
+
+    /// Position per node index
+    std::vector<size_t> positions;
+};
+
 /// Use the indices of the tree as the order directly
 void orderAsInserted(TemporalTree::TTreeOrder& order, const TemporalTree& tree);
 
@@ -29,19 +99,20 @@ void orderAsDepthFirst(TemporalTree::TTreeOrder& order, const TemporalTree& tree
 /// Checks if the order contains every leaf
 bool fitsWithTree(const TemporalTree& tree, const TemporalTree::TTreeOrder& leafOrder);
 
-/// Sorts a vector of nodes by the given order map
-void sortNodesByOrder(const TemporalTree::TTreeOrderMap& order, const TemporalTree& tree,
+/// Sorts a vector of nodes by the given order
+void sortNodesByOrder(const Permutation& order, const TemporalTree& tree,
                       std::vector<size_t>& nodeIndices);
 
-TemporalTree::TTreeOrderMap expandToFullTree(const TemporalTree& tree,
-                                             const TemporalTree::TTreeOrderMap& leafOrder);
+/// Assign each inner node the minimum position of its children
+Permutation expandToFullTree(const TemporalTree& tree, const Permutation& leafOrder);
 
-void toSimpleOrder(TemporalTree::TTreeOrder& order, const TemporalTree::TTreeOrderMap& orderMap);
+void toSimpleOrder(TemporalTree::TTreeOrder& order, const Permutation& permutation);
 
+/// Map from node index to position, only needed where a sparse map is expected
 void toOrderMap(TemporalTree::TTreeOrderMap& orderMap, const TemporalTree::TTreeOrder& order);
 
 size_t setToMinInChildren(const size_t nodeIndex, const TemporalTree& tree,
-                          TemporalTree::TTreeOrderMap& orderMap);
+                          Permutation& permutation);
 
 }  // namespace treeorder
 
@@ -0,0 +1,195 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 18:10:22
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#pragma once
+
+#include <modules/temporaltreemaps/temporaltreemapsmoduledefine.h>
+#include <inviwo/core/common/inviwo.h>
+#include <modules/temporaltreemaps/datastructures/tree.h>
+
+namespace inviwo {
+namespace kth {
+
+/** \class TemporalTreeTopology
+    \brief Flat index of the edges of a TemporalTree for fast structural queries
+
+    Holds children, parents, temporal successors and predecessors of all nodes in flat arrays
+    with offsets per node, the depth of each node, which nodes are leaves, the nodes of each
+    level, the height of each node above the leaves, and an Euler tour of the hierarchy. In the
+    tour, the leaves below a node form a contiguous range. A node with several parents is put
+    below the parent that reaches it first in the tour, so the range is only complete if no node
+    below has several parents.
+
+    The index is a snapshot of the tree at the time it is built. It needs to be built again
+    after the edges of the tree change.
+
+    @author Tino Weinkauf and Wiebke Koepp
+*/
+class IVW_MODULE_TEMPORALTREEMAPS_API TemporalTreeTopology {
+    // Friends
+    // Types
+public:
+    /// Contiguous range of node indices in one of the flat arrays
+    struct NodeRange {
+        const size_t* first = nullptr;
+        const size_t* last = nullptr;
+
+        const size_t* begin() const { return first; }
+        const size_t* end() const { return last; }
+        size_t size() const { return size_t(last - first); }
+        bool empty() const { return first == last; }
+        size_t operator[](const size_t i) const { return first[i]; }
+    };
+
+    static constexpr size_t InvalidIndex = std::numeric_limits<size_t>::max();
+
+    // Construction / Deconstruction
+public:
+    TemporalTreeTopology() = default;
+    explicit TemporalTreeTopology(const TemporalTree& tree) { build(tree); }
+    virtual ~TemporalTreeTopology() = default;
+
+    // Methods
+public:
+    /// Build the index for the given tree
+    void build(const TemporalTree& tree);
+
+    /// Number of nodes in the tree the index has been built for
+    size_t numNodes() const { return isLeafNode.size(); }
+
+    /// Hierarchical children of a node
+    NodeRange children(const size_t nodeIndex) const {
+        return range(childOffsets, childIndices, nodeIndex);
+    }
+
+    /// Hierarchical parents of a node, sorted by index
+    NodeRange parents(const size_t nodeIndex) const {
+        return range(parentOffsets, parentIndices, nodeIndex);
+    }
+
+    /// Immediate temporal successors of a node
+    NodeRange successors(const size_t nodeIndex) const {
+        return range(successorOffsets, successorIndices, nodeIndex);
+    }
+
+    /// Immediate temporal predecessors of a node, sorted by index
+    NodeRange predecessors(const size_t nodeIndex) const {
+        return range(predecessorOffsets, predecessorIndices, nodeIndex);
+    }
+
+    /// Same as TemporalTree::isLeaf
+    bool isLeaf(const size_t nodeIndex) const { return isLeafNode[nodeIndex]; }
+
+    /// All leaves sorted by index, same as TemporalTree::getLeaves
+    const std::vector<size_t>& leaves() const { return leafIndices; }
+
+    /// Same as TemporalTree::depth, the distance to the root through the first parent
+    size_t depth(const size_t nodeIndex) const { return depths[nodeIndex]; }
+
+    /// Number of levels below the root, same as TemporalTree::getNumLevels(0)
+    size_t numLevels() const { return levelOffsets.size() < 2 ? 0 : levelOffsets.size() - 2; }
+
+    /// Nodes of a level sorted by index, same as TemporalTree::getLevel
+    NodeRange level(const size_t levelIndex) const;
+
+    /// Longest distance to a leaf below the node, 0 for leaves. All children of a node have
+    /// a smaller height, so going through the heights in increasing order visits the
+    /// hierarchy bottom-up and all nodes of one height can be handled independently.
+    size_t height(const size_t nodeIndex) const { return heights[nodeIndex]; }
+
+    /// Number of different heights, one more than the height of the highest node
+    size_t numHeights() const { return heightOffsets.size() - 1; }
+
+    /// Nodes with the given height sorted by index
+    NodeRange nodesOfHeight(const size_t heightIndex) const {
+        return range(heightOffsets, heightNodes, heightIndex);
+    }
+
+    /// Position of the node in the Euler tour of the hierarchy
+    size_t tourEnter(const size_t nodeIndex) const { return tourEnterIndex[nodeIndex]; }
+
+    /// Position after the last node below this one in the Euler tour
+    size_t tourExit(const size_t nodeIndex) const { return tourExitIndex[nodeIndex]; }
+
+    /// Leaves below the node in the Euler tour
+    NodeRange tourLeaves(const size_t nodeIndex) const;
+
+    /// Is every node below this one only reachable through this node,
+    /// then all leaves below it are in the tour range
+    bool isSubtreeExclusive(const size_t nodeIndex) const { return subtreeExclusive[nodeIndex]; }
+
+    /// All leaves below a node sorted by index, also if some nodes below have several parents
+    void getLeaves(const size_t nodeIndex, std::vector<size_t>& leaves) const;
+
+    /// Same as TemporalTree::getLeaves for a time interval
+    void getLeaves(const TemporalTree& tree, const size_t nodeIndex,
+                   const uint64_t initialStartTime, const uint64_t initialEndTime,
+                   uint64_t startTime, uint64_t endTime, std::set<size_t>& leaves) const;
+
+protected:
+    /// Offsets and indices for the given edges, optionally reversed
+    static void buildAdjacency(const size_t numNodes, const TemporalTree::TAdjacency& edges,
+                               const bool reverse, std::vector<size_t>& offsets,
+                               std::vector<size_t>& indices);
+
+    static NodeRange range(const std::vector<size_t>& offsets, const std::vector<size_t>& indices,
+                           const size_t nodeIndex) {
+        const size_t* data = indices.data();
+        return NodeRange{data + offsets[nodeIndex], data + offsets[nodeIndex + 1]};
+    }
+
+    void buildDepths();
+
+    void buildLevels();
+
+    void buildHeights();
+
+    void buildTour();
+
+    // Attributes
+protected:
+    /// Edges per node, the edges of node i are at [offsets[i], offsets[i+1])
+    std::vector<size_t> childOffsets;
+    std::vector<size_t> childIndices;
+    std::vector<size_t> parentOffsets;
+    std::vector<size_t> parentIndices;
+    std::vector<size_t> successorOffsets;
+    std::vector<size_t> successorIndices;
+    std::vector<size_t> predecessorOffsets;
+    std::vector<size_t> predecessorIndices;
+
+    /// Leaves as a bitset and as a list
+    std::vector<bool> isLeafNode;
+    std::vector<size_t> leafIndices;
+
+    /// Distance to the root for each node
+    std::vector<size_t> depths;
+
+    /// Nodes per level, the nodes of level l are at [levelOffsets[l], levelOffsets[l+1])
+    std::vector<size_t> levelOffsets;
+    std::vector<size_t> levelNodes;
+
+    /// Height above the leaves for each node and the nodes per height,
+    /// the nodes of height h are at [heightOffsets[h], heightOffsets[h+1])
+    std::vector<size_t> heights;
+    std::vector<size_t> heightOffsets;
+    std::vector<size_t> heightNodes;
+
+    /// Euler tour, nodes not reachable from the root have InvalidIndex
+    std::vector<size_t> tourEnterIndex;
+    std::vector<size_t> tourExitIndex;
+    std::vector<size_t> tourLeafBegin;
+    std::vector<size_t> tourLeafEnd;
+    std::vector<size_t> tourLeafIndices;
+    std::vector<bool> subtreeExclusive;
+};
+
+}  // namespace kth
+}  // namespace inviwo
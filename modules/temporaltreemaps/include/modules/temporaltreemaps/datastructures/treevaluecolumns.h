@@ -0,0 +1,127 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 20:14:36
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#pragma once
+
+#include <modules/temporaltreemaps/temporaltreemapsmoduledefine.h>
+#include <inviwo/core/common/inviwo.h>
+#include <modules/temporaltreemaps/datastructures/tree.h>
+
+namespace inviwo {
+namespace kth {
+
+/** \class TemporalTreeValueColumns
+    \brief Compact storage of the values of all nodes of a TemporalTree
+
+    All times of the tree are kept once in a sorted time axis. The values of a node are a
+    contiguous column of floats for all axis times from its start to its end time, filled with
+    left neighbor interpolation. This is the same as calling
+    TNode::fillWithLeftNeighborInterpolation with all times of the tree on every node, but
+    lookups and interpolation become index arithmetic and each value takes four bytes.
+
+    The value maps of the tree stay the primary storage. The columns are built from them and
+    can be written back to them, e.g. after computing on the columns.
+
+    @author Tino Weinkauf and Wiebke Koepp
+*/
+class IVW_MODULE_TEMPORALTREEMAPS_API TemporalTreeValueColumns {
+    // Friends
+    // Types
+public:
+    static constexpr size_t InvalidIndex = std::numeric_limits<size_t>::max();
+
+    // Construction / Deconstruction
+public:
+    TemporalTreeValueColumns() = default;
+    explicit TemporalTreeValueColumns(const TemporalTree& tree) { build(tree); }
+    virtual ~TemporalTreeValueColumns() = default;
+
+    // Methods
+public:
+    /// Build the time axis from the times of all nodes and the columns for all nodes
+    void build(const TemporalTree& tree);
+
+    /// Build the columns on the given times, all times of the nodes need to be part of them
+    void build(const TemporalTree& tree, const std::set<uint64_t>& times);
+
+    /// All times, sorted
+    const std::vector<uint64_t>& times() const { return timeAxis; }
+
+    /// Number of times on the axis
+    size_t numTimes() const { return timeAxis.size(); }
+
+    /// Index of a time on the axis or InvalidIndex if the time is not on it
+    size_t timeIndex(const uint64_t time) const;
+
+    /// Number of nodes
+    size_t numNodes() const { return startIndices.size(); }
+
+    /// Does the node have any values
+    bool hasValues(const size_t nodeIndex) const {
+        return startIndices[nodeIndex] != InvalidIndex;
+    }
+
+    /// Index of the start time of a node on the axis
+    size_t startIndex(const size_t nodeIndex) const { return startIndices[nodeIndex]; }
+
+    /// Index of the end time of a node on the axis
+    size_t endIndex(const size_t nodeIndex) const { return endIndices[nodeIndex]; }
+
+    /// Values of a node, the first one belongs to startIndex
+    const float* column(const size_t nodeIndex) const { return buffer.data() + offsets[nodeIndex]; }
+    float* column(const size_t nodeIndex) { return buffer.data() + offsets[nodeIndex]; }
+
+    /// Value of a node at a time index, 0 outside of its lifetime
+    float valueAtIndex(const size_t nodeIndex, const size_t timeIdx) const {
+        if (!hasValues(nodeIndex) || timeIdx < startIndices[nodeIndex] ||
+            timeIdx > endIndices[nodeIndex]) {
+            return 0.0f;
+        }
+        return column(nodeIndex)[timeIdx - startIndices[nodeIndex]];
+    }
+
+    /// Same as TNode::getValueAt
+    float getValueAt(const size_t nodeIndex, const uint64_t time) const;
+
+    /// Values of a node as a map, same as the node values after left neighbor interpolation
+    TemporalTree::TValueMap getValueMap(const size_t nodeIndex) const;
+
+    /// Write the values of all nodes back into the value maps of the tree,
+    /// the tree needs to have the same nodes
+    void writeTo(TemporalTree& tree) const;
+
+    /// Memory used by the values in bytes
+    size_t memory() const {
+        return buffer.size() * sizeof(float) + timeAxis.size() * sizeof(uint64_t) +
+               3 * startIndices.size() * sizeof(size_t);
+    }
+
+protected:
+    /// Fill the columns for the time axis that has been set already
+    void buildColumns(const TemporalTree& tree);
+
+    // Attributes
+protected:
+    /// All times, sorted
+    std::vector<uint64_t> timeAxis;
+
+    /// Range of each node on the time axis, InvalidIndex for nodes without values
+    std::vector<size_t> startIndices;
+    std::vector<size_t> endIndices;
+
+    /// Position of the column of each node in the buffer
+    std::vector<size_t> offsets;
+
+    /// Columns of all nodes after each other
+    std::vector<float> buffer;
+};
+
+}  // namespace kth
+}  // namespace inviwo
@@ -71,8 +71,20 @@ protected:
     /// Our main computation function
     virtual void process() override;
 
-    void traverseToLeavesForCushions(TemporalTree& tree, size_t nodeIndex, uint64_t startTime,
-                                     uint64_t endTime, uint8_t depth);
+    /// Can the cushions of the last run be updated for this tree,
+    /// i.e., its limits have been updated from the limits of the last run
+    bool canUpdateLastCushions(const TemporalTree& tree) const;
+
+    /// Nodes whose cushions need to be computed again: the nodes with changed limits
+    /// and all their descendants
+    std::vector<bool> findNodesToUpdate(const TemporalTree& tree) const;
+
+    /// Span cushions for a node between two time indices and pass them on to its children.
+    /// Only the flagged nodes get new cushions, all of them if no flags are given.
+    void traverseToLeavesForCushions(TemporalTree& tree, size_t nodeIndex, size_t startIdx,
+                                     size_t endIdx, uint8_t depth,
+                                     const std::vector<bool>& nodesToUpdate,
+                                     const std::vector<bool>& nodesToVisit);
 
     // Ports
 public:
@@ -92,6 +104,14 @@ public:
 public:
     // Attributes
 private:
+    /// Result of the last run
+    std::shared_ptr<const TemporalTree> pLastOutTree;
+
+    /// Cushion parameters of the last run
+    float lastBaseHeight = 0.0f;
+    float lastScaleFactor = 0.0f;
+    int lastFrom = -1;
+    int lastTo = -1;
 };
 
 }  // namespace kth
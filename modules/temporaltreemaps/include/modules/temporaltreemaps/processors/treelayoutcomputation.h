@@ -14,6 +14,8 @@
 #include <inviwo/core/common/inviwo.h>
 #include <inviwo/core/processors/processor.h>
 #include <modules/temporaltreemaps/datastructures/treeport.h>
+#include <modules/temporaltreemaps/datastructures/treevaluecolumns.h>
+#include <modules/temporaltreemaps/datastructures/treetopology.h>
 //#include <inviwo/core/ports/volumeport.h>
 //#include <inviwo/core/ports/meshport.h>
 //#include <inviwo/core/properties/boolcompositeproperty.h>
@@ -57,6 +59,9 @@ class IVW_MODULE_TEMPORALTREEMAPS_API TemporalTreeLayoutComputation : public Pro
     // Friends
     // Types
 public:
+    /// Number of times that one thread handles at once
+    static constexpr size_t TimeBlockSize = 256;
+
     // Construction / Deconstruction
 public:
     TemporalTreeLayoutComputation();
@@ -71,23 +76,36 @@ protected:
     /// Our main computation function
     virtual void process() override;
 
-    /// Normalize a given value according to the given value map
-    float normalValue(TemporalTree::TValueMap mapForNormalization, uint64_t time,
-                      float value) const;
-
-    /// Add the normalized given values to the drawing limit
-    void updateUpper(TemporalTree::TDrawingLimitMap& upperCurrent, TemporalTree::TValueMap& values,
-                     TemporalTree::TValueMap& mapForNormalization);
-
-    /// Spread the upper and lower limit towars the root
-    ///(For each node recursively visit all parents for the time frame in which they are the parent)
-    void traverseToRootForLimits(TemporalTree& tree, size_t nodeIndex, uint64_t startTime,
-                                 uint64_t endTime);
-
-    /// Copy a drawing limit for a given time frame
-    void copyLimitInBetween(TemporalTree::TDrawingLimitMap& upperCurrent,
-                            TemporalTree::TDrawingLimitMap& limitToFill, uint64_t startTime,
-                            uint64_t endTime);
+    /// Lower and upper limits of all leaves. Each time is a scan over the leaves in order,
+    /// blocks of times are computed in parallel. Per block, only the leaves from the given
+    /// position on are written, a position past the end skips the block.
+    void computeLeafLimits(const TemporalTree::TTreeOrder& order,
+                           const TemporalTreeValueColumns& columns,
+                           const std::vector<float>& divisors,
+                           const std::vector<size_t>& firstDirtyPositions,
+                           TemporalTreeLayoutResult& layout);
+
+    /// Can the limits of the last run be updated for this tree,
+    /// i.e., only the order or the values of the nodes have changed
+    bool canUpdateLastLayout(const TemporalTree& tree,
+                             const TemporalTreeValueColumns& columns) const;
+
+    /// First position in the order per block of times from which on the limits differ
+    /// from the last run
+    std::vector<size_t> findDirtyPositions(const TemporalTree::TTreeOrder& order,
+                                           const TemporalTreeValueColumns& columns,
+                                           const std::vector<float>& divisors) const;
+
+    /// Update the limits of the last run, records the nodes whose limits changed
+    void updateLimits(TemporalTree& tree, const TemporalTreeTopology& topology,
+                      const TemporalTreeValueColumns& columns, const std::vector<float>& divisors);
+
+    /// Lower and upper limits of the inner nodes as the envelopes of the limits of their
+    /// children within their lifetime. Nodes are handled bottom-up, all nodes with the same
+    /// height above the leaves in parallel. Only the flagged nodes are computed, all inner
+    /// nodes if no flags are given.
+    void computeParentLimits(TemporalTree& tree, const TemporalTreeTopology& topology,
+                             const std::vector<bool>& nodesToUpdate);
 
     // Ports
 public:
@@ -104,6 +122,12 @@ public:
     FloatProperty propMaximum;
     StringProperty propActualMaximum;
 
+    /// Compute blocks of times in parallel
+    BoolProperty propParallel;
+
+    /// Update the limits of the last run if only the order or the values changed
+    BoolProperty propIncremental;
+
     CompositeProperty propRenderInfo;
     BoolProperty propUnixTime;
     DoubleMinMaxProperty propTimeMinMax;
@@ -111,6 +135,12 @@ public:
 
     // Attributes
 private:
+    /// Result of the last run
+    std::shared_ptr<const TemporalTree> pLastOutTree;
+
+    /// Values and normalization of the last run
+    TemporalTreeValueColumns lastColumns;
+    std::vector<float> lastDivisors;
 };
 
 }  // namespace kth
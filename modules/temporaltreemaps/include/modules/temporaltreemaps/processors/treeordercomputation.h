@@ -22,9 +22,14 @@
 #include <inviwo/core/util/timer.h>
 #include <modules/temporaltreemaps/datastructures/treeport.h>
 #include <modules/temporaltreemaps/datastructures/constraint.h>
+#include <modules/temporaltreemaps/datastructures/constraintevaluator.h>
 #include <modules/tools/performancetimer.h>
 #include <inviwo/dataframe/datastructures/dataframe.h>
 #include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 namespace inviwo {
 namespace kth {
@@ -68,7 +73,7 @@ public:
     // Construction / Deconstruction
 public:
     TemporalTreeOrderOptimization();
-    virtual ~TemporalTreeOrderOptimization() = default;
+    virtual ~TemporalTreeOrderOptimization() { stopBackgroundRun(); }
 
     // Methods
 public:
@@ -79,6 +84,10 @@ protected:
     /// Fill some properties based on the statistics file
     void fillStatistics(const ConstraintsStatistic& statistic);
 
+    /// Tree for which we compute the order: the tree of the component if this optimizer
+    /// works on a single component, the tree at the inport otherwise
+    std::shared_ptr<const TemporalTree> getTreeToOrder() const;
+
     void setInitialOrder();
 
     /// Initalize everything
@@ -90,9 +99,37 @@ protected:
 
     double evaluateOrder(const TemporalTree::TTreeOrder& order);
 
+    /// Evaluate the order fully and make it the reference for incremental evaluations
+    double resetOrderEvaluation(const TemporalTree::TTreeOrder& order,
+                                ConstraintsStatistic* statistic);
+
+    /// Evaluate only constraints affected by changes to the reference order,
+    /// the order becomes the new reference. Returns the change in value.
+    double evaluateOrderDelta(const TemporalTree::TTreeOrder& order,
+                              ConstraintsStatistic* statistic);
+
+    /// Same as above for an order that differs from the reference order
+    /// only within the positions [firstPosition, endPosition). The change is only
+    /// estimated from a sample while the objective is estimated.
+    double evaluateOrderDelta(const TemporalTree::TTreeOrder& order, const size_t firstPosition,
+                              const size_t endPosition, ConstraintsStatistic* statistic);
+
+    /// Go back to the reference order before the last delta evaluation,
+    /// a given statistic is brought back to that order as well
+    void revertOrderDelta(ConstraintsStatistic* statistic = nullptr);
+
     /// Reset only statistic things and settings
     virtual void restart();
 
+    /// Are changes of the objective estimated from a sample of the constraints
+    bool isEstimatingObjective() const { return evaluationSampleEvery > 1; }
+
+    /// Compute the lower bound on the objective for the current weights
+    void updateLowerBound();
+
+    /// Has the best state reached the lower bound, i.e., it cannot be improved anymore
+    bool hasReachedLowerBound() const;
+
     /// Is the optimization converged
     virtual bool isConverged() = 0;
 
@@ -102,9 +139,54 @@ protected:
     /// Run until convergence criterion is reached
     virtual void runUntilConvergence() = 0;
 
+    /// New optimizer of the same kind for a single component, nullptr if not supported
+    virtual std::unique_ptr<TemporalTreeOrderOptimization> createComponentOptimizer() const {
+        return nullptr;
+    }
+
+    /// Leaves of each component of the graph connecting leaves and constraints,
+    /// components and leaves are sorted by their position in the current order
+    void getComponents(std::vector<std::vector<size_t>>& components) const;
+
+    /// Tree with the given leaves and all their ancestors. Fills the node in the input tree
+    /// for each node of the new tree.
+    std::shared_ptr<TemporalTree> createComponentTree(const std::vector<size_t>& leaves,
+                                                      std::vector<size_t>& inputNodes) const;
+
+    /// Run until convergence, with one optimizer per component if so desired
+    void runUntilConvergenceByComponents();
+
+    /// Bring the state of the optimization in line with a current order that has been set
+    /// from outside, e.g., merged from the components, or evaluated in full again after
+    /// estimating. The evaluator is already reset to it.
+    virtual void currentOrderChanged() {}
+
+    /// Log an info message. Optimizers of components keep their messages,
+    /// the processor running them logs them afterwards.
+    void logInfo(const std::string& message);
+
     /// Update the output
     void updateOutput();
 
+    /// Show the current and best state in the properties
+    virtual void updateStateProperties();
+
+    /// Start running steps on a worker thread, the main thread stays responsive
+    void startBackgroundRun();
+
+    /// Cancel the worker and wait for it. Subclasses call this in their destructor,
+    /// since the worker calls their methods.
+    void stopBackgroundRun();
+
+    /// Is the worker running (or paused)
+    bool isRunningInBackground() const { return backgroundWorker.joinable(); }
+
+    /// Main loop of the worker: batches of steps, each followed by an update of the output
+    void runInBackground(std::weak_ptr<bool> token, const std::chrono::milliseconds interval);
+
+    /// Clean up after the worker is done, called on the main thread
+    void finishBackgroundRun();
+
     /// Save the log file
     void saveLog();
 
@@ -172,6 +254,9 @@ public:
     /// Weight for level
     DoubleProperty propWeightLevel;
 
+    /// Compare every n-th incremental evaluation with a full one, 0 to never check
+    IntSizeTProperty propVerifyEvery;
+
     /// Everything regarding the inital order
     CompositeProperty propInitialOrder;
 
@@ -196,6 +281,15 @@ public:
     /// Seed for the optimization
     IntProperty propSeedOptimization;
 
+    /// Settings regarding the decomposition into components
+    CompositeProperty propDecomposition;
+
+    /// Optimize the components of the graph connecting leaves and constraints separately
+    BoolProperty propDecompose;
+
+    /// Optimize the components in parallel
+    BoolProperty propParallelComponents;
+
     /* Buttons */
 
     /// Everything regarding settings
@@ -215,6 +309,16 @@ public:
     /// Button for running the optimization until convergence
     ButtonProperty propRunUntilConvergence;
 
+    /// Button for running the optimization until convergence on a worker thread
+    /// until the button is pressed again.
+    ButtonProperty propRunInBackground;
+
+    /// Button for pausing and resuming the worker
+    ButtonProperty propPauseBackground;
+
+    /// Time between output updates while running in the background
+    IntProperty propPublishInterval;
+
     /// Timer for running until convergece
     Timer runTimer;
 
@@ -244,6 +348,9 @@ public:
     /// Display current number of all constraints fulfilled
     FloatProperty propObjectiveValue;
 
+    /// Display the lower bound no order can get below
+    FloatProperty propObjectiveLowerBound;
+
     /// Display the time the last action has taken in ms
     FloatProperty propTimeForLastAction;
 
@@ -276,12 +383,39 @@ protected:
     /// Input tree
     std::shared_ptr<const TemporalTree> pInputTree;
 
+    /// Tree of the component if this optimizer works on a single component
+    std::shared_ptr<const TemporalTree> pComponentTree;
+
+    /// Info messages of the optimizer of a component, logged on the calling thread
+    std::vector<std::string> componentMessages;
+
     /// Random generator used in the optimization
     mutable std::mt19937 randomGen;
 
     /// Extracted constraints
     std::vector<Constraint> constraints;
 
+    /// Extracted constraints as flat arrays for fast evaluation
+    FlatConstraints flatConstraints;
+
+    /// Incremental evaluation of the extracted constraints
+    IncrementalEvaluator evaluator;
+
+    /// Only every n-th affected constraint is checked when evaluating changes
+    size_t evaluationSampleEvery = 1;
+
+    /// Number of exact incremental evaluations since the restart
+    size_t numDeltaEvaluations;
+
+    /// Lower bound on the objective and the weights it was computed for
+    double objectiveLowerBound = 0;
+    std::vector<double> lowerBoundWeights;
+
+    /// Order with positions and times per position for the full evaluation
+    treeorder::Permutation evaluationPermutation;
+    std::vector<uint64_t> evaluationStartByPosition;
+    std::vector<uint64_t> evaluationEndByPosition;
+
     /// Statistics about the extracted constraints
     std::vector<size_t> numByLevelHierarchy;
     std::vector<size_t> numByLevelMergeSplit;
@@ -312,6 +446,23 @@ protected:
 
     /// Prefix for the type of optimization
     std::string logPrefix;
+
+    /// Time until the best state was found in seconds
+    float timeUntilBest;
+
+    /// Worker running the optimization in the background
+    std::thread backgroundWorker;
+
+    /// Requests to the worker and notification about published outputs
+    std::mutex backgroundMutex;
+    std::condition_variable backgroundCondition;
+    std::atomic<bool> backgroundCancel;
+    std::atomic<bool> backgroundPause;
+    std::atomic<bool> backgroundPublishRequested;
+    bool backgroundPublished;
+
+    /// Updates from the worker are only done while this is alive
+    std::shared_ptr<bool> backgroundToken;
 };
 
 }  // namespace kth
@@ -53,7 +53,7 @@ public:
     // Construction / Deconstruction
 public:
     TemporalTreeOrderComputationGreedy();
-    virtual ~TemporalTreeOrderComputationGreedy() = default;
+    virtual ~TemporalTreeOrderComputationGreedy() { stopBackgroundRun(); }
 
     // Methods
 public:
@@ -69,9 +69,16 @@ protected:
 
     void restart() override;
 
+    /// Continue with the constraints unfulfilled by the new current order
+    void currentOrderChanged() override;
+
     /// Is the optimization converged
     bool isConverged() override;
 
+    std::unique_ptr<TemporalTreeOrderOptimization> createComponentOptimizer() const override {
+        return std::make_unique<TemporalTreeOrderComputationGreedy>();
+    }
+
     /// Do a single optimization step
     void singleStep() override;
 
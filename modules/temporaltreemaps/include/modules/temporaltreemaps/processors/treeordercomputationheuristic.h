@@ -54,7 +54,7 @@ public:
     // Construction / Deconstruction
 public:
     TemporalTreeOrderComputationHeuristic();
-    virtual ~TemporalTreeOrderComputationHeuristic() = default;
+    virtual ~TemporalTreeOrderComputationHeuristic() { stopBackgroundRun(); }
 
     // Methods
 public:
@@ -63,7 +63,7 @@ public:
 
     static void findConflictingLeaves(std::shared_ptr<const TemporalTree>& tree,
                                       const Constraint& constraint,
-                                      const TemporalTree::TTreeOrder& order, size_t& minOrder,
+                                      const treeorder::Permutation& order, size_t& minOrder,
                                       size_t& maxOrder, TemporalTree::TTreeOrder& conflictingLeaves,
                                       TemporalTree::TTreeOrder& nonConflictingAndConstraintLeaves);
 
@@ -81,9 +81,16 @@ protected:
 
     void restart() override;
 
+    /// Continue with the constraints unfulfilled by the new current order
+    void currentOrderChanged() override;
+
     /// Is the optimization converged
     bool isConverged() override;
 
+    std::unique_ptr<TemporalTreeOrderOptimization> createComponentOptimizer() const override {
+        return std::make_unique<TemporalTreeOrderComputationHeuristic>();
+    }
+
     /// Do a single optimization step
     void singleStep() override;
 
@@ -110,8 +117,8 @@ public:
 
     // Attributes
 private:
-    /// Order for the current order
-    TemporalTree::TTreeOrderMap currentOrderMap;
+    /// Positions for the current order
+    treeorder::Permutation currentPermutation;
 
     /// Sorted constraints that we operate on
     std::vector<size_t> constraintOrder;
@@ -0,0 +1,173 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 14:05:12
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#pragma once
+
+#include <modules/temporaltreemaps/temporaltreemapsmoduledefine.h>
+#include <inviwo/core/common/inviwo.h>
+#include <inviwo/core/processors/processor.h>
+#include <modules/temporaltreemaps/processors/treeordercomputationsa.h>
+#include <random>
+
+namespace inviwo {
+namespace kth {
+
+/** \docpage{org.inviwo.TemporalTreeOrderComputationParallelTempering, Tree Order Parallel Tempering}
+    ![](org.inviwo.TemporalTreeOrderComputationParallelTempering.png?classIdentifier=org.inviwo.TemporalTreeOrderComputationParallelTempering)
+
+    Optimizes the leaf order with several annealing replicas running at different temperatures.
+
+    ### Inports
+      * __inTree__ Tree for which we compute the order.
+
+    ### Outports
+      * __outTree__ Tree with the optimized order.
+
+    ### Properties
+      * __Replicas__ Number of replicas, the hottest one runs at the current temperature.
+      * __T Ratio__ Ratio between the temperatures of neighboring replicas.
+      * __Steps per Exchange__ Steps every replica does before neighbors exchange states.
+*/
+
+/** \class TemporalTreeOrderComputationParallelTempering
+    \brief Leaf order optimization with parallel tempering
+
+    Each replica holds its own order, incremental evaluator and random generator. The random
+    generator of a replica is seeded from the optimization seed and the replica index only,
+    so the result does not depend on the number of threads. After a number of steps,
+    neighboring replicas exchange their states based on the Metropolis criterion.
+    The temperature ladder is annealed as in the simulated annealing.
+
+    @author Tino Weinkauf and Wiebke Koepp
+*/
+class IVW_MODULE_TEMPORALTREEMAPS_API TemporalTreeOrderComputationParallelTempering
+    : public TemporalTreeSimulatedAnnealing {
+    // Friends
+    // Types
+public:
+    struct Replica {
+        /// Order and value of this replica
+        OptimizationState state;
+        /// Evaluates changes to the order of this replica
+        IncrementalEvaluator evaluator;
+        /// Random stream of this replica
+        std::mt19937 randomGen;
+        /// Temperature of this replica
+        double temperature = 0;
+        /// Memory for the proposed neighbor
+        TemporalTree::TTreeOrder neighborOrder;
+        /// Best order seen by this replica since the last exchange
+        TemporalTree::TTreeOrder bestOrder;
+        double bestValue = std::numeric_limits<double>::max();
+        /// State info of the last step
+        double lastDeltaEnergy = 0;
+        bool lastAccepted = false;
+    };
+
+    // Construction / Deconstruction
+public:
+    TemporalTreeOrderComputationParallelTempering();
+    virtual ~TemporalTreeOrderComputationParallelTempering() { stopBackgroundRun(); }
+
+    // Methods
+public:
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+protected:
+    /// Accept a neighbor state of a replica based on its temperature and difference in energy
+    static bool acceptReplicaNeighbor(double deltaEnergy, double temperature,
+                                      std::mt19937& replicaRandomGen);
+
+    /// Propose a neighbor of the replica order by moving a block, by resolving an unfulfilled
+    /// constraint or by swapping two leaves. Returns the range of changed positions.
+    std::pair<size_t, size_t> replicaNeighbor(Replica& replica) const;
+
+    /// Do a single annealing step of a replica
+    void replicaStep(Replica& replica) const;
+
+    /// Set the temperature of all replicas from the current temperature
+    void setReplicaTemperatures();
+
+    /// Let all replicas do a number of steps
+    void neighborSolution() override;
+
+    /// Initalize everything
+    void initializeResources() override;
+
+    /// Reset only statistic things and settings
+    void restart() override;
+
+    /// All replicas continue from the new current order
+    void currentOrderChanged() override;
+
+    /// Is the optimization converged
+    bool isConverged() override;
+
+    std::unique_ptr<TemporalTreeOrderOptimization> createComponentOptimizer() const override {
+        return std::make_unique<TemporalTreeOrderComputationParallelTempering>();
+    }
+
+    /// Do a single optimization step
+    void singleStep() override;
+
+    void setLastToCurrent() override;
+
+    void setCurrentToLast() override;
+
+    void setBest() override;
+
+    /// Exchange states between neighboring replicas
+    void prepareNextStep() override;
+
+    void updateStateProperties() override;
+
+    void logProperties() override;
+
+    /// Our main computation function
+    virtual void process() override;
+
+    // Ports
+public:
+    // Properties
+public:
+    /// All properties related to parallel tempering
+    CompositeProperty propParallelTempering;
+
+    /// Number of replicas
+    IntProperty propNumReplicas;
+
+    /// Ratio between the temperatures of neighboring replicas
+    DoubleProperty propTemperatureRatio;
+
+    /// Number of steps each replica does between exchanges
+    IntProperty propStepsPerExchange;
+
+    /// Neighbors resolve a constraint, otherwise they swap two leaves
+    BoolProperty propResolveConstraints;
+
+    /// Run the replicas in parallel
+    BoolProperty propParallel;
+
+    /// Display accepted and attempted exchanges
+    StringProperty propExchanges;
+
+    // Attributes
+protected:
+    /// All replicas, the first one is the hottest
+    std::vector<Replica> replicas;
+
+    /// Number of exchanges accepted and attempted
+    size_t numExchangesAccepted;
+    size_t numExchangesAttempted;
+};
+
+}  // namespace kth
+}  // namespace inviwo
@@ -0,0 +1,127 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 17:02:48
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#pragma once
+
+#include <modules/temporaltreemaps/temporaltreemapsmoduledefine.h>
+#include <inviwo/core/common/inviwo.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/boolproperty.h>
+#include <inviwo/core/properties/stringproperty.h>
+#include <modules/temporaltreemaps/processors/treeordercomputation.h>
+#include <modules/temporaltreemaps/datastructures/pqtree.h>
+
+namespace inviwo {
+namespace kth {
+
+/** \docpage{org.inviwo.TemporalTreeOrderComputationPQTree, Tree Order Computation PQ-Tree}
+    ![](org.inviwo.TemporalTreeOrderComputationPQTree.png?classIdentifier=org.inviwo.TemporalTreeOrderComputationPQTree)
+
+    Computes a leaf order in which the leaves of as many constraints as possible are consecutive.
+
+    ### Inports
+      * __inTree__ Tree for which we compute the order.
+
+    ### Outports
+      * __outTree__ Tree with the computed order.
+
+    ### Properties
+      * __Heaviest First__ Add the constraints in the order of their weight.
+      * __Consecutive__ Constraints whose leaves are consecutive and all processed ones.
+*/
+
+/** \class TemporalTreeOrderComputationPQTree
+    \brief Leaf order from a PQ-tree over the constraints
+
+    Each constraint is added to a PQ-tree that holds all orders in which the leaves of the
+    constraints added so far are consecutive. Consecutive leaves are sufficient for a constraint
+    to be fulfilled. A constraint that cannot be added is skipped, so the result fulfills a
+    maximal subset of the constraints. If all constraints can be added, the order has no
+    violations. Otherwise, the order can be used as the input order for the annealing.
+
+    @author Tino Weinkauf and Wiebke Koepp
+*/
+class IVW_MODULE_TEMPORALTREEMAPS_API TemporalTreeOrderComputationPQTree
+    : public TemporalTreeOrderOptimization {
+    // Friends
+    // Types
+public:
+    // Construction / Deconstruction
+public:
+    TemporalTreeOrderComputationPQTree();
+    virtual ~TemporalTreeOrderComputationPQTree() { stopBackgroundRun(); }
+
+    // Methods
+public:
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+protected:
+    /// Add the next constraint to the PQ-tree
+    void addConstraint();
+
+    /// Take the order from the PQ-tree and evaluate it
+    void updateCurrentOrder();
+
+    void initializeResources() override;
+
+    void restart() override;
+
+    /// Take the new current order as the result of adding all constraints
+    void currentOrderChanged() override;
+
+    /// Is the optimization converged, does not log anything
+    bool isConverged() override;
+
+    /// Log why the optimization has converged, once when it gets there
+    void logConvergence();
+
+    std::unique_ptr<TemporalTreeOrderOptimization> createComponentOptimizer() const override {
+        return std::make_unique<TemporalTreeOrderComputationPQTree>();
+    }
+
+    /// Do a single optimization step
+    void singleStep() override;
+
+    /// Run until convergence criterion is reached
+    void runUntilConvergence() override;
+
+    void updateStateProperties() override;
+
+    void logProperties() override;
+
+    /// Our main computation function
+    virtual void process() override;
+
+    // Ports
+public:
+    // Properties
+public:
+    /// Add heavier constraints first, otherwise in the order of extraction
+    BoolProperty propHeaviestFirst;
+
+    /// Display consecutive and processed constraints
+    StringProperty propConsecutive;
+
+    // Attributes
+protected:
+    /// All orders that keep the accepted constraints consecutive
+    treeorder::PQTree pqTree;
+
+    /// Order in which the constraints are added
+    std::vector<size_t> constraintQueue;
+
+    /// Number of constraints added or skipped so far
+    size_t numProcessed;
+    size_t numAccepted;
+};
+
+}  // namespace kth
+}  // namespace inviwo
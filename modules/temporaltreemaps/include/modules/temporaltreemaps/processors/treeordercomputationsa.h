@@ -13,6 +13,7 @@
 #include <modules/temporaltreemaps/temporaltreemapsmoduledefine.h>
 #include <inviwo/core/common/inviwo.h>
 #include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/optionproperty.h>
 #include <modules/temporaltreemaps/processors/treeordercomputation.h>
 #include <random>
 
@@ -47,6 +48,16 @@ class IVW_MODULE_TEMPORALTREEMAPS_API TemporalTreeSimulatedAnnealing
     // Friends
     // Types
 public:
+    enum NeighborhoodType {
+        ProcessorMoves,  // whatever the processor does in neighborSolution
+        BlockMoves,      // move or reverse blocks of subtrees and constraint groups
+    };
+
+    enum CoolingSchedule {
+        Exponential,  // fixed multiplicative decay
+        Adaptive,     // decay depends on the acceptance ratio at the last temperature
+    };
+
     // Construction / Deconstruction
 public:
     TemporalTreeSimulatedAnnealing();
@@ -59,18 +70,45 @@ public:
 
 protected:
     // Swap two nodes in the given vector, assumes there are two
-    // nodes in that vector
-    void swapNodes(std::vector<size_t>& nodes);
+    // nodes in that vector. Returns the swapped positions in ascending order.
+    std::pair<size_t, size_t> swapNodes(std::vector<size_t>& nodes);
+
+    /// Move or reverse the block spanned by the leaves of a random constraint or a single
+    /// random leaf, positions are those of the order. The block is moved by at most its own
+    /// size such that only few leaves change their position. Returns the changed range.
+    std::pair<size_t, size_t> moveBlock(TemporalTree::TTreeOrder& order,
+                                        const treeorder::Permutation& positions,
+                                        std::mt19937& generator) const;
 
     /// Decay the temperature
     void decayTemperature();
 
+    /// Decay the temperature after the specified number of iterations per temperature
+    /// and reheat after too many iterations without improvement.
+    /// Returns true if the temperature changed.
+    bool updateTemperature();
+
+    /// Generate a neighbor state from the current state and evaluate it,
+    /// returns the change in energy
+    double proposeNeighbor();
+
+    /// Initial temperature such that the average uphill move of a number of sampled
+    /// neighbors is accepted with the given probability
+    double estimateInitialTemperature();
+
+    /// Set how many constraints are sampled for the current temperature,
+    /// switches to the exact evaluation below the threshold
+    void updateSampling();
+
     /// Accept a neighbor state based on current temperature and difference in energy
     bool acceptNeighbor(double deltaEnergy) const;
 
     /// Neighbor Solution from the current state
     virtual void neighborSolution() = 0;
 
+    /// Evaluate the neighbor with respect to the last state, returns the change in energy
+    virtual double evaluateNeighbor();
+
     /// Initalize everything
     virtual void initializeResources() override = 0;
 
@@ -95,6 +133,8 @@ protected:
 
     virtual void setBest() = 0;
 
+    virtual void updateStateProperties() override;
+
     virtual void logProperties() override;
 
     void initializeLog() override;
@@ -123,6 +163,36 @@ public:
     /// Number of iterations per temperature setting
     IntProperty propIterationsPerTemp;
 
+    /// How the temperature decays
+    OptionPropertyInt propCoolingSchedule;
+
+    /// Estimate the initial temperature from sampled neighbors instead of using the given one
+    BoolProperty propEstimateInitialTemperature;
+
+    /// Probability to accept an average uphill move at the estimated initial temperature
+    DoubleProperty propInitialAcceptance;
+
+    /// Number of neighbors sampled for the estimation
+    IntProperty propTemperatureSamples;
+
+    /// Number of iterations without improvement after which we reheat (0 for never)
+    IntProperty propReheatAfter;
+
+    /// Number of iterations without improvement after which we stop (0 for never)
+    IntProperty propStopAfter;
+
+    /// Estimate changes of the objective from a sample of constraints while it is hot
+    BoolProperty propSampledEvaluation;
+
+    /// Fraction of the affected constraints sampled at the initial temperature
+    DoubleProperty propInitialSampleFraction;
+
+    /// Evaluate exactly below this fraction of the initial temperature
+    DoubleProperty propExactBelow;
+
+    /// Which moves generate the neighbor states
+    OptionPropertyInt propNeighborhood;
+
     /// The current temperature
     DoubleProperty propCurrentTemperature;
 
@@ -145,6 +215,24 @@ protected:
 
     /// State info: What was the last enegery delta
     double lastDeltaEnergy;
+
+    /// State info: Positions changed by the last block move
+    std::pair<size_t, size_t> lastBlockRange;
+
+    /// Initial temperature still needs to be estimated before the first step
+    bool needsTemperatureEstimate = false;
+
+    /// Number of accepted neighbors at the current temperature
+    size_t numAcceptedAtTemperature = 0;
+
+    /// Temperature at which the best state was found, we reheat to it
+    double bestTemperature = 0;
+
+    /// Iteration of the last reheating
+    size_t lastReheatIteration = 0;
+
+    /// Temperature at the start, the sample fraction grows from there
+    double startTemperature = 0;
 };
 
 }  // namespace kth
@@ -49,7 +49,7 @@ public:
     // Construction / Deconstruction
 public:
     TemporalTreeOrderComputationSAConstraints();
-    virtual ~TemporalTreeOrderComputationSAConstraints() = default;
+    virtual ~TemporalTreeOrderComputationSAConstraints() { stopBackgroundRun(); }
 
     // Methods
 public:
@@ -70,6 +70,13 @@ protected:
     /// Reset only statistic things and settings
     void restart() override;
 
+    /// Continue from the new current order
+    void currentOrderChanged() override;
+
+    std::unique_ptr<TemporalTreeOrderOptimization> createComponentOptimizer() const override {
+        return std::make_unique<TemporalTreeOrderComputationSAConstraints>();
+    }
+
     void setLastToCurrent() override;
 
     void setCurrentToLast() override;
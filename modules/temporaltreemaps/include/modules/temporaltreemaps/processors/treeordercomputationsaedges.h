@@ -56,10 +56,20 @@ public:
         MergesAndSplits,  // or one type higher up
     };
 
+    /// Undo log entry for a swap of two children of an active node
+    struct SwapRecord {
+        size_t node = 0;
+        size_t first = 0;
+        size_t second = 0;
+        /// Range of positions in the order that the swap changed
+        size_t beginPosition = 0;
+        size_t endPosition = 0;
+    };
+
     // Construction / Deconstruction
 public:
     TemporalTreeOrderComputationSAEdges();
-    virtual ~TemporalTreeOrderComputationSAEdges() = default;
+    virtual ~TemporalTreeOrderComputationSAEdges() { stopBackgroundRun(); }
 
     // Methods
 public:
@@ -70,12 +80,22 @@ protected:
     /// Neighbor Solution from the current state
     void neighborSolution() override;
 
+    /// Evaluate only the positions changed by the last swap
+    double evaluateNeighbor() override;
+
     /// Initalize everything
     void initializeResources() override;
 
     /// Reset only statistic things and settings
     void restart() override;
 
+    /// Arrange the heuristic edges like the new current order
+    void currentOrderChanged() override;
+
+    std::unique_ptr<TemporalTreeOrderOptimization> createComponentOptimizer() const override {
+        return std::make_unique<TemporalTreeOrderComputationSAEdges>();
+    }
+
     void setLastToCurrent() override;
 
     void setCurrentToLast() override;
@@ -106,6 +126,17 @@ private:
     /// e.g. subtrees that do not contain any original tree leaves
     void cleanEdges(std::shared_ptr<const TemporalTree> tree);
 
+    /// Set parent, number of leaves and offset for the subtree of the heuristic edges
+    /// rooted at the given node, returns the number of leaves in that subtree
+    size_t computeLeafRanges(const size_t nodeIndex, const size_t offset);
+
+    /// Position of the first leaf below the node in the current order
+    size_t firstLeafPosition(size_t nodeIndex) const;
+
+    /// Exchange the leaf blocks of two children of a node in the current order
+    /// after they have been swapped in the heuristic edges
+    void exchangeLeafBlocks(const size_t nodeIndex, const size_t first, const size_t second);
+
     // Ports
 public:
     // Properties
@@ -118,10 +149,17 @@ protected:
 
     /// The current heuristic edges
     TemporalTree::TAdjacency currentEdges;
-    /// The current best heuristic edges
-    TemporalTree::TAdjacency bestEdges;
-    /// The last heuristic edges
-    TemporalTree::TAdjacency lastEdges;
+
+    /// Parent of each node in the heuristic edges
+    std::vector<size_t> parentInEdges;
+    /// Number of original leaves below each node in the heuristic edges,
+    /// they form a contiguous block in the current order
+    std::vector<size_t> numLeavesInEdges;
+    /// Position of the block of each node relative to the block of its parent
+    std::vector<size_t> offsetInEdges;
+
+    /// The last swap, undone when the neighbor is rejected
+    SwapRecord lastSwap;
 
     /// The current reverse heuristic edges (only used in initial building)
     TemporalTree::TAdjacency currentReverseEdges;
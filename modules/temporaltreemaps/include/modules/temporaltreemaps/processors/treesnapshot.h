@@ -0,0 +1,93 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 19:31:05
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#pragma once
+
+#include <modules/temporaltreemaps/temporaltreemapsmoduledefine.h>
+#include <inviwo/core/common/inviwo.h>
+#include <inviwo/core/processors/processor.h>
+#include <modules/temporaltreemaps/datastructures/treeport.h>
+#include <modules/temporaltreemaps/datastructures/treeintervalindex.h>
+#include <inviwo/core/properties/boolproperty.h>
+#include <inviwo/core/properties/ordinalproperty.h>
+
+namespace inviwo {
+namespace kth {
+
+/** \docpage{org.inviwo.TemporalTreeSnapshot, Tree Snapshot}
+    ![](org.inviwo.TemporalTreeSnapshot.png?classIdentifier=org.inviwo.TemporalTreeSnapshot)
+
+    Extracts the hierarchy of a temporal tree at a single time.
+
+    ### Inports
+      * __inTree__ Temporal tree.
+
+    ### Outports
+      * __outTree__ Static tree with the nodes alive at the chosen time.
+
+    ### Properties
+      * __Time__ Time of the snapshot.
+      * __Duration__ Length of the time interval the snapshot nodes cover.
+      * __Accumulate__ Inner nodes hold the sum of their children at that time.
+*/
+
+/** \class TemporalTreeSnapshot
+    \brief Hierarchy of a temporal tree at a single time
+
+    The interval index over the node lifetimes is built once per input tree,
+    so changing the time only extracts the nodes alive at that time.
+
+    @author Tino Weinkauf and Wiebke Koepp
+*/
+class IVW_MODULE_TEMPORALTREEMAPS_API TemporalTreeSnapshot : public Processor {
+    // Friends
+    // Types
+public:
+    // Construction / Deconstruction
+public:
+    TemporalTreeSnapshot();
+    virtual ~TemporalTreeSnapshot() = default;
+
+    // Methods
+public:
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+protected:
+    /// Our main computation function
+    virtual void process() override;
+
+    // Ports
+public:
+    TemporalTreeInport portInTree;
+    TemporalTreeOutport portOutTree;
+
+    // Properties
+public:
+    /// Time of the snapshot
+    IntSizeTProperty propTime;
+
+    /// Length of the interval the snapshot nodes cover
+    IntSizeTProperty propDeltaTime;
+
+    /// Accumulate values of inner nodes
+    BoolProperty propAccumulate;
+
+    // Attributes
+private:
+    /// Lifetimes of the nodes in the input tree
+    TemporalTreeIntervalIndex intervalIndex;
+
+    /// Tree the index has been built for
+    std::shared_ptr<const TemporalTree> pIndexedTree;
+};
+
+}  // namespace kth
+}  // namespace inviwo
@@ -9,6 +9,8 @@
  */
 
 #include <modules/temporaltreemaps/datastructures/constraint.h>
+#include <modules/temporaltreemaps/datastructures/treetopology.h>
+#include <unordered_map>
 
 namespace inviwo {
 namespace kth {
@@ -29,7 +31,11 @@ size_t ConstraintsStatistic::numFulFilledMergeSplitConstraints() const {
 }
 
 void ConstraintsStatistic::update(const Constraint& constraint) {
-    if (constraint.fulfilled) {
+    update(constraint, constraint.fulfilled);
+}
+
+void ConstraintsStatistic::update(const Constraint& constraint, const bool isFulfilled) {
+    if (isFulfilled) {
         auto& levelStatistic = constraint.type == ConstraintType::Hierarchy
                                    ? fulfilledByLevelHierarchy
                                    : fulfilledByLevelMergeSplit;
@@ -43,6 +49,88 @@ void ConstraintsStatistic::update(const Constraint& constraint) {
     }
 }
 
+void FlatConstraints::build(const TemporalTree& tree, const std::vector<Constraint>& constraints) {
+    const size_t numConstraints = constraints.size();
+    const size_t numNodes = tree.nodes.size();
+
+    leafBuffer.clear();
+    leafOffsets.resize(numConstraints + 1);
+    startTimes.resize(numConstraints);
+    endTimes.resize(numConstraints);
+
+    leafOffsets[0] = 0;
+    for (size_t constraintId(0); constraintId < numConstraints; constraintId++) {
+        const Constraint& constraint = constraints[constraintId];
+        leafBuffer.insert(leafBuffer.end(), constraint.leaves.begin(), constraint.leaves.end());
+        leafOffsets[constraintId + 1] = leafBuffer.size();
+        startTimes[constraintId] = constraint.startTime;
+        endTimes[constraintId] = constraint.endTime;
+    }
+
+    nodeStartTimes.resize(numNodes);
+    nodeEndTimes.resize(numNodes);
+    for (size_t nodeIndex(0); nodeIndex < numNodes; nodeIndex++) {
+        nodeStartTimes[nodeIndex] = tree.nodes[nodeIndex].startTime();
+        nodeEndTimes[nodeIndex] = tree.nodes[nodeIndex].endTime();
+    }
+}
+
+void timesByPosition(const FlatConstraints& constraints, const treeorder::Permutation& order,
+                     std::vector<uint64_t>& startByPosition, std::vector<uint64_t>& endByPosition) {
+    const size_t numPositions = order.size();
+    startByPosition.resize(numPositions);
+    endByPosition.resize(numPositions);
+    for (size_t position(0); position < numPositions; position++) {
+        startByPosition[position] = constraints.nodeStartTimes[order.nodeAt(position)];
+        endByPosition[position] = constraints.nodeEndTimes[order.nodeAt(position)];
+    }
+}
+
+bool isFulFilled(const FlatConstraints& constraints, const size_t constraintId,
+                 const treeorder::Permutation& order, const std::vector<uint64_t>& startByPosition,
+                 const std::vector<uint64_t>& endByPosition) {
+    const size_t* leaves = constraints.leavesBegin(constraintId);
+    const size_t numLeaves = constraints.numLeaves(constraintId);
+
+    // Minimum and maximum position of the constraint leaves
+    size_t minOrder(order.size());
+    size_t maxOrder(0);
+    for (size_t i(0); i < numLeaves; i++) {
+        const size_t mappedTo = order.positionOf(leaves[i]);
+        minOrder = std::min(minOrder, mappedTo);
+        maxOrder = std::max(maxOrder, mappedTo);
+    }
+
+    // Leaves are all together
+    if (maxOrder + 1 == minOrder + numLeaves) return true;
+
+    // Count all leaves in between that overlap in time with the constraint, see
+    // isOverlappingWithConstraint. The inner loop has no branches and compiles to vectorized
+    // code, we only stop early between blocks once we have seen too many overlapping leaves.
+    const uint64_t constraintStart = constraints.startTimes[constraintId];
+    const uint64_t constraintEnd = constraints.endTimes[constraintId];
+    const bool isSingleTimeConstraint = constraintStart == constraintEnd;
+    const uint64_t* starts = startByPosition.data();
+    const uint64_t* ends = endByPosition.data();
+
+    constexpr size_t blockSize = 64;
+    size_t numOverlap(0);
+    for (size_t blockStart = minOrder; blockStart <= maxOrder && numOverlap <= numLeaves;
+         blockStart += blockSize) {
+        const size_t blockEnd = std::min(blockStart + blockSize, maxOrder + 1);
+        for (size_t r = blockStart; r < blockEnd; r++) {
+            const uint64_t overlapStart = std::max(constraintStart, starts[r]);
+            const uint64_t overlapEnd = std::min(constraintEnd, ends[r]);
+            numOverlap += size_t(
+                (overlapStart < overlapEnd) |
+                ((overlapStart == overlapEnd) & (isSingleTimeConstraint | (starts[r] == ends[r]))));
+        }
+    }
+
+    // Only the constraint leaves are allowed to overlap
+    return numOverlap == numLeaves;
+}
+
 size_t numConstraints(const std::vector<size_t>& numByLevel) {
     size_t sum(0);
     for (auto number : numByLevel) {
@@ -51,15 +139,128 @@ size_t numConstraints(const std::vector<size_t>& numByLevel) {
     return sum;
 }
 
+double lowerBoundUnfulfilled(const FlatConstraints& constraints,
+                             const std::vector<double>& weights) {
+    const size_t numConstraints = constraints.size();
+    ivwAssert(weights.size() == numConstraints, "Need one weight per constraint.");
+
+    // Constraints per leaf
+    std::vector<std::vector<size_t>> constraintsByLeaf(constraints.numNodes());
+    for (size_t constraintId(0); constraintId < numConstraints; constraintId++) {
+        std::for_each(constraints.leavesBegin(constraintId), constraints.leavesEnd(constraintId),
+                      [&](const size_t leaf) { constraintsByLeaf[leaf].push_back(constraintId); });
+    }
+
+    // A leaf that is not part of the constraint breaks it when placed within its leaves
+    auto isOverlapping = [&](const size_t leaf, const size_t constraintId) {
+        Constraint window;
+        window.startTime = constraints.startTimes[constraintId];
+        window.endTime = constraints.endTimes[constraintId];
+        return isOverlappingWithConstraint(constraints.nodeStartTimes[leaf],
+                                           constraints.nodeEndTimes[leaf], window);
+    };
+
+    // Each constraint can be part of one conflict only
+    std::vector<bool> isPacked(numConstraints, false);
+    double bound(0);
+
+    // Shared leaf: each of these constraints needs its other leaves on one side of the shared
+    // one, without leaves of the others in between. Two of three end up on the same side and
+    // the one reaching further contains leaves of the other.
+    auto isSharingOnly = [&](const size_t a, const size_t b, const size_t sharedLeaf) {
+        const size_t* itA = constraints.leavesBegin(a);
+        const size_t* itB = constraints.leavesBegin(b);
+        while (itA != constraints.leavesEnd(a) && itB != constraints.leavesEnd(b)) {
+            if (*itA < *itB) {
+                itA++;
+            } else if (*itB < *itA) {
+                itB++;
+            } else {
+                if (*itA != sharedLeaf) return false;
+                itA++;
+                itB++;
+            }
+        }
+        auto othersOverlap = [&](const size_t from, const size_t with) {
+            return std::all_of(
+                constraints.leavesBegin(from), constraints.leavesEnd(from),
+                [&](const size_t leaf) { return leaf == sharedLeaf || isOverlapping(leaf, with); });
+        };
+        return othersOverlap(a, b) && othersOverlap(b, a);
+    };
+
+    for (size_t leaf(0); leaf < constraintsByLeaf.size(); leaf++) {
+        std::vector<size_t> selected;
+        for (auto constraintId : constraintsByLeaf[leaf]) {
+            if (isPacked[constraintId] || constraints.numLeaves(constraintId) < 2) continue;
+            if (!std::all_of(selected.begin(), selected.end(), [&](const size_t other) {
+                    return isSharingOnly(constraintId, other, leaf);
+                })) {
+                continue;
+            }
+
+            selected.push_back(constraintId);
+            if (selected.size() == 3) {
+                double minWeight(std::numeric_limits<double>::max());
+                for (auto selectedId : selected) {
+                    isPacked[selectedId] = true;
+                    minWeight = std::min(minWeight, weights[selectedId]);
+                }
+                bound += minWeight;
+                selected.clear();
+            }
+        }
+    }
+
+    // Triangle u-v, v-w, w-u: the leaf in the middle is between the other two
+    auto otherLeaf = [&](const size_t constraintId, const size_t leaf) {
+        const size_t* leaves = constraints.leavesBegin(constraintId);
+        return leaves[0] == leaf ? leaves[1] : leaves[0];
+    };
+    auto isPair = [&](const size_t constraintId) {
+        return !isPacked[constraintId] && constraints.numLeaves(constraintId) == 2;
+    };
+
+    for (size_t constraintUV(0); constraintUV < numConstraints; constraintUV++) {
+        if (!isPair(constraintUV)) continue;
+        const size_t u = constraints.leavesBegin(constraintUV)[0];
+        const size_t v = constraints.leavesBegin(constraintUV)[1];
+
+        for (auto constraintVW : constraintsByLeaf[v]) {
+            if (isPacked[constraintUV]) break;
+            if (constraintVW == constraintUV || !isPair(constraintVW)) continue;
+            const size_t w = otherLeaf(constraintVW, v);
+            if (w == u || !isOverlapping(w, constraintUV) || !isOverlapping(u, constraintVW)) {
+                continue;
+            }
+
+            for (auto constraintWU : constraintsByLeaf[w]) {
+                if (constraintWU == constraintVW || !isPair(constraintWU) ||
+                    otherLeaf(constraintWU, w) != u || !isOverlapping(v, constraintWU)) {
+                    continue;
+                }
+
+                isPacked[constraintUV] = true;
+                isPacked[constraintVW] = true;
+                isPacked[constraintWU] = true;
+                bound += std::min(
+                    {weights[constraintUV], weights[constraintVW], weights[constraintWU]});
+                break;
+            }
+        }
+    }
+
+    return bound;
+}
+
 bool isFulFilled(Constraint& constraint, std::shared_ptr<const TemporalTree>& tree,
-                 const TemporalTree::TTreeOrder& order,
-                 const TemporalTree::TTreeOrderMap& orderMap) {
+                 const treeorder::Permutation& order) {
     size_t minOrder(order.size());  // numbere of leaves is maximum order
     size_t maxOrder(0);             // 0 is minimum order
 
     // Record minimum and maximum order index for each leaf
     for (const auto leaf : constraint.leaves) {
-        const auto mappedTo = orderMap.at(leaf);
+        const auto mappedTo = order.positionOf(leaf);
         if (mappedTo < minOrder) minOrder = mappedTo;
         if (mappedTo > maxOrder) maxOrder = mappedTo;
     }
@@ -89,7 +290,7 @@ bool isFulFilled(Constraint& constraint, std::shared_ptr<const TemporalTree>& tr
             // |---| or     |-----|
             // We need to exclude this case for hierarchy constraints, for merge/split constraints
             // it is still relevant
-            if (isOverlappingWithConstraint(tree->nodes[order[r]], constraint)) {
+            if (isOverlappingWithConstraint(tree->nodes[order.nodeAt(r)], constraint)) {
                 NumOverlap--;
             }
         }
@@ -105,15 +306,14 @@ bool isFulFilled(Constraint& constraint, std::shared_ptr<const TemporalTree>& tr
 }
 
 size_t numFulfilledConstraints(std::shared_ptr<const TemporalTree>& tree,
-                               const TemporalTree::TTreeOrder& order,
-                               const TemporalTree::TTreeOrderMap& orderMap,
+                               const treeorder::Permutation& order,
                                std::vector<Constraint>& constraints,
                                ConstraintsStatistic& statistic) {
     size_t numFullfilled = 0;
 
     // For each constraint, make sure leaves are together at the time of the constraint
     for (auto& constraint : constraints) {
-        if (isFulFilled(constraint, tree, order, orderMap)) {
+        if (isFulFilled(constraint, tree, order)) {
             numFullfilled++;
         }
         statistic.update(constraint);
@@ -122,163 +322,184 @@ size_t numFulfilledConstraints(std::shared_ptr<const TemporalTree>& tree,
     return numFullfilled;
 }
 
-void extractMergeSplitConstraints(std::shared_ptr<const TemporalTree>& tree,
-                                  std::vector<Constraint>& constraints,
-                                  std::vector<size_t>& numByLevel) {
-    std::vector<std::pair<int, int>> constraintsForAllNodes;
-    // const size_t numConstraints = tree->getConstraintClusters(constraintsForAllNodes);
-    const size_t numConstraintsAlreadyPresent = constraints.size();
-
-    // constraints.resize(numConstraintsAlreadyPresent + numConstraints);
-
-    std::vector<std::pair<size_t, size_t>> numLeftRight(1, {0, 0});
-
-    // Get reversed time edges
-    TemporalTree::TAdjacency reversedEdgesTime = tree->getReverseEdges(tree->edgesTime);
+namespace {
+/// Merge/split constraint of a single group of time edges, before removing redundant ones
+struct Candidate {
+    Constraint constraint;
+    /// Number of nodes on the left and right side
+    size_t numLeft = 0;
+    size_t numRight = 0;
+    bool isValid = false;
+};
+
+/// Constraint indices by the hash of their leaves
+using LeavesIndex = std::unordered_map<size_t, std::vector<size_t>>;
+
+/// Hash of a set of leaves, equal sets have equal hashes
+size_t hashLeaves(const std::set<size_t>& leaves) {
+    size_t hash = std::hash<size_t>()(leaves.size());
+    for (auto leaf : leaves) {
+        hash ^= std::hash<size_t>()(leaf) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
 
-    size_t constraintId = 0;
-    bool addConstraint = false;
-    // Extract splits and direct correspondances
-    for (const auto& edge : tree->edgesTime) {
-        addConstraint = false;
-        Constraint newConstraint;
+/// Same as isRedundant, but only looks at constraints with the same hash of their leaves
+bool isRedundant(const Constraint& constraint, const size_t hash,
+                 const std::vector<Constraint>& constraints, const LeavesIndex& index) {
+    auto itSameHash = index.find(hash);
+    if (itSameHash == index.end()) return false;
 
-        // Shorthands
-        const size_t idFromLeft(edge.first);
+    for (auto constraintId : itSameHash->second) {
+        const Constraint& constraintToCheck = constraints[constraintId];
+        if (TemporalTree::TNode::isOverlappingTemporally(constraint.startTime, constraint.endTime,
+                                                         constraintToCheck.startTime,
+                                                         constraintToCheck.endTime) &&
+            constraint.leaves == constraintToCheck.leaves) {
+            return true;
+        }
+    }
 
-        newConstraint.level = tree->depthWithReverse(idFromLeft);
+    return false;
+}
 
-        std::set<size_t> leaves;
-        const auto& time = tree->nodes[idFromLeft].endTime();
-        tree->getLeaves(idFromLeft, time, time, time, time, leaves);
+/// Split or direct correspondance at the end of the left node of a time edge group
+void createSplitCandidate(const TemporalTree& tree, const TemporalTreeTopology& topology,
+                          const size_t idFromLeft, Candidate& candidate) {
+    Constraint& newConstraint = candidate.constraint;
+    newConstraint.level = topology.depth(idFromLeft);
+
+    std::set<size_t> leaves;
+    const auto& time = tree.nodes[idFromLeft].endTime();
+    topology.getLeaves(tree, idFromLeft, time, time, time, time, leaves);
+    newConstraint.leaves.insert(leaves.begin(), leaves.end());
+    newConstraint.startTime = time;
+    newConstraint.endTime = time;
+    newConstraint.fulfilled = false;
+    candidate.numLeft++;
+
+    const auto idsToRight = topology.successors(idFromLeft);
+    if (idsToRight.empty()) return;
+
+    // This is an actual split
+    if (idsToRight.size() > 1) {
+        for (auto idToRight : idsToRight) {
+            leaves.clear();
+            topology.getLeaves(tree, idToRight, time, time, time, time, leaves);
+            newConstraint.leaves.insert(leaves.begin(), leaves.end());
+            candidate.numRight++;
+            candidate.isValid = true;
+        }
+    } else if (topology.predecessors(idsToRight[0]).size() == 1) {
+        // It is a direct correspondance
+        leaves.clear();
+        topology.getLeaves(tree, idsToRight[0], time, time, time, time, leaves);
         newConstraint.leaves.insert(leaves.begin(), leaves.end());
-        newConstraint.startTime = time;
-        newConstraint.endTime = time;
-        newConstraint.fulfilled = false;
-        numLeftRight[constraintId].first++;
-
-        // Safety
-        const std::vector<size_t>& idsToRight = edge.second;
-        ivwAssert(!idsToRight.empty(), "Time map is empty.");
-        if (idsToRight.empty()) continue;
-
-        // This is an actual split
-        if (idsToRight.size() > 1) {
-            for (auto idToRight : idsToRight) {
-                leaves.clear();
-                tree->getLeaves(idToRight, time, time, time, time, leaves);
-                newConstraint.leaves.insert(leaves.begin(), leaves.end());
-                numLeftRight[constraintId].second++;
-                addConstraint = true;
-            }
+        candidate.numRight++;
+        candidate.isValid = true;
+    }
+}
 
-        } else {
-            auto leftForThatOneRight = reversedEdgesTime.find(idsToRight.front());
-            if (leftForThatOneRight != reversedEdgesTime.end()) {
-                // If it is a direct correspondance
-                if (leftForThatOneRight->second.size() == 1) {
-                    leaves.clear();
-                    tree->getLeaves(idsToRight.front(), time, time, time, time, leaves);
-                    newConstraint.leaves.insert(leaves.begin(), leaves.end());
-                    numLeftRight[constraintId].second++;
-                    addConstraint = true;
-                }
-            }
+/// Merge at the start of the right node of a reversed time edge group
+void createMergeCandidate(const TemporalTree& tree, const TemporalTreeTopology& topology,
+                          const size_t idToRight, Candidate& candidate) {
+    Constraint& newConstraint = candidate.constraint;
+    newConstraint.level = topology.depth(idToRight);
+
+    std::set<size_t> leaves;
+    const auto& time = tree.nodes[idToRight].startTime();
+    topology.getLeaves(tree, idToRight, time, time, time, time, leaves);
+    newConstraint.leaves.insert(leaves.begin(), leaves.end());
+    newConstraint.startTime = time;
+    newConstraint.endTime = time;
+    newConstraint.fulfilled = false;
+    candidate.numRight++;
+
+    const auto idsFromLeft = topology.predecessors(idToRight);
+    if (idsFromLeft.size() > 1) {
+        for (auto idFromLeft : idsFromLeft) {
+            leaves.clear();
+            topology.getLeaves(tree, idFromLeft, time, time, time, time, leaves);
+            newConstraint.leaves.insert(leaves.begin(), leaves.end());
+            candidate.numLeft++;
+            candidate.isValid = true;
         }
-
-        constraintId++;
-
-        if (addConstraint) addConstraint = !isRedundant(newConstraint, constraints);
-
-        if (!addConstraint || newConstraint.leaves.size() < 2) {
-            constraintId--;
-            numLeftRight[constraintId] = {0, 0};
-            continue;
-        };
-
-        constraints.push_back(newConstraint);
-        // Prepare for the next one
-        numLeftRight.emplace_back(0, 0);
     }
+}
+}  // namespace
 
-    // Extract Merges
-    for (const auto& edge : reversedEdgesTime) {
-        addConstraint = false;
-        Constraint newConstraint;
-
-        // Shorthands
-        const size_t idToRight(edge.first);
-
-        newConstraint.level = tree->depthWithReverse(idToRight);
+void extractMergeSplitConstraints(std::shared_ptr<const TemporalTree>& tree,
+                                  std::vector<Constraint>& constraints,
+                                  std::vector<size_t>& numByLevel) {
+    // Flat time edges, depths and leaves
+    const TemporalTreeTopology topology(*tree);
+    const size_t numNodes = topology.numNodes();
+
+    // Splits and direct correspondances first, then merges
+    std::vector<size_t> groupNodes;
+    for (size_t nodeIndex(0); nodeIndex < numNodes; nodeIndex++) {
+        if (!topology.successors(nodeIndex).empty()) groupNodes.push_back(nodeIndex);
+    }
+    const size_t numSplitGroups = groupNodes.size();
+    for (size_t nodeIndex(0); nodeIndex < numNodes; nodeIndex++) {
+        if (!topology.predecessors(nodeIndex).empty()) groupNodes.push_back(nodeIndex);
+    }
 
-        std::set<size_t> leaves;
-        const auto& time = tree->nodes[idToRight].startTime();
-        tree->getLeaves(idToRight, time, time, time, time, leaves);
-        newConstraint.leaves.insert(leaves.begin(), leaves.end());
-        newConstraint.startTime = time;
-        newConstraint.endTime = time;
-        newConstraint.fulfilled = false;
-        numLeftRight[constraintId].second++;
-
-        const std::vector<size_t>& idsFromLeft = edge.second;
-        ivwAssert(!idsFromLeft.empty(), "Time map is empty.");
-        if (idsFromLeft.empty()) continue;
-
-        if (idsFromLeft.size() > 1) {
-            for (auto idFromLeft : idsFromLeft) {
-                leaves.clear();
-                tree->getLeaves(idFromLeft, time, time, time, time, leaves);
-                newConstraint.leaves.insert(leaves.begin(), leaves.end());
-                numLeftRight[constraintId].first++;
-                addConstraint = true;
-            }
+    // Candidates do not depend on each other, collecting their leaves is the expensive part
+    std::vector<Candidate> candidates(groupNodes.size());
+    const int numGroups = int(groupNodes.size());
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int groupId = 0; groupId < numGroups; groupId++) {
+        if (size_t(groupId) < numSplitGroups) {
+            createSplitCandidate(*tree, topology, groupNodes[groupId], candidates[groupId]);
+        } else {
+            createMergeCandidate(*tree, topology, groupNodes[groupId], candidates[groupId]);
         }
+    }
 
-        constraintId++;
-
-        if (addConstraint) addConstraint = !isRedundant(newConstraint, constraints);
-
-        if (!addConstraint || newConstraint.leaves.size() < 2) {
-            constraintId--;
-            numLeftRight[constraintId] = {0, 0};
-            continue;
-        };
-
-        constraints.push_back(newConstraint);
-        // Prepare for the next one
-        numLeftRight.emplace_back(0, 0);
+    // Add in the order of the edges, such that the result does not depend on the threads.
+    // Redundant ones are found by the hash of their leaves.
+    LeavesIndex constraintsByHash;
+    for (size_t constraintId(0); constraintId < constraints.size(); constraintId++) {
+        constraintsByHash[hashLeaves(constraints[constraintId].leaves)].push_back(constraintId);
     }
 
-    size_t numConstraints = constraintId;
+    for (auto& candidate : candidates) {
+        if (!candidate.isValid || candidate.constraint.leaves.size() < 2) continue;
 
-    for (constraintId = 0; constraintId < numConstraints; constraintId++) {
-        size_t level = constraints[numConstraintsAlreadyPresent + constraintId].level;
+        const size_t hash = hashLeaves(candidate.constraint.leaves);
+        if (isRedundant(candidate.constraint, hash, constraints, constraintsByHash)) continue;
+
+        Constraint& newConstraint = candidate.constraint;
+        const size_t level = newConstraint.level;
         if (numByLevel.size() < level + 1) {
             numByLevel.resize(level + 1);
         }
         numByLevel[level]++;
 
-        if (numLeftRight[constraintId].first == 1 && numLeftRight[constraintId].second > 1) {
-            constraints[numConstraintsAlreadyPresent + constraintId].type = ConstraintType::Split;
-        } else if (numLeftRight[constraintId].first > 1 && numLeftRight[constraintId].second == 1) {
-            constraints[numConstraintsAlreadyPresent + constraintId].type = ConstraintType::Merge;
-        } else if (numLeftRight[constraintId].first == 1 &&
-                   numLeftRight[constraintId].second == 1) {
-            constraints[numConstraintsAlreadyPresent + constraintId].type =
-                ConstraintType::Correspondance;
+        if (candidate.numLeft == 1 && candidate.numRight > 1) {
+            newConstraint.type = ConstraintType::Split;
+        } else if (candidate.numLeft > 1 && candidate.numRight == 1) {
+            newConstraint.type = ConstraintType::Merge;
+        } else if (candidate.numLeft == 1 && candidate.numRight == 1) {
+            newConstraint.type = ConstraintType::Correspondance;
         } else {
-            constraints[numConstraintsAlreadyPresent + constraintId].type =
-                ConstraintType::MergeSplit;
+            newConstraint.type = ConstraintType::MergeSplit;
         }
+
+        constraintsByHash[hash].push_back(constraints.size());
+        constraints.push_back(std::move(newConstraint));
     }
 }
 
 void extractHierarchyConstraints(std::shared_ptr<const TemporalTree>& tree,
                                  std::vector<Constraint>& constraints,
                                  std::vector<size_t>& numByLevel) {
+    const TemporalTreeTopology topology(*tree);
+
     for (size_t nodeIndex = 1; nodeIndex < tree->nodes.size(); nodeIndex++) {
         // Leafs by themselves do not impose a constraints
-        if (tree->isLeaf(nodeIndex)) {
+        if (topology.isLeaf(nodeIndex)) {
             continue;
         }
         // Get nodes leaves and times
@@ -286,7 +507,8 @@ void extractHierarchyConstraints(std::shared_ptr<const TemporalTree>& tree,
         uint64_t nodeEndTime = tree->nodes[nodeIndex].endTime();
 
         std::set<size_t> leaves;
-        tree->getLeaves(nodeIndex, nodeStartTime, nodeEndTime, nodeStartTime, nodeEndTime, leaves);
+        topology.getLeaves(*tree, nodeIndex, nodeStartTime, nodeEndTime, nodeStartTime,
+                           nodeEndTime, leaves);
         // No constraints for single leafs
         if (leaves.size() < 2) {
             continue;
@@ -297,7 +519,7 @@ void extractHierarchyConstraints(std::shared_ptr<const TemporalTree>& tree,
         constraint.type = ConstraintType::Hierarchy;
         constraint.startTime = nodeStartTime;
         constraint.endTime = nodeEndTime;
-        constraint.level = tree->depthWithReverse(nodeIndex);
+        constraint.level = topology.depth(nodeIndex);
 
         if (numByLevel.size() < constraint.level + 1) {
             numByLevel.resize(constraint.level + 1);
@@ -328,12 +550,17 @@ bool isRedundant(const Constraint& constraint, const std::vector<Constraint>& co
 }
 
 bool isOverlappingWithConstraint(const TemporalTree::TNode& leaf, const Constraint& constraint) {
-    const uint64_t overlapStart = std::max(constraint.startTime, leaf.startTime());
-    const uint64_t overlapEnd = std::min(constraint.endTime, leaf.endTime());
+    return isOverlappingWithConstraint(leaf.startTime(), leaf.endTime(), constraint);
+}
+
+bool isOverlappingWithConstraint(const uint64_t leafStartTime, const uint64_t leafEndTime,
+                                 const Constraint& constraint) {
+    const uint64_t overlapStart = std::max(constraint.startTime, leafStartTime);
+    const uint64_t overlapEnd = std::min(constraint.endTime, leafEndTime);
     return overlapStart < overlapEnd ||
            // Unless we have a single timestep hierarchy or merge Constraints
            (overlapStart == overlapEnd &&
-            (constraint.startTime == constraint.endTime || leaf.startTime() == leaf.endTime()));
+            (constraint.startTime == constraint.endTime || leafStartTime == leafEndTime));
 }
 
 }  // namespace constraint
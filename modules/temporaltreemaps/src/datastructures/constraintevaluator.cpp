@@ -0,0 +1,389 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 10:12:40
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#include <modules/temporaltreemaps/datastructures/constraintevaluator.h>
+#include <algorithm>
+#include <tuple>
+
+namespace inviwo {
+namespace kth {
+
+namespace constraint {
+
+void IncrementalEvaluator::initialize(const TemporalTree& tree,
+                                      const FlatConstraints& flatConstraints,
+                                      const std::vector<Constraint>& constraints) {
+    ivwAssert(flatConstraints.size() == constraints.size(),
+              "Flat constraints need to be built from the given constraints.");
+
+    pFlatConstraints = &flatConstraints;
+    pConstraints = &constraints;
+
+    const size_t numNodes = flatConstraints.numNodes();
+    const size_t numConstraints = flatConstraints.size();
+    const auto& startTimes = flatConstraints.nodeStartTimes;
+    const auto& endTimes = flatConstraints.nodeEndTimes;
+
+    // Leaves sorted by their start time, with a binary tree holding the latest end time of
+    // each range of them. Only leaves starting before a constraint ends and ending after it
+    // starts can overlap with it, the tree leads to them without going through all leaves.
+    std::vector<size_t> leaves = tree.getLeaves();
+    std::sort(leaves.begin(), leaves.end(),
+              [&](const size_t a, const size_t b) { return startTimes[a] < startTimes[b]; });
+    size_t numSlots(1);
+    while (numSlots < leaves.size()) numSlots *= 2;
+    std::vector<uint64_t> latestEnd(2 * numSlots, 0);
+    for (size_t i(0); i < leaves.size(); i++) {
+        latestEnd[numSlots + i] = endTimes[leaves[i]];
+    }
+    for (size_t slot = numSlots - 1; slot > 0; slot--) {
+        latestEnd[slot] = std::max(latestEnd[2 * slot], latestEnd[2 * slot + 1]);
+    }
+
+    // A leaf matters for a constraint if it is part of it (its position determines the range
+    // the constraint occupies) or if it overlaps in time (it breaks the constraint when it is
+    // placed within that range)
+    auto pByLeaf = std::make_shared<std::vector<std::vector<size_t>>>(numNodes);
+    auto& constraintsByLeaf = *pByLeaf;
+    // Slot in the binary tree, first leaf below it and number of leaves below it
+    std::vector<std::tuple<size_t, size_t, size_t>> slotsToVisit;
+    for (size_t constraintId(0); constraintId < numConstraints; constraintId++) {
+        Constraint window;
+        window.startTime = flatConstraints.startTimes[constraintId];
+        window.endTime = flatConstraints.endTimes[constraintId];
+
+        const size_t numStarted = size_t(
+            std::upper_bound(leaves.begin(), leaves.end(), window.endTime,
+                             [&](const uint64_t time, const size_t leaf) {
+                                 return time < startTimes[leaf];
+                             }) -
+            leaves.begin());
+        slotsToVisit.assign(1, std::make_tuple(size_t(1), size_t(0), numSlots));
+        while (!slotsToVisit.empty()) {
+            size_t slot, first, count;
+            std::tie(slot, first, count) = slotsToVisit.back();
+            slotsToVisit.pop_back();
+            if (first >= numStarted || latestEnd[slot] < window.startTime) continue;
+
+            if (count == 1) {
+                const size_t leaf = leaves[first];
+                if (isOverlappingWithConstraint(startTimes[leaf], endTimes[leaf], window)) {
+                    constraintsByLeaf[leaf].push_back(constraintId);
+                }
+                continue;
+            }
+            slotsToVisit.emplace_back(2 * slot + 1, first + count / 2, count / 2);
+            slotsToVisit.emplace_back(2 * slot, first, count / 2);
+        }
+
+        // Constraint leaves not overlapping with the window themselves
+        std::for_each(flatConstraints.leavesBegin(constraintId),
+                      flatConstraints.leavesEnd(constraintId), [&](const size_t leaf) {
+                          auto& byLeaf = constraintsByLeaf[leaf];
+                          if (byLeaf.empty() || byLeaf.back() != constraintId) {
+                              byLeaf.push_back(constraintId);
+                          }
+                      });
+    }
+    pConstraintsByLeaf = pByLeaf;
+
+    // Hierarchy and merge/split constraints of one level form a stratum
+    stratumByConstraint.resize(numConstraints);
+    size_t numStrata(0);
+    for (size_t constraintId(0); constraintId < numConstraints; constraintId++) {
+        const Constraint& constraint = constraints[constraintId];
+        stratumByConstraint[constraintId] =
+            2 * constraint.level + (constraint.type == ConstraintType::Hierarchy ? 1 : 0);
+        numStrata = std::max(numStrata, stratumByConstraint[constraintId] + 1);
+    }
+    numAffectedByStratum.assign(numStrata, 0);
+    numSampledByStratum.assign(numStrata, 0);
+    sampleStartByStratum.assign(numStrata, 0);
+    deltaByStratum.assign(numStrata, 0.0);
+    affectedConstraints.clear();
+    touchedStrata.clear();
+
+    permutation = treeorder::Permutation();
+    fulfilled.assign(numConstraints, 0);
+    unfulfilled.clear();
+    unfulfilledIndex.assign(numConstraints, 0);
+    numUnfulfilledByLeaf.assign(numNodes, 0);
+    checkedStamp.assign(numConstraints, 0);
+    currentStamp = 0;
+    currentValue = 0.0;
+    lastValue = 0.0;
+    changedPositions.clear();
+    changedConstraints.clear();
+    numChecked = 0;
+}
+
+double IncrementalEvaluator::evaluate(const TemporalTree::TTreeOrder& newOrder,
+                                      const std::vector<double>& newWeights,
+                                      ConstraintsStatistic* statistic) {
+    ivwAssert(isInitialized(), "Evaluator needs to be initialized with a tree.");
+    ivwAssert(newWeights.size() == pConstraints->size(), "Need one weight per constraint.");
+
+    weights = newWeights;
+    permutation.set(newOrder, pFlatConstraints->numNodes());
+    timesByPosition(*pFlatConstraints, permutation, startByPosition, endByPosition);
+
+    if (statistic) {
+        (*statistic).clear();
+    }
+
+    // Mark everything as fulfilled such that only unfulfilled constraints need to be switched
+    const size_t numConstraints = pConstraints->size();
+    std::fill(fulfilled.begin(), fulfilled.end(), 1);
+    std::fill(numUnfulfilledByLeaf.begin(), numUnfulfilledByLeaf.end(), 0);
+    unfulfilled.clear();
+    currentValue = 0.0;
+
+    for (size_t constraintId(0); constraintId < numConstraints; constraintId++) {
+        const bool isFulfilled = check(constraintId);
+        if (!isFulfilled) {
+            setFulfilled(constraintId, false, nullptr);
+        }
+        if (statistic) {
+            (*statistic).update((*pConstraints)[constraintId], isFulfilled);
+        }
+    }
+
+    if (unfulfilled.empty()) currentValue = 0.0;
+
+    lastValue = currentValue;
+    changedPositions.clear();
+    changedConstraints.clear();
+    numChecked = numConstraints;
+    isLastEstimate = false;
+
+    return currentValue;
+}
+
+double IncrementalEvaluator::update(const TemporalTree::TTreeOrder& newOrder,
+                                    ConstraintsStatistic* statistic) {
+    return update(newOrder, 0, newOrder.size(), statistic);
+}
+
+double IncrementalEvaluator::update(const TemporalTree::TTreeOrder& newOrder,
+                                    const size_t firstPosition, const size_t endPosition,
+                                    ConstraintsStatistic* statistic) {
+    ivwAssert(newOrder.size() == permutation.size(),
+              "The order needs to contain the same leaves as the reference order.");
+    ivwAssert(firstPosition <= endPosition && endPosition <= newOrder.size(),
+              "The changed range needs to be within the order.");
+
+    if (!applyOrder(newOrder, firstPosition, endPosition)) return 0.0;
+    isLastEstimate = false;
+    nextStamp();
+
+    // The set of leaves at changed positions is the same before and after,
+    // so looking at the new leaves is enough
+    const auto& constraintsByLeaf = *pConstraintsByLeaf;
+    for (const auto& changed : changedPositions) {
+        const size_t leaf = permutation.nodeAt(changed.first);
+        for (auto constraintId : constraintsByLeaf[leaf]) {
+            if (checkedStamp[constraintId] == currentStamp) continue;
+            checkedStamp[constraintId] = currentStamp;
+            numChecked++;
+
+            const bool isFulfilled = check(constraintId);
+            if (isFulfilled != (fulfilled[constraintId] != 0)) {
+                setFulfilled(constraintId, isFulfilled, statistic);
+                changedConstraints.push_back(constraintId);
+            }
+        }
+    }
+
+    // Avoid accumulating rounding errors in the optimum
+    if (unfulfilled.empty()) currentValue = 0.0;
+
+    return currentValue - lastValue;
+}
+
+double IncrementalEvaluator::estimate(const TemporalTree::TTreeOrder& newOrder,
+                                      const size_t firstPosition, const size_t endPosition,
+                                      const size_t sampleEvery, std::mt19937& generator) {
+    if (sampleEvery <= 1) return update(newOrder, firstPosition, endPosition, nullptr);
+
+    ivwAssert(newOrder.size() == permutation.size(),
+              "The order needs to contain the same leaves as the reference order.");
+
+    if (!applyOrder(newOrder, firstPosition, endPosition)) return 0.0;
+    isLastEstimate = true;
+    nextStamp();
+
+    // Collect the affected constraints and count them per stratum
+    const auto& constraintsByLeaf = *pConstraintsByLeaf;
+    affectedConstraints.clear();
+    touchedStrata.clear();
+    for (const auto& changed : changedPositions) {
+        const size_t leaf = permutation.nodeAt(changed.first);
+        for (auto constraintId : constraintsByLeaf[leaf]) {
+            if (checkedStamp[constraintId] == currentStamp) continue;
+            checkedStamp[constraintId] = currentStamp;
+            affectedConstraints.push_back(constraintId);
+
+            const size_t stratum = stratumByConstraint[constraintId];
+            if (numAffectedByStratum[stratum]++ == 0) touchedStrata.push_back(stratum);
+        }
+    }
+
+    // Random start within each stratum, small strata still get one sample
+    for (auto stratum : touchedStrata) {
+        std::uniform_int_distribution<size_t> chooseStart(
+            0, std::min(sampleEvery, numAffectedByStratum[stratum]) - 1);
+        sampleStartByStratum[stratum] = chooseStart(generator);
+        numAffectedByStratum[stratum] = 0;
+    }
+
+    // Check every n-th constraint per stratum
+    for (auto constraintId : affectedConstraints) {
+        const size_t stratum = stratumByConstraint[constraintId];
+        const size_t index = numAffectedByStratum[stratum]++;
+        if (index < sampleStartByStratum[stratum] ||
+            (index - sampleStartByStratum[stratum]) % sampleEvery != 0) {
+            continue;
+        }
+        numSampledByStratum[stratum]++;
+        numChecked++;
+
+        const bool isFulfilled = check(constraintId);
+        if (isFulfilled != (fulfilled[constraintId] != 0)) {
+            deltaByStratum[stratum] += isFulfilled ? -weights[constraintId] : weights[constraintId];
+            setFulfilled(constraintId, isFulfilled, nullptr);
+            changedConstraints.push_back(constraintId);
+        }
+    }
+
+    // Extrapolate each stratum to all of its affected constraints
+    double deltaValue(0);
+    for (auto stratum : touchedStrata) {
+        deltaValue += deltaByStratum[stratum] * double(numAffectedByStratum[stratum]) /
+                      double(numSampledByStratum[stratum]);
+        numAffectedByStratum[stratum] = 0;
+        numSampledByStratum[stratum] = 0;
+        deltaByStratum[stratum] = 0.0;
+    }
+
+    return deltaValue;
+}
+
+void IncrementalEvaluator::revert(ConstraintsStatistic* statistic) {
+    // The statistic has not seen the changes of an estimate
+    if (isLastEstimate) statistic = nullptr;
+
+    for (auto itChanged = changedPositions.rbegin(); itChanged != changedPositions.rend();
+         itChanged++) {
+        setLeafAt(itChanged->first, itChanged->second);
+    }
+
+    for (auto constraintId : changedConstraints) {
+        setFulfilled(constraintId, fulfilled[constraintId] == 0, statistic);
+    }
+
+    // Restore exactly what we had before
+    currentValue = lastValue;
+
+    changedPositions.clear();
+    changedConstraints.clear();
+}
+
+bool IncrementalEvaluator::applyOrder(const TemporalTree::TTreeOrder& newOrder,
+                                      const size_t firstPosition, const size_t endPosition) {
+    lastValue = currentValue;
+    changedPositions.clear();
+    changedConstraints.clear();
+    numChecked = 0;
+
+    // Bring the reference order up to date and remember what we changed
+    for (size_t position(firstPosition); position < endPosition; position++) {
+        if (permutation.nodeAt(position) != newOrder[position]) {
+            changedPositions.emplace_back(position, permutation.nodeAt(position));
+            setLeafAt(position, newOrder[position]);
+        }
+    }
+
+    return !changedPositions.empty();
+}
+
+void IncrementalEvaluator::nextStamp() {
+    currentStamp++;
+    if (currentStamp == 0) {
+        std::fill(checkedStamp.begin(), checkedStamp.end(), 0);
+        currentStamp = 1;
+    }
+}
+
+bool IncrementalEvaluator::check(const size_t constraintId) const {
+    return isFulFilled(*pFlatConstraints, constraintId, permutation, startByPosition,
+                       endByPosition);
+}
+
+void IncrementalEvaluator::setLeafAt(const size_t position, const size_t leaf) {
+    permutation.setNodeAt(position, leaf);
+    startByPosition[position] = pFlatConstraints->nodeStartTimes[leaf];
+    endByPosition[position] = pFlatConstraints->nodeEndTimes[leaf];
+}
+
+void IncrementalEvaluator::setFulfilled(const size_t constraintId, const bool isFulfilled,
+                                        ConstraintsStatistic* statistic) {
+    const Constraint& constraint = (*pConstraints)[constraintId];
+    const FlatConstraints& flatConstraints = *pFlatConstraints;
+    fulfilled[constraintId] = isFulfilled ? 1 : 0;
+
+    if (isFulfilled) {
+        // Remove from the unfulfilled ones by swapping with the last
+        const size_t index = unfulfilledIndex[constraintId];
+        const size_t lastConstraintId = unfulfilled.back();
+        unfulfilled[index] = lastConstraintId;
+        unfulfilledIndex[lastConstraintId] = index;
+        unfulfilled.pop_back();
+        currentValue -= weights[constraintId];
+    } else {
+        unfulfilledIndex[constraintId] = unfulfilled.size();
+        unfulfilled.push_back(constraintId);
+        currentValue += weights[constraintId];
+    }
+
+    for (auto itLeaf = flatConstraints.leavesBegin(constraintId);
+         itLeaf != flatConstraints.leavesEnd(constraintId); itLeaf++) {
+        const size_t leaf = *itLeaf;
+        if (isFulfilled) {
+            numUnfulfilledByLeaf[leaf]--;
+            if (statistic && numUnfulfilledByLeaf[leaf] == 0) {
+                (*statistic).unhappyLeaves.erase(leaf);
+            }
+        } else {
+            if (statistic && numUnfulfilledByLeaf[leaf] == 0) {
+                (*statistic).unhappyLeaves.insert(leaf);
+            }
+            numUnfulfilledByLeaf[leaf]++;
+        }
+    }
+
+    if (statistic) {
+        auto& levelStatistic = constraint.type == ConstraintType::Hierarchy
+                                   ? (*statistic).fulfilledByLevelHierarchy
+                                   : (*statistic).fulfilledByLevelMergeSplit;
+        if (levelStatistic.size() < constraint.level + 1) {
+            levelStatistic.resize(constraint.level + 1, 0);
+        }
+        if (isFulfilled) {
+            levelStatistic[constraint.level]++;
+        } else {
+            levelStatistic[constraint.level]--;
+        }
+    }
+}
+
+}  // namespace constraint
+
+}  // namespace kth
+}  // namespace inviwo
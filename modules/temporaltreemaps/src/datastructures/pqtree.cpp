@@ -0,0 +1,367 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 16:21:37
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#include <modules/temporaltreemaps/datastructures/pqtree.h>
+
+namespace inviwo {
+namespace kth {
+
+namespace treeorder {
+
+void PQTree::initialize(const TemporalTree::TTreeOrder& leaves, const size_t numTreeNodes) {
+    nodes.clear();
+    labels.clear();
+    numPertinentLeaves.clear();
+    numPendingChildren.clear();
+    isTouched.clear();
+    fullChildren.clear();
+    partialChildren.clear();
+    touched.clear();
+    pertinent.clear();
+
+    leafNodes.assign(numTreeNodes, InvalidNode);
+    leafCount = leaves.size();
+
+    // Every order is allowed: one P-node with all leaves
+    root = addNode(NodeType::P);
+    for (auto leaf : leaves) {
+        const size_t leafNode = addNode(NodeType::Leaf);
+        nodes[leafNode].treeNode = leaf;
+        leafNodes[leaf] = leafNode;
+        appendChild(root, leafNode);
+    }
+}
+
+bool PQTree::reduce(const std::vector<size_t>& leaves) {
+    for (auto leaf : leaves) {
+        if (leaf >= leafNodes.size() || leafNodes[leaf] == InvalidNode) return false;
+    }
+
+    // A single leaf or all leaves are always consecutive
+    if (leaves.size() <= 1 || leaves.size() >= leafCount) return true;
+
+    // The check does not modify the tree, so we can simply stop if it fails
+    if (!labelPertinent(leaves)) {
+        clearLabels();
+        return false;
+    }
+
+    applyTemplates();
+    clearLabels();
+    return true;
+}
+
+void PQTree::frontier(TemporalTree::TTreeOrder& order) const {
+    order.clear();
+    order.reserve(leafCount);
+    if (root == InvalidNode) return;
+
+    std::vector<size_t> stack{root};
+    while (!stack.empty()) {
+        const size_t node = stack.back();
+        stack.pop_back();
+
+        if (nodes[node].type == NodeType::Leaf) {
+            order.push_back(nodes[node].treeNode);
+        } else {
+            const auto& children = nodes[node].children;
+            stack.insert(stack.end(), children.rbegin(), children.rend());
+        }
+    }
+}
+
+bool PQTree::labelPertinent(const std::vector<size_t>& leaves) {
+    auto touch = [&](const size_t node) {
+        if (!isTouched[node]) {
+            isTouched[node] = 1;
+            touched.push_back(node);
+        }
+    };
+
+    // Walk up from each leaf until we reach a node that we have seen before. On the way, count
+    // for each node how many of its children need to be labeled before the node itself.
+    std::vector<size_t> ready;
+    ready.reserve(leaves.size());
+    for (auto leaf : leaves) {
+        size_t node = leafNodes[leaf];
+        touch(node);
+        ready.push_back(node);
+        while (node != root) {
+            const size_t parent = nodes[node].parent;
+            const bool seenBefore = isTouched[parent] != 0;
+            touch(parent);
+            numPendingChildren[parent]++;
+            if (seenBefore) break;
+            node = parent;
+        }
+    }
+
+    // Label bottom-up until we reach the node containing all leaves
+    for (size_t i(0); i < ready.size(); i++) {
+        const size_t node = ready[i];
+        const Node& current = nodes[node];
+
+        if (current.type == NodeType::Leaf) {
+            labels[node] = Label::Full;
+            numPertinentLeaves[node] = 1;
+        }
+
+        const bool isPertinentRoot = numPertinentLeaves[node] == leaves.size();
+
+        if (current.type != NodeType::Leaf) {
+            const size_t numFull = fullChildren[node].size();
+            const size_t numPartial = partialChildren[node].size();
+
+            if (numFull == current.children.size()) {
+                labels[node] = Label::Full;
+            } else if (current.type == NodeType::P) {
+                // The partial children are put at the ends of the full ones
+                if (numPartial > (isPertinentRoot ? 2u : 1u)) return false;
+                labels[node] = Label::Partial;
+            } else {
+                bool reversed(false);
+                if (isPertinentRoot ? !isRootQ(node) : !isPartialQ(node, reversed)) return false;
+                labels[node] = Label::Partial;
+            }
+        }
+
+        pertinent.push_back(node);
+        if (isPertinentRoot) return true;
+
+        const size_t parent = current.parent;
+        numPertinentLeaves[parent] += numPertinentLeaves[node];
+        if (labels[node] == Label::Full) {
+            fullChildren[parent].push_back(node);
+        } else {
+            partialChildren[parent].push_back(node);
+        }
+        if (--numPendingChildren[parent] == 0) {
+            ready.push_back(parent);
+        }
+    }
+
+    // Not reached, the tree root contains all leaves
+    return false;
+}
+
+void PQTree::applyTemplates() {
+    const size_t pertinentRoot = pertinent.back();
+
+    for (auto node : pertinent) {
+        if (nodes[node].type == NodeType::Leaf) continue;
+        if (labels[node] == Label::Full) continue;
+
+        const bool isPertinentRoot = node == pertinentRoot;
+
+        if (nodes[node].type == NodeType::P) {
+            const std::vector<size_t> full = fullChildren[node];
+            const std::vector<size_t> partial = partialChildren[node];
+            for (auto child : full) removeFromP(node, child);
+            for (auto child : partial) removeFromP(node, child);
+            // Only the empty children are left
+
+            if (!isPertinentRoot) {
+                std::vector<size_t> empty;
+                std::swap(empty, nodes[node].children);
+
+                // The node becomes a partial Q-node: empty children, partial one, full ones
+                std::vector<size_t> sequence;
+                if (!empty.empty()) sequence.push_back(group(empty));
+                if (!partial.empty()) spliceChild(sequence, partial[0], false);
+                if (!full.empty()) sequence.push_back(group(full));
+
+                nodes[node].type = NodeType::Q;
+                setChildren(node, std::move(sequence));
+            } else if (partial.empty()) {
+                // The full children stay together
+                appendChild(node, group(full));
+            } else {
+                // The full children go between the partial ones
+                const size_t partialNode = partial[0];
+                std::vector<size_t> sequence;
+                spliceChild(sequence, partialNode, false);
+                if (!full.empty()) sequence.push_back(group(full));
+                if (partial.size() > 1) spliceChild(sequence, partial[1], true);
+                setChildren(partialNode, std::move(sequence));
+                nodes[partialNode].type = NodeType::Q;
+
+                if (nodes[node].children.empty()) {
+                    replaceNode(node, partialNode);
+                } else {
+                    appendChild(node, partialNode);
+                }
+            }
+        } else {
+            std::vector<size_t> children = nodes[node].children;
+            const size_t numChildren = children.size();
+
+            if (!isPertinentRoot) {
+                // Empty children first, full ones last
+                bool reversed(false);
+                isPartialQ(node, reversed);
+                if (reversed) std::reverse(children.begin(), children.end());
+                std::vector<size_t> sequence;
+                for (auto child : children) {
+                    if (labelOf(child) == Label::Partial) {
+                        spliceChild(sequence, child, false);
+                    } else {
+                        sequence.push_back(child);
+                    }
+                }
+                setChildren(node, std::move(sequence));
+            } else {
+                // Partial children at both ends of the full ones, full sides inwards
+                size_t first(0);
+                while (labelOf(children[first]) == Label::Empty) first++;
+                size_t last(numChildren - 1);
+                while (labelOf(children[last]) == Label::Empty) last--;
+
+                std::vector<size_t> sequence;
+                for (size_t i(0); i < numChildren; i++) {
+                    const size_t child = children[i];
+                    if (labelOf(child) == Label::Partial) {
+                        spliceChild(sequence, child, i == last && i != first);
+                    } else {
+                        sequence.push_back(child);
+                    }
+                }
+                setChildren(node, std::move(sequence));
+            }
+        }
+    }
+}
+
+void PQTree::clearLabels() {
+    for (auto node : touched) {
+        labels[node] = Label::Empty;
+        numPertinentLeaves[node] = 0;
+        numPendingChildren[node] = 0;
+        isTouched[node] = 0;
+        fullChildren[node].clear();
+        partialChildren[node].clear();
+    }
+    touched.clear();
+    pertinent.clear();
+}
+
+size_t PQTree::addNode(const NodeType type) {
+    nodes.emplace_back();
+    nodes.back().type = type;
+
+    labels.push_back(Label::Empty);
+    numPertinentLeaves.push_back(0);
+    numPendingChildren.push_back(0);
+    isTouched.push_back(0);
+    fullChildren.emplace_back();
+    partialChildren.emplace_back();
+
+    return nodes.size() - 1;
+}
+
+void PQTree::setChildren(const size_t node, std::vector<size_t>&& children) {
+    nodes[node].children = std::move(children);
+    const auto& newChildren = nodes[node].children;
+    for (size_t i(0); i < newChildren.size(); i++) {
+        nodes[newChildren[i]].parent = node;
+        nodes[newChildren[i]].indexInParent = i;
+    }
+}
+
+void PQTree::removeFromP(const size_t node, const size_t child) {
+    auto& children = nodes[node].children;
+    const size_t index = nodes[child].indexInParent;
+    const size_t lastChild = children.back();
+    children[index] = lastChild;
+    nodes[lastChild].indexInParent = index;
+    children.pop_back();
+    nodes[child].parent = InvalidNode;
+}
+
+void PQTree::appendChild(const size_t node, const size_t child) {
+    nodes[child].parent = node;
+    nodes[child].indexInParent = nodes[node].children.size();
+    nodes[node].children.push_back(child);
+}
+
+void PQTree::replaceNode(const size_t oldNode, const size_t newNode) {
+    const size_t parent = nodes[oldNode].parent;
+    nodes[newNode].parent = parent;
+    nodes[newNode].indexInParent = nodes[oldNode].indexInParent;
+
+    if (parent == InvalidNode) {
+        root = newNode;
+    } else {
+        nodes[parent].children[nodes[oldNode].indexInParent] = newNode;
+    }
+
+    nodes[oldNode].parent = InvalidNode;
+    nodes[oldNode].children.clear();
+}
+
+size_t PQTree::group(const std::vector<size_t>& members) {
+    if (members.size() == 1) return members[0];
+
+    const size_t node = addNode(NodeType::P);
+    setChildren(node, std::vector<size_t>(members));
+    return node;
+}
+
+bool PQTree::isPartialQ(const size_t node, bool& reversed) const {
+    const auto& children = nodes[node].children;
+    const size_t numChildren = children.size();
+
+    auto matches = [&](const bool backwards) {
+        auto labelAt = [&](const size_t i) {
+            return labelOf(backwards ? children[numChildren - 1 - i] : children[i]);
+        };
+        size_t i(0);
+        while (i < numChildren && labelAt(i) == Label::Empty) i++;
+        if (i < numChildren && labelAt(i) == Label::Partial) i++;
+        while (i < numChildren && labelAt(i) == Label::Full) i++;
+        return i == numChildren;
+    };
+
+    reversed = false;
+    if (matches(false)) return true;
+    reversed = true;
+    return matches(true);
+}
+
+bool PQTree::isRootQ(const size_t node) const {
+    const auto& children = nodes[node].children;
+
+    size_t first(0);
+    while (first < children.size() && labelOf(children[first]) == Label::Empty) first++;
+    size_t last(children.size() - 1);
+    while (last > first && labelOf(children[last]) == Label::Empty) last--;
+
+    for (size_t i(first + 1); i < last; i++) {
+        if (labelOf(children[i]) != Label::Full) return false;
+    }
+
+    return true;
+}
+
+void PQTree::spliceChild(std::vector<size_t>& sequence, const size_t child, const bool reversed) {
+    // Partial children are Q-nodes with their empty children first
+    const auto& grandChildren = nodes[child].children;
+    if (reversed) {
+        sequence.insert(sequence.end(), grandChildren.rbegin(), grandChildren.rend());
+    } else {
+        sequence.insert(sequence.end(), grandChildren.begin(), grandChildren.end());
+    }
+    nodes[child].children.clear();
+    nodes[child].parent = InvalidNode;
+}
+
+}  // namespace treeorder
+
+}  // namespace kth
+}  // namespace inviwo
@@ -9,115 +9,160 @@
  */
 
 #include <modules/temporaltreemaps/datastructures/tree.h>
+#include <modules/temporaltreemaps/datastructures/treeintervalindex.h>
+#include <modules/temporaltreemaps/datastructures/treetopology.h>
+#include <modules/temporaltreemaps/datastructures/treevaluecolumns.h>
 #include <inviwo/core/util/exception.h>
+#include <atomic>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace inviwo {
 namespace kth {
 
+namespace {
+/// Last version given to any tree
+std::atomic<uint64_t> lastTreeVersion(0);
+
+/// Union-find over the indices [0, size) with path halving, no recursion
+class DisjointSets {
+public:
+    explicit DisjointSets(const size_t size) : representative(size) {
+        std::iota(representative.begin(), representative.end(), 0);
+    }
+
+    size_t find(size_t index) {
+        while (representative[index] != index) {
+            representative[index] = representative[representative[index]];
+            index = representative[index];
+        }
+        return index;
+    }
+
+    void unite(const size_t indexA, const size_t indexB) {
+        const size_t representativeA = find(indexA);
+        const size_t representativeB = find(indexB);
+        // The smaller index represents the joined set
+        if (representativeA < representativeB) {
+            representative[representativeB] = representativeA;
+        } else {
+            representative[representativeA] = representativeB;
+        }
+    }
+
+private:
+    std::vector<size_t> representative;
+};
+}  // namespace
+
+void TemporalTree::touch() { version = ++lastTreeVersion; }
+
 /**** Utility functions for accessing parts of the tree ****/
 
-/*
-    TemporalTree TemporalTree::getHierarchyAt(uint64_t time, bool accumulate = false, uint64_t
-   deltaTime = 1) const
-    {
-        TemporalTree snapshot = TemporalTree();
+TemporalTree TemporalTree::getHierarchyAt(const uint64_t time, const bool accumulate,
+                                          const uint64_t deltaTime) const {
+    return getHierarchyAt(TemporalTreeIntervalIndex(*this), time, accumulate, deltaTime);
+}
 
-        // Start with the root node
-        size_t currentRoot = std::numeric_limits<size_t>::max();
-        bool foundRoot = false;
-        for (auto root : this->rootIndices)
-        {
-            const TemporalTree::TNode& currentRootNode = nodes[currentRoot];
-            if (time >= currentRootNode.startEvent.time  && time < currentRootNode.endEvent.time)
-            {
-                // The tree would not be consistent if there are multiple roots for this time,
-                // we can stop at the first found one
-                currentRoot = root;
-                foundRoot = true;
+TemporalTree TemporalTree::getHierarchyAt(const TemporalTreeIntervalIndex& index,
+                                          const uint64_t time, const bool accumulate,
+                                          const uint64_t deltaTime) const {
+    TemporalTree snapshot;
+
+    // No root node at the specified time, return the empty tree
+    // ACHTUNG: We assume here that the root has the index 0!
+    if (nodes.empty() || nodes[0].values.empty() || time < nodes[0].startTime() ||
+        time > nodes[0].endTime()) {
+        return snapshot;
+    }
+
+    std::vector<size_t> aliveNodes;
+    index.getNodesAt(time, aliveNodes);
+
+    // At a merge or split, the nodes after the event take over at the time of the event
+    std::unordered_set<size_t> isAlive;
+    for (auto nodeIndex : aliveNodes) {
+        const TNode& node = nodes[nodeIndex];
+        if (time == node.endTime() && node.startTime() != node.endTime() &&
+            !getTemporalSuccessors(nodeIndex).empty()) {
+            continue;
+        }
+        isAlive.insert(nodeIndex);
+    }
+
+    // Maps node indices of the entire tree to the snapshot
+    std::unordered_map<size_t, size_t> indexMap;
+
+    auto addSnapshotNode = [&](const size_t nodeIndex) {
+        const TNode& node = nodes[nodeIndex];
+        const float value = node.getValueAt(time);
+        const size_t snapshotIndex =
+            snapshot.addNode(node.name, {{time, value}, {time + deltaTime, value}});
+        snapshot.nodes[snapshotIndex].color = node.color;
+        indexMap.emplace(nodeIndex, snapshotIndex);
+        return snapshotIndex;
+    };
+
+    // A node is connected if one of its parents alive at the time is connected,
+    // nodes not connected to the root are left out
+    std::unordered_map<size_t, bool> isConnected{{0, true}};
+    std::function<bool(size_t)> checkConnected = [&](const size_t nodeIndex) -> bool {
+        auto itConnected = isConnected.find(nodeIndex);
+        if (itConnected != isConnected.end()) return itConnected->second;
+
+        bool connected = false;
+        for (auto parentIndex : index.getHierarchicalParents(nodeIndex)) {
+            if (isAlive.find(parentIndex) != isAlive.end() && checkConnected(parentIndex)) {
+                connected = true;
                 break;
             }
         }
+        isConnected.emplace(nodeIndex, connected);
+        return connected;
+    };
 
-        // No root node was active in the specified time return the empty tree
-        if (foundRoot == false)
-        {
-            return snapshot;
+    // The root goes first, then all connected nodes from the query
+    addSnapshotNode(0);
+    for (auto nodeIndex : aliveNodes) {
+        if (nodeIndex != 0 && isAlive.find(nodeIndex) != isAlive.end() &&
+            checkConnected(nodeIndex)) {
+            addSnapshotNode(nodeIndex);
         }
+    }
 
-        // Maps node indices of the entire tree to the snapshot
-        std::map<size_t, size_t> indexMap;
-
-        // Nodes and Edges for the snapshot
-        std::vector<TNode> snapshotNodes;
-        TAdjacency snapshotEdges;
+    for (auto nodeIndex : aliveNodes) {
+        auto itNode = indexMap.find(nodeIndex);
+        if (itNode == indexMap.end()) continue;
 
-        auto copyRelevantNodeAttributes = [&](const TemporalTree::TNode& node) ->
-   TemporalTree::TNode
-        {
-            TemporalTree::TNode copy = TemporalTree::TNode();
-            // Copy name
-            copy.name = node.name;
-            // Start and end events have no meaning for a snapshot
-            // thus set to creating and annihilation for given time
-            copy.startEvent = { time, TDelimitingEventType::Creation };
-            copy.endEvent = { time + deltaTime, TDelimitingEventType::Annihilation };
-            // Get value for the current time
-            copy.values = { { time, node.getValueAt(time) } };
-            return copy;
-        };
-
-        // Set root
-        snapshotNodes.push_back(copyRelevantNodeAttributes(nodes[currentRoot]));
-        indexMap.insert(std::make_pair(currentRoot, size_t(0)));
-        snapshot.rootIndices = { 0 };
-
-        // Iterate over all edges and extract the ones that are active at the current time
-        for (auto it = this->edgesHierarchy.begin();
-            it != this->edgesHierarchy.end(); it++)
-        {
-            for (auto edge : it->second)
-            {
-                // Edge is active at the current time
-                size_t edgeFrom = it->first;
-                if (time >= edge.startTime && time < edge.endTime)
-                {
-                    std::map<size_t, size_t>::iterator indexPairFrom = indexMap.find(edgeFrom);
-                    std::map<size_t, size_t>::iterator indexPairTo = indexMap.find(edge.to);
-                    // From node of the edge has not been added to the snapshot
-                    if (indexPairFrom == indexMap.end())
-                    {
-                        snapshotNodes.push_back(copyRelevantNodeAttributes(nodes[edgeFrom]));
-                        snapshotNodes[snapshotNodes.size() - 1].index = snapshotNodes.size() - 1;
-                        indexPairFrom = indexMap.insert(std::make_pair(edgeFrom,
-   snapshotNodes.size() - 1)).first;
-                    }
-                    // To node has not been added to the snapshot
-                    if (indexPairTo == indexMap.end())
-                    {
-                        snapshotNodes.push_back(copyRelevantNodeAttributes(nodes[edge.to]));
-                        snapshotNodes[snapshotNodes.size() - 1].index = snapshotNodes.size() - 1;
-                        indexPairTo = indexMap.insert(std::make_pair(edge.to, snapshotNodes.size() -
-   1)).first;
-                    }
-                    // Add edge with the snapshot indices
-                    snapshot.addHierarchyEdge(indexPairFrom->second, indexPairTo->second, time, time
-   + deltaTime); } // Active edge } // Outgoing edges for one node
+        for (auto parentIndex : index.getHierarchicalParents(nodeIndex)) {
+            auto itParent = indexMap.find(parentIndex);
+            if (itParent != indexMap.end()) {
+                snapshot.addHierarchyEdge(itParent->second, itNode->second);
+            }
         }
+    }
 
-        // Fill the snapshot with the collected data
-        // No temporal edges because the tree is just a single snapshot
-        snapshot.nodes = snapshotNodes;
-        snapshot.edgesHierarchy = snapshotEdges;
+    if (accumulate) {
+        snapshot.computeAccumulated();
+    }
 
-        // TODO: Check if accumulation has already been done and just use those values
-        if (accumulate)
-        {
-            snapshot.computeAccumulated();
+    // Keep the order of the leaves, nodes that have become leaves at that time go last
+    std::vector<bool> isOrdered(snapshot.nodes.size(), false);
+    for (auto leaf : order) {
+        auto itLeaf = indexMap.find(leaf);
+        if (itLeaf != indexMap.end() && snapshot.isLeaf(itLeaf->second) &&
+            !isOrdered[itLeaf->second]) {
+            snapshot.order.push_back(itLeaf->second);
+            isOrdered[itLeaf->second] = true;
         }
-
-        return snapshot;
     }
-*/
+    for (auto leaf : snapshot.getLeaves()) {
+        if (!isOrdered[leaf]) snapshot.order.push_back(leaf);
+    }
+
+    return snapshot;
+}
 
 std::vector<size_t> TemporalTree::getLevel(const size_t level,
                                            const std::vector<size_t>& prevLevelIndices,
@@ -199,189 +244,226 @@ void TemporalTree::leafDepthStatistic(const size_t nodeIndex, std::vector<bool>&
 }
 
 void TemporalTree::splitTemporaryLeaves() {
-    bool madeSplit = false;
-
-    std::set<uint64_t> times;
-    getTimes(0, times);
-    /// Go to every single node and check if it temporaly becomes a leaf
+    const auto sortedTimes = getSortedTimes();
+    const std::vector<uint64_t>& times = *sortedTimes;
+    auto timeIndex = [&](const uint64_t time) {
+        return size_t(std::lower_bound(times.begin(), times.end(), time) - times.begin());
+    };
 
-    size_t numNodes = nodes.size();
+    if (!edgesHierarchy.empty() && reverseEdgesHierachy.empty()) {
+        reverseEdgesHierachy = getReverseEdges(edgesHierarchy);
+    }
 
+    // A node is a leaf wherever none of its children exists. All nodes are split in the same
+    // sweep, so a child that is a leaf at some time will have a leaf there afterwards. Coverage
+    // is counted per time of the node, a child only touching its start or end does not count.
+    const size_t numNodes = nodes.size();
+    const TAdjacency& hierarchy = static_cast<const SharedMap<TAdjacency>&>(edgesHierarchy);
+    std::vector<std::vector<TNode>> segmentNodes(numNodes);
+    std::vector<int> coverage;
     for (size_t nodeIndex(1); nodeIndex < numNodes; nodeIndex++) {
-        TNode& node = nodes[nodeIndex];
+        const TNode& node = nodes[nodeIndex];
+        if (isLeaf(nodeIndex) || node.values.empty()) continue;
+
+        const size_t startIdx = timeIndex(node.startTime());
+        const size_t endIdx = timeIndex(node.endTime());
+        const bool isSingleTime = startIdx == endIdx;
+
+        coverage.assign(endIdx - startIdx + 2, 0);
+        for (auto child : hierarchy.at(nodeIndex)) {
+            const TNode& childNode = nodes[child];
+            if (childNode.values.empty()) continue;
+            if (!isSingleTime && (childNode.endTime() == node.startTime() ||
+                                  childNode.startTime() == node.endTime())) {
+                continue;
+            }
 
-        // Node is always a leaf, nothing to be done
-        if (isLeaf(nodeIndex)) {
-            continue;
+            const size_t startIdxChild = std::max(startIdx, timeIndex(childNode.startTime()));
+            const size_t endIdxChild = std::min(endIdx, timeIndex(childNode.endTime()));
+            if (startIdxChild > endIdxChild) continue;
+            coverage[startIdxChild - startIdx]++;
+            coverage[endIdxChild - startIdx + 1]--;
         }
 
-        std::set<size_t> leafIndices;
-        getLeaves(nodeIndex, node.startTime(), node.endTime(), node.startTime(), node.endTime(),
-                  leafIndices);
-
-        // Times at which this node has leaves
-        std::set<uint64_t> hasLeaves;
+        bool hasGap(false);
+        for (size_t i(0); i < coverage.size() - 1; i++) {
+            if (i > 0) coverage[i] += coverage[i - 1];
+            hasGap |= coverage[i] == 0;
+        }
+        if (!hasGap) continue;
+
+        LogInfo("Node " << nodeIndex << " temporarily becomes a leaf.");
+
+        // Expanded version of the values for this node (left neighbor interpolation)
+        std::vector<float> nodeValues(endIdx - startIdx + 1);
+        auto itValue = node.values.begin();
+        float currentValue = itValue->second;
+        for (size_t timeIdx = startIdx; timeIdx <= endIdx; timeIdx++) {
+            if (itValue != node.values.end() && itValue->first == times[timeIdx]) {
+                currentValue = itValue->second;
+                itValue++;
+            }
+            nodeValues[timeIdx - startIdx] = currentValue;
+        }
 
-        for (auto leafIndex : leafIndices) {
-            auto itStartTimeChild =
-                times.find(std::max(node.startTime(), nodes[leafIndex].startTime()));
-            const auto itOneAfterEndTimeChild =
-                std::next(times.find(std::min(node.endTime(), nodes[leafIndex].endTime())));
-            for (; itStartTimeChild != itOneAfterEndTimeChild; itStartTimeChild++) {
-                hasLeaves.insert(*itStartTimeChild);
+        // Split at all the points where this node becomes a leaf or stops being one,
+        // consecutive segments share the time at which they change
+        std::vector<std::pair<size_t, size_t>> segments;
+        size_t segmentStartIdx = startIdx;
+        bool isCovered = coverage[0] != 0;
+        for (size_t timeIdx = startIdx + 1; timeIdx <= endIdx; timeIdx++) {
+            const bool isCoveredNow = coverage[timeIdx - startIdx] != 0;
+            if (isCoveredNow == isCovered) continue;
+
+            // A new leaf begins with the previous value, a new inner node with this one
+            const size_t segmentEndIdx = isCovered ? timeIdx - 1 : timeIdx;
+            segments.emplace_back(segmentStartIdx, segmentEndIdx);
+            segmentStartIdx = segmentEndIdx;
+            isCovered = isCoveredNow;
+        }
+        segments.emplace_back(segmentStartIdx, endIdx);
+
+        std::vector<TNode>& newNodes = segmentNodes[nodeIndex];
+        for (const auto& segment : segments) {
+            TValueMap segmentValues;
+            for (size_t timeIdx = segment.first; timeIdx <= segment.second; timeIdx++) {
+                segmentValues.emplace_hint(segmentValues.end(), times[timeIdx],
+                                           nodeValues[timeIdx - startIdx]);
             }
+            const std::string name =
+                newNodes.empty() ? node.name : node.name + "_" + std::to_string(newNodes.size());
+            newNodes.emplace_back(name, segmentValues);
         }
+    }
 
-        auto itStartTimeNode = times.find(node.startTime());
-        const auto itEndTimeNode = std::next(times.find(node.endTime()));
-
-        // Are there times at which this node is a leaf
-        if (std::distance(itStartTimeNode, itEndTimeNode) != int(hasLeaves.size())) {
-            LogInfo("Node " << nodeIndex << " temporarily becomes a leaf.");
-            // Split at all the points where this node becomes a leaf
-            std::vector<TNode> newNodes;
-            // Get expanded version of the values for this node
-            TValueMap nodeValues = node.values;
-            TNode::fillWithLeftNeighborInterpolation(times, nodeValues);
-
-            TNode& lastNode = node;
-            lastNode.values.clear();
-
-            int stateBefore = 0;  // 0:First Node, 1: Non-leaf, 2:Leaf
-
-            for (auto it = itStartTimeNode; it != itEndTimeNode; it++) {
-                // The node is leaf now, but was not a leaf before
-                // or the node it not a leaf now, but was one before
-                const auto itIsLeaf = hasLeaves.find(*it);
-
-                // Same state as before or very beginning
-                if (stateBefore == 0 || (itIsLeaf != hasLeaves.end() && stateBefore == 1) ||
-                    (itIsLeaf == hasLeaves.end() && stateBefore == 2)) {
-                    // Just extend the node
-                    lastNode.values.emplace(*it, nodeValues[*it]);
-                    // Was not a leaf before, now is a leaf
-                } else if (itIsLeaf == hasLeaves.end() && stateBefore == 1) {
-                    // We need to start a new node (a leaf) and also give it this value and the
-                    // previous one Previous one will always exists, there cannot be a one value
-                    // leaf that later becomes a non-leaf or vice versa (because when would it?)
-                    newNodes.push_back(lastNode);
-                    lastNode = TNode(node.name + "_" + std::to_string(newNodes.size()));
-                    lastNode.values.emplace(*std::prev(it), nodeValues[*std::prev(it)]);
-                    lastNode.values.emplace(*it, nodeValues[*it]);
-                    // newState == 2
-                    // Was a leaf before, now is not a leaf
-                } else  // if (itIsLeaf != hasLeaves.end() && stateBefore == 2))
-                {
-                    // Finish the old node
-                    lastNode.values.emplace(*it, nodeValues[*it]);
-                    newNodes.push_back(lastNode);
-                    // Start a new one with this value
-                    lastNode = TNode(node.name + "_" + std::to_string(newNodes.size()));
-                    lastNode.values.emplace(*it, nodeValues[*it]);
-                    // newState == 1
-                }
-                // Update the state for the next iteration
-                stateBefore = itIsLeaf == hasLeaves.end() ? 2 : 1;
+    // The first segment replaces the node, the others are added to the tree.
+    // A node with just a single segment only gets its values expanded.
+    std::vector<std::vector<size_t>> segmentIndices(numNodes);
+    bool madeChange(false);
+    bool madeSplit(false);
+    for (size_t nodeIndex(1); nodeIndex < numNodes; nodeIndex++) {
+        std::vector<TNode>& newNodes = segmentNodes[nodeIndex];
+        if (newNodes.empty()) continue;
+
+        madeChange = true;
+        nodes[nodeIndex] = std::move(newNodes[0]);
+        if (newNodes.size() < 2) continue;
+
+        madeSplit = true;
+        std::vector<size_t>& newIndices = segmentIndices[nodeIndex];
+        newIndices.push_back(nodeIndex);
+        for (size_t index = 1; index < newNodes.size(); index++) {
+            newIndices.push_back(nodes.size());
+            nodes.push_back(std::move(newNodes[index]));
+        }
+
+        // Update temporal edges: Everything that points to the node still points to the
+        // first segment, the last segment gets the successors of the node
+        auto itSuccessors = edgesTime.find(nodeIndex);
+        if (itSuccessors != edgesTime.end()) {
+            std::vector<size_t> successors = std::move(itSuccessors->second);
+            edgesTime.insert_or_assign(newIndices.back(), std::move(successors));
+        }
+        // Connect the new nodes with each other
+        for (size_t index = 0; index < newIndices.size() - 1; index++) {
+            edgesTime.insert_or_assign(newIndices[index],
+                                       std::vector<size_t>{newIndices[index + 1]});
+        }
+    }
+    if (!madeSplit) {
+        if (madeChange) touch();
+        return;
+    }
+
+    auto segmentsOf = [&](const size_t nodeIndex) {
+        return segmentIndices[nodeIndex].empty() ? std::vector<size_t>{nodeIndex}
+                                                 : segmentIndices[nodeIndex];
+    };
+
+    // Update hierarchy edges of all parents of split nodes and all split parents in one batch.
+    // A child segment is connected to all parent segments it overlaps with. If the overlap is
+    // a single time, one of them needs to be a single timestep node and only the first such
+    // parent segment is used.
+    const TAdjacency oldEdgesHierarchy = edgesHierarchy.get();
+    std::set<size_t> changedReverse;
+    for (const auto& parentChildren : oldEdgesHierarchy) {
+        const size_t parent = parentChildren.first;
+        const bool isParentSplit = !segmentIndices[parent].empty();
+        bool hasSplitChild(false);
+        for (auto child : parentChildren.second) {
+            hasSplitChild |= !segmentIndices[child].empty();
+        }
+        if (!isParentSplit && !hasSplitChild) continue;
+
+        const std::vector<size_t> parentSegments = segmentsOf(parent);
+        std::map<size_t, std::vector<size_t>> newChildren;
+        for (auto child : parentChildren.second) {
+            // Remove the old reverse edge
+            auto itReverse = reverseEdgesHierachy.find(child);
+            if (itReverse != reverseEdgesHierachy.end()) {
+                auto& childParents = itReverse->second;
+                childParents.erase(std::remove(childParents.begin(), childParents.end(), parent),
+                                   childParents.end());
+                changedReverse.insert(child);
             }
-            // Add the final node
-            newNodes.push_back(lastNode);
-
-            // The first node replaces the old node
-            nodes[nodeIndex] = newNodes[0];
-
-            // If we have just a single node, this node will have to be
-            // processed again in a later iteration, but all its connections are still valid
-
-            if (newNodes.size() >= 2) {
-                madeSplit = true;
-                // Add the new nodes to the tree
-                std::vector<size_t> newIndices(newNodes.size());
-                newIndices[0] = nodeIndex;
-                for (size_t index = 1; index < newNodes.size(); index++) {
-                    newIndices[index] = nodes.size();
-                    nodes.push_back(newNodes[index]);
-                }
 
-                // Update temporal Edges:
-                // Everything that points to the node, will now point to the first of the new nodes
-                // (Fine) Everything that the node pointed to, the last new node needs to point to
-                auto itSuccessors = edgesTime.find(nodeIndex);
-                if (itSuccessors != edgesTime.end()) {
-                    std::vector<size_t>& sucessors = itSuccessors->second;
-                    edgesTime.emplace_hint(edgesTime.end(), newIndices.back(), sucessors);
-                }
-                // Connect the new nodes with each other
-                for (size_t index = 0; index < newNodes.size() - 1; index++) {
-                    std::vector<size_t> sucessor = {newIndices[index + 1]};
-                    edgesTime.insert_or_assign(newIndices[index], sucessor);
-                }
+            // Neither of them has been split, keep the edge
+            if (!isParentSplit && segmentIndices[child].empty()) {
+                newChildren[parent].push_back(child);
+                continue;
+            }
 
-                // Update hierarchy edges
-                // For parents: Delete the old value and find overlaps with new nodes
-                std::vector<size_t> parents = getHierarchicalParentsWithReverse(nodeIndex);
-                for (auto parent : parents) {
-                    // Parents were found through hierarchy edges, so we can safely assume them to
-                    // be there
-                    auto& itAllChildren = edgesHierarchy[parent];
-                    auto itChild = std::find(itAllChildren.begin(), itAllChildren.end(), nodeIndex);
-                    itAllChildren.erase(itChild);
-
-                    const uint64_t parentStartTime = nodes[parent].startTime();
-                    const uint64_t parentEndTime = nodes[parent].endTime();
-
-                    // Connect to all children that overlap
-                    for (size_t index = 0; index < newNodes.size(); index++) {
-                        const uint64_t overlapStart =
-                            std::max(parentStartTime, newNodes[index].startTime());
-                        const uint64_t overlapEnd =
-                            std::min(parentEndTime, newNodes[index].endTime());
-                        if (overlapStart < overlapEnd ||
-                            // newNodes[index] is just a single timestep node
-                            (overlapStart == overlapEnd &&
-                             (newNodes[index].startTime() == newNodes[index].endTime() ||
-                              parentStartTime == parentEndTime))) {
-                            itAllChildren.push_back(newIndices[index]);
-                        }
-                    }
-                }
-                // For children: Essentially the same
-                auto itChildren = edgesHierarchy.find(nodeIndex);
-                // Copy the children (we are about to delete the array)
-                auto children = itChildren->second;
-                edgesHierarchy.erase(itChildren);
-                for (auto child : children) {
-                    const uint64_t childStartTime = nodes[child].startTime();
-                    const uint64_t childEndTime = nodes[child].endTime();
-
-                    for (size_t index = 0; index < newNodes.size(); index++) {
-                        const uint64_t overlapStart =
-                            std::max(childStartTime, newNodes[index].startTime());
-                        const uint64_t overlapEnd =
-                            std::min(childEndTime, newNodes[index].endTime());
-                        // Connect if there is overlap
-                        if (overlapStart < overlapEnd) {
-                            addHierarchyEdge(newIndices[index], child);
-                        }
-                        // For single time value Children, there will only be a single edge
-                        // connection (the first )
-                        else if (overlapStart == overlapEnd &&
-                                 (childStartTime == childEndTime ||
-                                  newNodes[index].startTime() == newNodes[index].endTime())) {
-                            addHierarchyEdge(newIndices[index], child);
-                            break;
-                        }
+            for (auto childSegment : segmentsOf(child)) {
+                const TNode& childNode = nodes[childSegment];
+                for (auto parentSegment : parentSegments) {
+                    const TNode& parentNode = nodes[parentSegment];
+                    const uint64_t overlapStart =
+                        std::max(parentNode.startTime(), childNode.startTime());
+                    const uint64_t overlapEnd = std::min(parentNode.endTime(), childNode.endTime());
+                    if (overlapStart < overlapEnd) {
+                        newChildren[parentSegment].push_back(childSegment);
+                    } else if (overlapStart == overlapEnd &&
+                               (childNode.startTime() == childNode.endTime() ||
+                                parentNode.startTime() == parentNode.endTime())) {
+                        newChildren[parentSegment].push_back(childSegment);
+                        break;
                     }
                 }
             }
         }
 
-        // A bit overkill, we could also update this while we are adding the new forward edges
-        reverseEdgesHierachy = getReverseEdges(edgesHierarchy);
+        // Segments without children are leaves
+        if (isParentSplit) edgesHierarchy.erase(parent);
+        for (auto parentSegment : parentSegments) {
+            auto itChildren = newChildren.find(parentSegment);
+            if (itChildren != newChildren.end()) {
+                edgesHierarchy.insert_or_assign(parentSegment, itChildren->second);
+            } else if (!isParentSplit) {
+                edgesHierarchy.insert_or_assign(parentSegment, std::vector<size_t>());
+            }
+        }
+
+        // Add the new reverse edges
+        for (const auto& segmentChildren : newChildren) {
+            for (auto childSegment : segmentChildren.second) {
+                reverseEdgesHierachy[childSegment].push_back(segmentChildren.first);
+                changedReverse.insert(childSegment);
+            }
+        }
     }
 
-    if (madeSplit) {
-        splitTemporaryLeaves();
+    // Reverse edges are sorted by parent, nodes without parents have none
+    for (auto nodeIndex : changedReverse) {
+        auto itReverse = reverseEdgesHierachy.find(nodeIndex);
+        std::vector<size_t>& nodeParents = itReverse->second;
+        if (nodeParents.empty()) {
+            reverseEdgesHierachy.erase(itReverse);
+        } else {
+            std::sort(nodeParents.begin(), nodeParents.end());
+        }
     }
+
+    touch();
 }
 
 std::vector<size_t> TemporalTree::getLeaves() const {
@@ -558,9 +640,13 @@ void TemporalTree::deaggregate(TemporalTree& tree) const {
     tree.edgesTime.clear();
 
     // Compute times in this tree
-    std::set<size_t> times;
+    std::set<uint64_t> times;
     getTimes(0, times);
 
+    // Values of all nodes for all times in which they exist
+    TemporalTreeValueColumns columns;
+    columns.build(*this, times);
+
     // Mapping of the nodes in the original tree, to the nodes in the new tree
     std::map<size_t, std::vector<size_t>> nodesOrgingalToDeaggregated;
 
@@ -580,8 +666,7 @@ void TemporalTree::deaggregate(TemporalTree& tree) const {
         }
         // A node gets deaggregated by creating a node for a every global time step
         // in which it exists
-        TValueMap values = node.values;
-        TNode::fillWithLeftNeighborInterpolation(times, values);
+        TValueMap values = columns.getValueMap(nodeIndex);
 
         std::vector<size_t> correspondingNodes;
         correspondingNodes.reserve(values.size());
@@ -891,89 +976,161 @@ bool TemporalTree::TNode::isOverlappingTemporally(uint64_t startTimeA, uint64_t
         (std::max(startTimeA, startTimeB) <= std::min(endTimeA, endTimeB));
 }
 
-void TemporalTree::computeAccumulated(const size_t subtreeIndex, const std::set<uint64_t>& times,
-                                      std::vector<bool>& processed, const bool justLeaves = true) {
-    TemporalTree::TNode& subtreeNode = nodes[subtreeIndex];
-
-    // This node has been processed before, no need to do it again
-    if (processed[subtreeIndex]) {
-        return;
+void TemporalTree::computeAccumulated(const bool justLeaves) {
+    const TemporalTreeTopology topology(*this);
+    const auto sortedTimes = getSortedTimes();
+    const std::vector<uint64_t>& times = *sortedTimes;
+    const size_t numNodes = nodes.size();
+    constexpr size_t InvalidIndex = TemporalTreeValueColumns::InvalidIndex;
+
+    // Only the nodes below the root are accumulated
+    std::vector<bool> isBelowRoot(numNodes, false);
+    std::vector<size_t> nodesToVisit;
+    if (numNodes > 0) {
+        isBelowRoot[0] = true;
+        nodesToVisit.push_back(0);
+    }
+    while (!nodesToVisit.empty()) {
+        const size_t nodeIndex = nodesToVisit.back();
+        nodesToVisit.pop_back();
+        for (auto child : topology.children(nodeIndex)) {
+            if (isBelowRoot[child]) continue;
+            isBelowRoot[child] = true;
+            nodesToVisit.push_back(child);
+        }
     }
 
-    // Forget inner information if there is any
-    if (justLeaves && !isLeaf(subtreeIndex)) {
-        for (auto& timeValuePair : subtreeNode.values) {
-            timeValuePair.second = 0;
+    // Dense buffer for each node from its start to its end time on the sorted times,
+    // a flag tells whether the node has a value at that time
+    auto timeIndex = [&](const uint64_t time) {
+        return size_t(std::lower_bound(times.begin(), times.end(), time) - times.begin());
+    };
+    std::vector<size_t> startIndices(numNodes, InvalidIndex);
+    std::vector<size_t> endIndices(numNodes, InvalidIndex);
+    std::vector<size_t> offsets(numNodes, 0);
+    size_t numValues(0);
+    for (size_t nodeIndex(0); nodeIndex < numNodes; nodeIndex++) {
+        offsets[nodeIndex] = numValues;
+        if (!isBelowRoot[nodeIndex] || nodes[nodeIndex].values.empty()) continue;
+
+        startIndices[nodeIndex] = timeIndex(nodes[nodeIndex].startTime());
+        endIndices[nodeIndex] = timeIndex(nodes[nodeIndex].endTime());
+        numValues += endIndices[nodeIndex] - startIndices[nodeIndex] + 1;
+    }
+    std::vector<float> values(numValues, 0.0f);
+    std::vector<uint8_t> hasValue(numValues, 0);
+    // Leaves only change if missing timesteps are filled
+    std::vector<uint8_t> isFilled(numNodes, 0);
+
+    // Start with the values of the leaves, inner nodes keep their times but forget their values
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int i = 0; i < int(numNodes); i++) {
+        const size_t nodeIndex = size_t(i);
+        if (startIndices[nodeIndex] == InvalidIndex) continue;
+
+        // Reading through a const node keeps the values shared with copies of the tree
+        const TNode& node = nodes[nodeIndex];
+        const bool keepValues = !justLeaves || topology.isLeaf(nodeIndex);
+        const size_t startIdx = startIndices[nodeIndex];
+        size_t timeIdx = startIdx;
+        for (const auto& timeValuePair : node.values) {
+            while (times[timeIdx] != timeValuePair.first) timeIdx++;
+            values[offsets[nodeIndex] + timeIdx - startIdx] =
+                keepValues ? timeValuePair.second : 0.0f;
+            hasValue[offsets[nodeIndex] + timeIdx - startIdx] = 1;
         }
     }
 
-    // Do the computation for all children
-    for (auto& child : this->getHierarchicalChildren(subtreeIndex)) {
-        // Will be called multiple times for children that change their parents
-        computeAccumulated(child, times, processed, justLeaves);
-        // Add the accumulated values of the children to this node
-        // but only where the time overlaps (maximum of the start times and minimum of the end
-        // times)
-        TemporalTree::TNode& childNode = nodes[child];
+    // Going up from the leaves, all children of a node are done before the node itself.
+    // Each node only writes to its own buffer.
+    for (size_t heightIndex(0); heightIndex < topology.numHeights(); heightIndex++) {
+        const auto nodesOfHeight = topology.nodesOfHeight(heightIndex);
+#pragma omp parallel for schedule(dynamic, 16)
+        for (int i = 0; i < int(nodesOfHeight.size()); i++) {
+            const size_t nodeIndex = nodesOfHeight[size_t(i)];
+            if (startIndices[nodeIndex] == InvalidIndex) continue;
+
+            // Buffer positions of the node and its children, indexed by time index
+            const size_t startIdx = startIndices[nodeIndex];
+            const size_t endIdx = endIndices[nodeIndex];
+            const size_t nodeBase = offsets[nodeIndex] - startIdx;
+
+            // Add the accumulated values of the children to this node
+            // but only where the time overlaps
+            for (auto child : topology.children(nodeIndex)) {
+                if (startIndices[child] == InvalidIndex) continue;
+
+                const size_t first = std::max(startIdx, startIndices[child]);
+                size_t last = std::min(endIdx, endIndices[child]);
+                if (first > last) continue;
+                // Include the last value only if the child does not split afterwards
+                if (!topology.successors(child).empty()) {
+                    if (first == last) continue;
+                    last--;
+                }
 
-        auto childIt =
-            childNode.values.find(std::max(subtreeNode.startTime(), childNode.startTime()));
-        // Include the last value if this node does not split afterwards
-        auto childItLast =
-            childNode.values.find(std::min(subtreeNode.endTime(), childNode.endTime()));
-        if (getTemporalSuccessors(child).empty()) {
-            childItLast++;  // Because then we will include childItLast
-        }
+                const size_t childBase = offsets[child] - startIndices[child];
+                for (size_t timeIdx = first; timeIdx <= last; timeIdx++) {
+                    if (!hasValue[childBase + timeIdx]) continue;
+                    values[nodeBase + timeIdx] += values[childBase + timeIdx];
+                    hasValue[nodeBase + timeIdx] = 1;
+                }
+            }
 
-        for (childIt; childIt != childItLast; childIt++) {
-            subtreeNode.values[childIt->first] += childIt->second;
+            // Fill values for missing timesteps with left-neighbor interpolation
+            if (!justLeaves || topology.isLeaf(nodeIndex)) {
+                for (size_t timeIdx = startIdx + 1; timeIdx <= endIdx; timeIdx++) {
+                    if (hasValue[nodeBase + timeIdx]) continue;
+                    values[nodeBase + timeIdx] = values[nodeBase + timeIdx - 1];
+                    hasValue[nodeBase + timeIdx] = 1;
+                    isFilled[nodeIndex] = 1;
+                }
+            }
         }
     }
 
-    // Fill values for missing timesteps with left-neighbor interpolation
-    if (justLeaves && isLeaf(subtreeIndex) || !justLeaves) {
-        subtreeNode.fillWithLeftNeighborInterpolation(times);
+    // Commit the buffers to the value maps once. Unchanged maps stay shared with copies.
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int i = 0; i < int(numNodes); i++) {
+        const size_t nodeIndex = size_t(i);
+        if (startIndices[nodeIndex] == InvalidIndex) continue;
+        if (topology.isLeaf(nodeIndex) && !isFilled[nodeIndex]) continue;
+
+        const size_t nodeBase = offsets[nodeIndex] - startIndices[nodeIndex];
+        TValueMap nodeValueMap;
+        for (size_t timeIdx = startIndices[nodeIndex]; timeIdx <= endIndices[nodeIndex];
+             timeIdx++) {
+            if (hasValue[nodeBase + timeIdx]) {
+                nodeValueMap.emplace_hint(nodeValueMap.end(), times[timeIdx],
+                                          values[nodeBase + timeIdx]);
+            }
+        }
+        // An inner node might already hold its accumulated values
+        const TNode& node = nodes[nodeIndex];
+        if (node.values.get() == nodeValueMap) continue;
+        nodes[nodeIndex].values = std::move(nodeValueMap);
     }
 
-    processed[subtreeIndex] = true;
+    touch();
 }
 
 std::vector<unsigned int> TemporalTree::computeComponents(const TAdjacency& Edges) const {
-    // Initialize components with 0
-    std::vector<unsigned int> componentsMap(this->nodes.size(), 0);
-
-    auto reverseEdges = getReverseEdges(Edges);
-
-    std::function<void(size_t, bool, unsigned int)> processNode =
-        [&](const size_t node, const bool forward, const unsigned int componentId) {
-            const TAdjacency& currentEdges = forward ? Edges : reverseEdges;
-            auto it = currentEdges.find(node);
-            if (it != currentEdges.end()) {
-                for (auto edgeTo : it->second) {
-                    // process the node at the end of the edgeb only
-                    // if it has not been visited either
-                    if (componentsMap[edgeTo] == 0) {
-                        componentsMap[edgeTo] = componentId;
-                        processNode(edgeTo, true, componentId);
-                        processNode(edgeTo, false, componentId);
-                    }
-                }
-            }
-        };
+    // Nodes connected by an edge in either direction are in the same component
+    DisjointSets components(nodes.size());
+    for (const auto& nodeEdges : Edges) {
+        for (auto edgeTo : nodeEdges.second) {
+            components.unite(nodeEdges.first, edgeTo);
+        }
+    }
 
+    // Number the components in the order of their first node, starting with 1
+    std::vector<unsigned int> componentsMap(this->nodes.size(), 0);
+    std::vector<unsigned int> componentIds(this->nodes.size(), 0);
     unsigned int componentsCounter = 0;
-
-    // Iterate over nodes (that have not been visited)
     for (size_t node = 0; node < nodes.size(); node++) {
-        if (componentsMap[node] == 0) {
-            // Start a new component
-            componentsCounter++;
-            componentsMap[node] = componentsCounter;
-            // Traverse all forward and backward edges for this node
-            // Labelling all encountered nodes as part of the new component
-            processNode(node, true, componentsCounter);
-            processNode(node, false, componentsCounter);
-        }
+        unsigned int& componentId = componentIds[components.find(node)];
+        if (componentId == 0) componentId = ++componentsCounter;
+        componentsMap[node] = componentId;
     }
 
     return componentsMap;
@@ -1002,20 +1159,51 @@ std::vector<unsigned int> TemporalTree::computeComponents(const TAdjacency& Edge
 
 std::map<uint64_t, float> TemporalTree::computeAccumulatedRootOnly(
     const std::set<uint64_t>& times) const {
-    std::map<uint64_t, float> result;
-    auto leaves = getLeaves();
-    for (auto leaf : leaves) {
-        // Copy values of the leaf
-        std::map<uint64_t, float> values = nodes[leaf].values;
-        TNode::fillWithLeftNeighborInterpolation(times, values);
-        for (auto timeValuePair : values) {
-            // If there are temporal sucessors, skip the value, the sucessors first value will
-            // contribute to the sum
-            if (timeValuePair.first == values.rbegin()->first &&
-                !getTemporalSuccessors(leaf).empty()) {
-                continue;
+    // Interpolated values of all nodes on the given times
+    TemporalTreeValueColumns columns;
+    columns.build(*this, times);
+
+    // Same as accumulating the leaves directly into the root. Blocks of times are summed up
+    // in parallel, each in the order of the leaves.
+    constexpr size_t TimeBlockSize = 256;
+    const size_t numTimes = columns.numTimes();
+    const int numBlocks = int((numTimes + TimeBlockSize - 1) / TimeBlockSize);
+    std::vector<float> sums(numTimes, 0.0f);
+    std::vector<uint8_t> hasSum(numTimes, 0);
+
+    // Range of times each leaf contributes to. If there are temporal sucessors, skip the
+    // last value, the sucessors first value will contribute to the sum.
+    std::vector<std::pair<size_t, size_t>> leafRanges;
+    std::vector<size_t> leavesWithValues;
+    for (auto leaf : getLeaves()) {
+        if (!columns.hasValues(leaf)) continue;
+        size_t endIdx = columns.endIndex(leaf) + 1;
+        if (!getTemporalSuccessors(leaf).empty()) endIdx--;
+        leafRanges.emplace_back(columns.startIndex(leaf), endIdx);
+        leavesWithValues.push_back(leaf);
+    }
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int block = 0; block < numBlocks; block++) {
+        const size_t blockStart = size_t(block) * TimeBlockSize;
+        const size_t blockEnd = std::min(blockStart + TimeBlockSize, numTimes);
+
+        for (size_t i(0); i < leavesWithValues.size(); i++) {
+            const size_t startIdx = leafRanges[i].first;
+            const size_t first = std::max(startIdx, blockStart);
+            const size_t last = std::min(leafRanges[i].second, blockEnd);
+            const float* values = columns.column(leavesWithValues[i]);
+            for (size_t timeIdx = first; timeIdx < last; timeIdx++) {
+                sums[timeIdx] += values[timeIdx - startIdx];
+                hasSum[timeIdx] = 1;
             }
-            result[timeValuePair.first] += timeValuePair.second;
+        }
+    }
+
+    std::map<uint64_t, float> result;
+    for (size_t timeIdx(0); timeIdx < sums.size(); timeIdx++) {
+        if (hasSum[timeIdx]) {
+            result.emplace_hint(result.end(), columns.times()[timeIdx], sums[timeIdx]);
         }
     }
 
@@ -1029,114 +1217,34 @@ size_t TemporalTree::getConstraintClusters(std::vector<std::pair<int, int>>& Clu
     std::fill(Clusters.begin(), Clusters.end(), std::make_pair<int, int>(-1, -1));
     int NumFound(0);
 
-    // Get reversed time edges
-    TAdjacency reversedEdgesTime = getReverseEdges(edgesTime);
-
+    // The left side of node i is 2i, the right side 2i+1. A time edge joins the right side of
+    // its from node with the left side of its to node.
+    DisjointSets sides(2 * NumNodes);
     for (const auto& edge : edgesTime) {
-        // Shorthands
-        const size_t idFromLeft(edge.first);
-        const std::vector<size_t>& idsToRight = edge.second;
-
-        // Safety
-        ivwAssert(!idsToRight.empty(), "Time map is empty.");
-        if (idsToRight.empty()) continue;
-
-        // This is an actual split
-        if (idsToRight.size() > 1) {
-            Clusters[idFromLeft].second = NumFound;
-
-            for (auto idToRight : idsToRight) {
-                Clusters[idToRight].first = NumFound;
-            }
-
-            NumFound++;
-        } else {
-            auto leftForThatOneRight = reversedEdgesTime.find(idsToRight.front());
-            if (leftForThatOneRight != reversedEdgesTime.end()) {
-                // If it is a direct correspondance
-                if (leftForThatOneRight->second.size() == 1) {
-                    Clusters[idsToRight.front()].first = NumFound;
-                    Clusters[leftForThatOneRight->second.front()].second = NumFound;
-                    NumFound++;
-                }
-            }
+        ivwAssert(!edge.second.empty(), "Time map is empty.");
+        for (auto idToRight : edge.second) {
+            sides.unite(2 * edge.first + 1, 2 * idToRight);
         }
     }
 
-    for (const auto& edge : reversedEdgesTime) {
-        // Shorthands
-        const size_t idToRight(edge.first);
-        const std::vector<size_t>& idsFromLeft = edge.second;
-
-        if (idsFromLeft.size() > 1) {
-            Clusters[idToRight].first = NumFound;
-
-            for (auto idFromLeft : idsFromLeft) {
-                Clusters[idFromLeft].second = NumFound;
-            }
-
-            NumFound++;
-        }
-    }
+    // Number the clusters in the order in which they are found
+    std::vector<int> clusterIds(2 * NumNodes, -1);
+    auto getClusterId = [&](const size_t side) {
+        int& clusterId = clusterIds[sides.find(side)];
+        if (clusterId < 0) clusterId = NumFound++;
+        return clusterId;
+    };
 
-    /*std::vector<bool> bVisitedLeft(NumNodes, false);
-    std::vector<bool> bVisitedRight(NumNodes, false);
-    for(const auto& edge : edgesTime)
-    {
-        //Shorthands
+    for (const auto& edge : edgesTime) {
+        // Shorthands
         const size_t idFromLeft(edge.first);
         const std::vector<size_t>& idsToRight = edge.second;
 
-        //Safety
-        ivwAssert(!idsToRight.empty(), "Time map is empty.");
-        if (idsToRight.empty()) continue;
-        ivwAssert(bVisitedLeft[idFromLeft] == bVisitedRight[idsToRight.front()], "Visitation maps
-    should be consistent.");
-
-        if (bVisitedLeft[idFromLeft]) continue;
-
-        //Start new component
-        std::queue<std::pair<bool, size_t>> Q;
-        Q.emplace(true, idFromLeft);
-        bVisitedLeft[idFromLeft] = true;
-        Clusters[idFromLeft].second = (int)NumFound;
-
-        //Visit connected neighbors
-        while (!Q.empty())
-        {
-            //Who is first?
-            const auto& Front = Q.front();
-
-            //The grass is always greener on the other side!
-            const std::vector<size_t>& ToTheGreenerSide = Front.first ? edgesTime.at(Front.second) :
-    reversedEdgesTime.at(Front.second); std::vector<bool>& bVisitedOnTheGreenerSide = Front.first ?
-    bVisitedRight : bVisitedLeft;
-
-            //Add the neighbors to the Queue
-            for(const size_t& idNeigh : ToTheGreenerSide)
-            {
-                if (!bVisitedOnTheGreenerSide[idNeigh])
-                {
-                    Q.emplace(!Front.first, idNeigh);
-                    bVisitedOnTheGreenerSide[idNeigh] = true;
-                    if (Front.first)
-                    {
-                        Clusters[idNeigh].first = (int)NumFound;
-                    }
-                    else
-                    {
-                        Clusters[idNeigh].second = (int)NumFound;
-                    }
-                }
-            }
-
-            //Remove current point from the queue
-            Q.pop();
+        Clusters[idFromLeft].second = getClusterId(2 * idFromLeft + 1);
+        for (auto idToRight : idsToRight) {
+            Clusters[idToRight].first = getClusterId(2 * idToRight);
         }
-
-        //Off to the next cluster.
-        NumFound++;
-    }*/
+    }
 
     return NumFound;
 }
@@ -1228,6 +1336,7 @@ void TemporalTree::addDefaultTimesForParents(const size_t nodeIndex, uint64_t& t
         }
 
         // Set these times for this parent: overwrite values vector completely!
+        touch();
         auto& Values = nodes[nodeIndex].values;
         Values.clear();
         Values.emplace(tMin, 0.0f);
@@ -1235,7 +1344,59 @@ void TemporalTree::addDefaultTimesForParents(const size_t nodeIndex, uint64_t& t
     }
 }
 
+std::shared_ptr<const std::vector<uint64_t>> TemporalTree::getSortedTimes() const {
+    std::lock_guard<std::mutex> lock(timesCache.mutex);
+    if (timesCache.times && timesCache.version == version) {
+        return timesCache.times;
+    }
+
+    // Times of all nodes below the root, each node visited once
+    auto sortedTimes = std::make_shared<std::vector<uint64_t>>();
+    if (!nodes.empty()) {
+        std::vector<bool> visited(nodes.size(), false);
+        std::vector<size_t> toVisit{0};
+        visited[0] = true;
+        while (!toVisit.empty()) {
+            const size_t nodeIndex = toVisit.back();
+            toVisit.pop_back();
+            for (auto& timeValuePair : nodes[nodeIndex].values) {
+                sortedTimes->push_back(timeValuePair.first);
+            }
+            auto itChildren = edgesHierarchy.find(nodeIndex);
+            if (itChildren == edgesHierarchy.end()) continue;
+            for (auto child : itChildren->second) {
+                if (!visited[child]) {
+                    visited[child] = true;
+                    toVisit.push_back(child);
+                }
+            }
+        }
+    }
+    std::sort(sortedTimes->begin(), sortedTimes->end());
+    sortedTimes->erase(std::unique(sortedTimes->begin(), sortedTimes->end()), sortedTimes->end());
+
+    timesCache.version = version;
+    timesCache.times = sortedTimes;
+    return timesCache.times;
+}
+
+size_t TemporalTree::getTimeRank(const uint64_t time) const {
+    auto sortedTimes = getSortedTimes();
+    auto it = std::lower_bound(sortedTimes->begin(), sortedTimes->end(), time);
+    if (it == sortedTimes->end() || *it != time) return sortedTimes->size();
+    return size_t(it - sortedTimes->begin());
+}
+
 void TemporalTree::getTimes(const size_t subtreeIndex, std::set<uint64_t>& times) const {
+    // The times of the entire tree are cached
+    if (subtreeIndex == 0) {
+        auto sortedTimes = getSortedTimes();
+        for (auto time : *sortedTimes) {
+            times.emplace_hint(times.end(), time);
+        }
+        return;
+    }
+
     // Process all children of the node
     for (auto child : TemporalTree::getHierarchicalChildren(subtreeIndex)) {
         getTimes(child, times);
@@ -1288,12 +1449,11 @@ bool TemporalTree::checkConsistency() const {
 
     std::vector<std::set<size_t>> componentEdgesToParents(numComponents);
 
-    auto reverseEdgesHierarchy = this->getReverseEdges(this->edgesHierarchy);
+    const TemporalTreeTopology topology(*this);
     for (size_t node = 0; node < nodes.size(); node++) {
         // componentsMap has values [1, numComponents]
         auto componentId = componentsMap[node] - 1;
-        auto parents = getEdgesFrom(node, reverseEdgesHierarchy);
-        for (auto parent : parents) {
+        for (auto parent : topology.parents(node)) {
             componentEdgesToParents[componentId].insert(componentsMap[parent] - 1);
         }
         // Node has an earlier start than so far computed value
@@ -1307,8 +1467,8 @@ bool TemporalTree::checkConsistency() const {
     }
 
     // There should only be a single root node at index 0
-    if (!componentEdgesToParents[0].empty() || !getEdgesFrom(0, this->edgesTime).empty() ||
-        !getEdgesTo(0, this->edgesTime).empty()) {
+    if (!componentEdgesToParents[0].empty() || !topology.successors(0).empty() ||
+        !topology.predecessors(0).empty()) {
         LogError("The node at index 0 does not qualify as a root.");
         return false;
     }
@@ -69,25 +69,32 @@ void treecolor::traverseToLeavesForColor(TemporalTree& tree, size_t nodeIndex, f
                                          const int colorFrom, const int colorTo,
                                          const std::function<vec3(float)>& sampleColor) {
     // Shorthands
-    TemporalTree::TNode& node = tree.nodes[nodeIndex];
-    auto& colors = node.colors;
-    auto& cushion = node.cushion;
+    TemporalTreeLayoutResult& layout = tree.layout;
+    const TemporalTree::TAdjacency& edgesHierarchy = tree.edgesHierarchy;
 
     vec3 color = sampleColor((rangeStart + rangeEnd) / 2.0f);
 
-    // A parent might have 0 values that extend over the time of all its children
-    // but we will have no limit information for these
-    startTime = std::max(startTime, cushion.begin()->first);
-    endTime = std::min(endTime, cushion.rbegin()->first);
-
-    // Fill colors
-    auto itEnd = std::next(cushion.find(endTime));
-    for (auto it = cushion.find(startTime); it != itEnd; it++) {
-        // We might overwrite things here
-        auto inserted = colors.emplace(it->first, vec4(color, 1.0f));
+    if (layout.hasCushions(nodeIndex)) {
+        // A parent might have 0 values that extend over the time of all its children
+        // but we will have no limit information for these
+        const std::vector<uint64_t>& times = layout.times();
+        startTime = std::max(startTime, times[layout.cushionStartIndex(nodeIndex)]);
+        endTime = std::min(endTime, times[layout.cushionEndIndex(nodeIndex)]);
+
+        // Fill colors, we do not overwrite colors that have been set
+        const size_t startIdx = layout.timeIndex(startTime);
+        const size_t endIdx = layout.timeIndex(endTime);
+        if (startIdx != TemporalTreeLayoutResult::InvalidIndex &&
+            endIdx != TemporalTreeLayoutResult::InvalidIndex) {
+            for (size_t timeIdx = startIdx; timeIdx <= endIdx; timeIdx++) {
+                if (layout.hasCushion(nodeIndex, timeIdx) && !layout.hasColor(nodeIndex, timeIdx)) {
+                    layout.setColor(nodeIndex, timeIdx) = vec4(color, 1.0f);
+                }
+            }
+        }
     }
 
-    const auto itHierarchyEdges = tree.edgesHierarchy.find(nodeIndex);
+    const auto itHierarchyEdges = edgesHierarchy.find(nodeIndex);
 
     int sign = (rangeEnd - rangeStart < 0) ? -1 : ((rangeEnd - rangeStart > 0) ? 1 : 0);
 
@@ -101,7 +108,7 @@ void treecolor::traverseToLeavesForColor(TemporalTree& tree, size_t nodeIndex, f
     }
 
     // not a leaf -> process children?
-    if (itHierarchyEdges != tree.edgesHierarchy.end()) {
+    if (itHierarchyEdges != edgesHierarchy.end()) {
         float rangeStartChild = rangeStart;
 
         auto& children = itHierarchyEdges->second;
@@ -114,7 +121,7 @@ void treecolor::traverseToLeavesForColor(TemporalTree& tree, size_t nodeIndex, f
         bool evenChild = true;
 
         for (auto child : children) {
-            TemporalTree::TNode& childNode = tree.nodes[child];
+            const TemporalTree::TNode& childNode = tree.nodes[child];
             // Find the time range for which this is the child
             uint64_t startTimeChild = std::max(startTime, childNode.startTime());
             uint64_t endTimeChild = std::min(endTime, childNode.endTime());
@@ -0,0 +1,137 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 19:02:48
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#include <modules/temporaltreemaps/datastructures/treeintervalindex.h>
+#include <numeric>
+
+namespace inviwo {
+namespace kth {
+
+void TemporalTreeIntervalIndex::build(const TemporalTree& tree) {
+    sortedNodes.clear();
+    sortedNodes.reserve(tree.nodes.size());
+    for (size_t nodeIndex(0); nodeIndex < tree.nodes.size(); nodeIndex++) {
+        if (!tree.nodes[nodeIndex].values.empty()) sortedNodes.push_back(nodeIndex);
+    }
+
+    std::stable_sort(sortedNodes.begin(), sortedNodes.end(), [&](const size_t a, const size_t b) {
+        return tree.nodes[a].startTime() < tree.nodes[b].startTime();
+    });
+
+    const size_t numNodes = sortedNodes.size();
+    sortedStartTimes.resize(numNodes);
+    sortedEndTimes.resize(numNodes);
+    for (size_t i(0); i < numNodes; i++) {
+        sortedStartTimes[i] = tree.nodes[sortedNodes[i]].startTime();
+        sortedEndTimes[i] = tree.nodes[sortedNodes[i]].endTime();
+    }
+
+    parents = tree.getReverseEdges(tree.edgesHierarchy);
+
+    centerNodes.clear();
+    centerByStart.clear();
+    centerByEnd.clear();
+    std::vector<size_t> positions(numNodes);
+    std::iota(positions.begin(), positions.end(), size_t(0));
+    buildCenterNode(positions);
+}
+
+size_t TemporalTreeIntervalIndex::buildCenterNode(const std::vector<size_t>& positions) {
+    if (positions.empty()) return NoChild;
+
+    // The median of all end points splits off at most half of the lifetimes to each side
+    std::vector<uint64_t> endPoints;
+    endPoints.reserve(2 * positions.size());
+    for (auto position : positions) {
+        endPoints.push_back(sortedStartTimes[position]);
+        endPoints.push_back(sortedEndTimes[position]);
+    }
+    auto itMedian = endPoints.begin() + endPoints.size() / 2;
+    std::nth_element(endPoints.begin(), itMedian, endPoints.end());
+    const uint64_t center = *itMedian;
+
+    // Positions stay sorted, which sorts them by start time
+    std::vector<size_t> leftPositions;
+    std::vector<size_t> rightPositions;
+    const size_t first = centerByStart.size();
+    for (auto position : positions) {
+        if (sortedEndTimes[position] < center) {
+            leftPositions.push_back(position);
+        } else if (sortedStartTimes[position] > center) {
+            rightPositions.push_back(position);
+        } else {
+            centerByStart.push_back(position);
+        }
+    }
+    const size_t last = centerByStart.size();
+
+    centerByEnd.insert(centerByEnd.end(), centerByStart.begin() + first, centerByStart.end());
+    std::stable_sort(centerByEnd.begin() + first, centerByEnd.end(),
+                     [&](const size_t a, const size_t b) {
+                         return sortedEndTimes[a] > sortedEndTimes[b];
+                     });
+
+    const size_t nodeIndex = centerNodes.size();
+    centerNodes.push_back({center, first, last, NoChild, NoChild});
+    const size_t left = buildCenterNode(leftPositions);
+    const size_t right = buildCenterNode(rightPositions);
+    centerNodes[nodeIndex].left = left;
+    centerNodes[nodeIndex].right = right;
+    return nodeIndex;
+}
+
+void TemporalTreeIntervalIndex::getNodesAt(const uint64_t time,
+                                           std::vector<size_t>& nodeIndices) const {
+    nodeIndices.clear();
+
+    size_t nodeIndex = centerNodes.empty() ? NoChild : 0;
+    while (nodeIndex != NoChild) {
+        const CenterNode& node = centerNodes[nodeIndex];
+        if (time < node.center) {
+            // All lifetimes here end after the time, report those that have started
+            for (size_t i(node.first); i < node.last; i++) {
+                if (sortedStartTimes[centerByStart[i]] > time) break;
+                nodeIndices.push_back(sortedNodes[centerByStart[i]]);
+            }
+            nodeIndex = node.left;
+        } else if (time > node.center) {
+            // All lifetimes here start before the time, report those that have not ended
+            for (size_t i(node.first); i < node.last; i++) {
+                if (sortedEndTimes[centerByEnd[i]] < time) break;
+                nodeIndices.push_back(sortedNodes[centerByEnd[i]]);
+            }
+            nodeIndex = node.right;
+        } else {
+            for (size_t i(node.first); i < node.last; i++) {
+                nodeIndices.push_back(sortedNodes[centerByStart[i]]);
+            }
+            nodeIndex = NoChild;
+        }
+    }
+}
+
+void TemporalTreeIntervalIndex::getNodesIn(const uint64_t startTime, const uint64_t endTime,
+                                           std::vector<size_t>& nodeIndices) const {
+    if (startTime > endTime) {
+        nodeIndices.clear();
+        return;
+    }
+
+    // Nodes alive at the start of the interval and nodes starting later within it
+    getNodesAt(startTime, nodeIndices);
+    auto itFirst = std::upper_bound(sortedStartTimes.begin(), sortedStartTimes.end(), startTime);
+    auto itLast = std::upper_bound(itFirst, sortedStartTimes.end(), endTime);
+    for (auto it = itFirst; it != itLast; ++it) {
+        nodeIndices.push_back(sortedNodes[it - sortedStartTimes.begin()]);
+    }
+}
+
+}  // namespace kth
+}  // namespace inviwo
@@ -108,8 +108,8 @@ std::shared_ptr<TemporalTree> readJSONTree(const std::string& filePath, const in
     }
 
     // Read the edges
-    ReadEdges(j, "edgesHierarchy", pTree->edgesHierarchy);
-    ReadEdges(j, "edgesTime", pTree->edgesTime);
+    ReadEdges(j, "edgesHierarchy", pTree->edgesHierarchy.get());
+    ReadEdges(j, "edgesTime", pTree->edgesTime.get());
 
     // Read the order
     if (j.cend() != j.find("order")) {
@@ -376,9 +376,9 @@ std::shared_ptr<TemporalTree> TemporalTreeJSONReaderNTG::readData(const std::str
     // Read the edges
     bool bOKWhileReadingEdges(true);
     bOKWhileReadingEdges =
-        bOKWhileReadingEdges && ReadEdgesNTG(j, "EN", NodeNameToIndex, pTree->edgesHierarchy);
+        bOKWhileReadingEdges && ReadEdgesNTG(j, "EN", NodeNameToIndex, pTree->edgesHierarchy.get());
     bOKWhileReadingEdges =
-        bOKWhileReadingEdges && ReadEdgesNTG(j, "ET", NodeNameToIndex, pTree->edgesTime);
+        bOKWhileReadingEdges && ReadEdgesNTG(j, "ET", NodeNameToIndex, pTree->edgesTime.get());
 
     if (!bOKWhileReadingEdges) {
         throw DataReaderException("Could not read edges!",
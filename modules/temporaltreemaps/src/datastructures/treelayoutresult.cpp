@@ -0,0 +1,132 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 22:03:47
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#include <modules/temporaltreemaps/datastructures/treelayoutresult.h>
+#include <modules/temporaltreemaps/datastructures/tree.h>
+#include <atomic>
+
+namespace inviwo {
+namespace kth {
+
+/// Last version given to any limits
+static std::atomic<uint64_t> lastLimitsVersion(0);
+
+void TemporalTreeLayoutResult::reset(const TemporalTree& tree) {
+    auto newAxis = std::make_shared<TAxis>();
+    newAxis->times = tree.getSortedTimes();
+    const std::vector<uint64_t>& sortedTimes = *newAxis->times;
+
+    const size_t numTreeNodes = tree.nodes.size();
+    newAxis->firstIndices.assign(numTreeNodes, InvalidIndex);
+    newAxis->lastIndices.assign(numTreeNodes, InvalidIndex);
+    newAxis->offsets.assign(numTreeNodes, 0);
+
+    for (size_t nodeIndex(0); nodeIndex < numTreeNodes; nodeIndex++) {
+        const auto& node = tree.nodes[nodeIndex];
+        newAxis->offsets[nodeIndex] = newAxis->numSlots;
+        if (node.values.empty()) continue;
+
+        const size_t firstIdx = size_t(
+            std::lower_bound(sortedTimes.begin(), sortedTimes.end(), node.startTime()) -
+            sortedTimes.begin());
+        const size_t lastIdx = size_t(
+            std::upper_bound(sortedTimes.begin(), sortedTimes.end(), node.endTime()) -
+            sortedTimes.begin()) - 1;
+
+        newAxis->firstIndices[nodeIndex] = firstIdx;
+        newAxis->lastIndices[nodeIndex] = lastIdx;
+        newAxis->numSlots += lastIdx - firstIdx + 1;
+    }
+
+    axis = newAxis;
+    limitLayer.reset();
+    cushionLayer.reset();
+    colorLayer.reset();
+    limitsVersion = 0;
+    previousLimitsVersion = 0;
+    changedNodes.clear();
+}
+
+bool TemporalTreeLayoutResult::fitsWithTree(const TemporalTree& tree) const {
+    if (!axis || numNodes() != tree.nodes.size()) return false;
+
+    auto treeTimes = tree.getSortedTimes();
+    return treeTimes == axis->times || *treeTimes == *axis->times;
+}
+
+size_t TemporalTreeLayoutResult::timeIndex(const uint64_t time) const {
+    if (!axis) return InvalidIndex;
+
+    const std::vector<uint64_t>& sortedTimes = *axis->times;
+    auto it = std::lower_bound(sortedTimes.begin(), sortedTimes.end(), time);
+    if (it == sortedTimes.end() || *it != time) return InvalidIndex;
+    return size_t(it - sortedTimes.begin());
+}
+
+bool TemporalTreeLayoutResult::hasSameLimits(const TemporalTreeLayoutResult& other,
+                                             const size_t nodeIndex) const {
+    if (hasLimits(nodeIndex) != other.hasLimits(nodeIndex)) return false;
+    if (!hasLimits(nodeIndex)) return true;
+    if (limitLayer == other.limitLayer) return true;
+
+    const size_t startIdx = startIndex(nodeIndex);
+    const size_t endIdx = endIndex(nodeIndex);
+    if (startIdx != other.startIndex(nodeIndex) || endIdx != other.endIndex(nodeIndex)) {
+        return false;
+    }
+
+    for (size_t timeIdx = startIdx; timeIdx <= endIdx; timeIdx++) {
+        if (isSet(nodeIndex, timeIdx) != other.isSet(nodeIndex, timeIdx)) return false;
+        if (!isSet(nodeIndex, timeIdx)) continue;
+
+        const TBandLimits& limitsHere = limits(nodeIndex, timeIdx);
+        const TBandLimits& limitsOther = other.limits(nodeIndex, timeIdx);
+        if (limitsHere.lower != limitsOther.lower || limitsHere.upper != limitsOther.upper) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TemporalTreeLayoutResult::adoptLimits(const TemporalTreeLayoutResult& other) {
+    axis = other.axis;
+    limitLayer = other.limitLayer;
+    cushionLayer.reset();
+    colorLayer.reset();
+    limitsVersion = other.limitsVersion;
+    previousLimitsVersion = other.previousLimitsVersion;
+    changedNodes = other.changedNodes;
+}
+
+void TemporalTreeLayoutResult::markLimitsComputed() {
+    limitsVersion = ++lastLimitsVersion;
+    previousLimitsVersion = 0;
+    changedNodes.clear();
+}
+
+void TemporalTreeLayoutResult::markLimitsUpdated(std::vector<size_t> changedNodeIndices) {
+    previousLimitsVersion = limitsVersion;
+    limitsVersion = ++lastLimitsVersion;
+    changedNodes = std::move(changedNodeIndices);
+}
+
+size_t TemporalTreeLayoutResult::memory() const {
+    if (!axis) return 0;
+
+    size_t bytes = axis->times->size() * sizeof(uint64_t) + 3 * numNodes() * sizeof(size_t);
+    const size_t perNode = 2 * numNodes() * sizeof(size_t);
+    if (limitLayer) bytes += axis->numSlots * (sizeof(TBandLimits) + 1) + perNode;
+    if (cushionLayer) bytes += axis->numSlots * (sizeof(TCushion) + 1) + perNode;
+    if (colorLayer) bytes += axis->numSlots * (sizeof(vec4) + 1) + perNode;
+    return bytes;
+}
+
+}  // namespace kth
+}  // namespace inviwo
@@ -15,6 +15,38 @@ namespace kth {
 
 namespace treeorder {
 
+Permutation::Permutation(const TemporalTree::TTreeOrder& order, const size_t numNodes) {
+    set(order, numNodes);
+}
+
+void Permutation::set(const TemporalTree::TTreeOrder& newOrder, const size_t numNodes) {
+    order = newOrder;
+    positions.assign(numNodes, InvalidPosition);
+    for (size_t position = 0; position < order.size(); position++) {
+        ivwAssert(order[position] < numNodes, "Node index outside of the permutation.");
+        positions[order[position]] = position;
+    }
+}
+
+void Permutation::swapPositions(const size_t positionA, const size_t positionB) {
+    std::swap(order[positionA], order[positionB]);
+    positions[order[positionA]] = positionA;
+    positions[order[positionB]] = positionB;
+}
+
+void Permutation::swapNodes(const size_t nodeA, const size_t nodeB) {
+    swapPositions(positions[nodeA], positions[nodeB]);
+}
+
+void Permutation::setNodeAt(const size_t position, const size_t nodeIndex) {
+    order[position] = nodeIndex;
+    positions[nodeIndex] = position;
+}
+
+void Permutation::setPosition(const size_t nodeIndex, const size_t position) {
+    positions[nodeIndex] = position;
+}
+
 void orderAsInserted(TemporalTree::TTreeOrder& order, const TemporalTree& tree) {
     auto leaves = tree.getLeaves();
 
@@ -72,39 +104,35 @@ bool fitsWithTree(const TemporalTree& tree, const TemporalTree::TTreeOrder& leaf
     return true;
 }
 
-void sortNodesByOrder(const TemporalTree::TTreeOrderMap& orderMap, const TemporalTree& tree,
+void sortNodesByOrder(const Permutation& order, const TemporalTree& tree,
                       std::vector<size_t>& nodeIndices) {
     std::sort(nodeIndices.begin(), nodeIndices.end(),
-              [&orderMap, &tree](const size_t a, const size_t b) -> bool {
-                  auto itIndexA = orderMap.find(a);
-                  auto itIndexB = orderMap.find(b);
+              [&order, &tree](const size_t a, const size_t b) -> bool {
                   // If either index a or b are not in the order, we cannot sort the given
-                  ivwAssert(itIndexA != orderMap.end() && itIndexB != orderMap.end(),
+                  ivwAssert(order.contains(a) && order.contains(b),
                             "We cannot sort nodes when their indices are not in the given order.");
 
+                  const size_t positionA = order.positionOf(a);
+                  const size_t positionB = order.positionOf(b);
+
                   // Compare by sort indices (first cases should only occur when we are comparing
                   // non-leaves)
-                  if (itIndexA->second == itIndexB->second) {
+                  if (positionA == positionB) {
                       // Sort by beginning times
                       return tree.nodes[a].startTime() < tree.nodes[b].startTime();
                   }
-                  return itIndexA->second < itIndexB->second;
+                  return positionA < positionB;
               });
 }
 
-TemporalTree::TTreeOrderMap expandToFullTree(const TemporalTree& tree,
-                                             const TemporalTree::TTreeOrderMap& leafOrderMap) {
-    TemporalTree::TTreeOrderMap treeOrderMap(leafOrderMap);
-    setToMinInChildren(0, tree, treeOrderMap);
-    return treeOrderMap;
+Permutation expandToFullTree(const TemporalTree& tree, const Permutation& leafOrder) {
+    Permutation treeOrder(leafOrder.getOrder(), tree.nodes.size());
+    setToMinInChildren(0, tree, treeOrder);
+    return treeOrder;
 }
 
-void toSimpleOrder(TemporalTree::TTreeOrder& order, const TemporalTree::TTreeOrderMap& orderMap) {
-    order.resize(orderMap.size());
-
-    for (const auto indexSortIndexPair : orderMap) {
-        order[indexSortIndexPair.second] = indexSortIndexPair.first;
-    }
+void toSimpleOrder(TemporalTree::TTreeOrder& order, const Permutation& permutation) {
+    order = permutation.getOrder();
 }
 
 void toOrderMap(TemporalTree::TTreeOrderMap& orderMap, const TemporalTree::TTreeOrder& order) {
@@ -115,7 +143,7 @@ void toOrderMap(TemporalTree::TTreeOrderMap& orderMap, const TemporalTree::TTree
 
 //@todo: Might only work for no edgecrossings??
 size_t setToMinInChildren(const size_t nodeIndex, const TemporalTree& tree,
-                          TemporalTree::TTreeOrderMap& orderMap) {
+                          Permutation& permutation) {
     const auto itHierarchyEdges = tree.edgesHierarchy.find(nodeIndex);
 
     // Is it a leaf or a parent?
@@ -129,13 +157,13 @@ size_t setToMinInChildren(const size_t nodeIndex, const TemporalTree& tree,
         // Call recursively, order for children
         size_t orderMin = std::numeric_limits<size_t>::max();
         for (const size_t idChild : Children) {
-            size_t orderMinChild = setToMinInChildren(idChild, tree, orderMap);
+            size_t orderMinChild = setToMinInChildren(idChild, tree, permutation);
             // Update?
             if (orderMinChild < orderMin) orderMin = orderMinChild;
         }
-        orderMap[nodeIndex] = orderMin;
+        permutation.setPosition(nodeIndex, orderMin);
     }
-    return orderMap[nodeIndex];
+    return permutation.positionOf(nodeIndex);
 }
 }  // namespace treeorder
 
@@ -0,0 +1,303 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 18:10:22
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#include <modules/temporaltreemaps/datastructures/treetopology.h>
+
+namespace inviwo {
+namespace kth {
+
+void TemporalTreeTopology::build(const TemporalTree& tree) {
+    const size_t numNodes = tree.nodes.size();
+
+    buildAdjacency(numNodes, tree.edgesHierarchy, false, childOffsets, childIndices);
+    buildAdjacency(numNodes, tree.edgesHierarchy, true, parentOffsets, parentIndices);
+    buildAdjacency(numNodes, tree.edgesTime, false, successorOffsets, successorIndices);
+    buildAdjacency(numNodes, tree.edgesTime, true, predecessorOffsets, predecessorIndices);
+
+    // A node is a leaf if it has no outgoing hierarchical edges, even if the list is empty
+    isLeafNode.assign(numNodes, true);
+    for (const auto& edges : tree.edgesHierarchy) {
+        if (edges.first < numNodes) isLeafNode[edges.first] = false;
+    }
+    leafIndices.clear();
+    for (size_t nodeIndex(0); nodeIndex < numNodes; nodeIndex++) {
+        if (isLeafNode[nodeIndex]) leafIndices.push_back(nodeIndex);
+    }
+
+    buildDepths();
+    buildLevels();
+    buildHeights();
+    buildTour();
+}
+
+void TemporalTreeTopology::buildAdjacency(const size_t numNodes,
+                                          const TemporalTree::TAdjacency& edges,
+                                          const bool reverse, std::vector<size_t>& offsets,
+                                          std::vector<size_t>& indices) {
+    offsets.assign(numNodes + 1, 0);
+
+    // Count edges per node, shifted by one to sum them up in place
+    for (const auto& nodeEdges : edges) {
+        if (reverse) {
+            for (const auto to : nodeEdges.second) offsets[to + 1]++;
+        } else {
+            offsets[nodeEdges.first + 1] += nodeEdges.second.size();
+        }
+    }
+    for (size_t nodeIndex(0); nodeIndex < numNodes; nodeIndex++) {
+        offsets[nodeIndex + 1] += offsets[nodeIndex];
+    }
+
+    // Going through the map by increasing source gives sorted reverse edges,
+    // same as TemporalTree::getReverseEdges
+    indices.resize(offsets[numNodes]);
+    std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (const auto& nodeEdges : edges) {
+        for (const auto to : nodeEdges.second) {
+            if (reverse) {
+                indices[fill[to]++] = nodeEdges.first;
+            } else {
+                indices[fill[nodeEdges.first]++] = to;
+            }
+        }
+    }
+}
+
+void TemporalTreeTopology::buildDepths() {
+    const size_t numNodes = isLeafNode.size();
+    depths.assign(numNodes, InvalidIndex);
+    if (numNodes == 0) return;
+    depths[0] = 0;
+
+    // Walk up through the first parents until we find a node with known depth,
+    // then assign depths on the way back down
+    std::vector<size_t> chain;
+    for (size_t nodeIndex(1); nodeIndex < numNodes; nodeIndex++) {
+        size_t current = nodeIndex;
+        chain.clear();
+        while (depths[current] == InvalidIndex) {
+            auto nodeParents = parents(current);
+            if (nodeParents.empty()) {
+                // Not connected to the root, treat as a root of its own
+                depths[current] = 0;
+                break;
+            }
+            chain.push_back(current);
+            current = nodeParents[0];
+        }
+
+        size_t currentDepth = depths[current];
+        for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+            depths[*it] = ++currentDepth;
+        }
+    }
+}
+
+void TemporalTreeTopology::buildLevels() {
+    const size_t numNodes = isLeafNode.size();
+    levelOffsets.assign(1, 0);
+    levelNodes.clear();
+    if (numNodes == 0) return;
+
+    // Same as TemporalTree::getLevel, all children of the previous level
+    std::vector<size_t> currentLevel{0};
+    std::vector<size_t> nextLevel;
+    while (!currentLevel.empty() && levelOffsets.size() <= numNodes) {
+        levelNodes.insert(levelNodes.end(), currentLevel.begin(), currentLevel.end());
+        levelOffsets.push_back(levelNodes.size());
+
+        nextLevel.clear();
+        for (const auto nodeIndex : currentLevel) {
+            auto nodeChildren = children(nodeIndex);
+            nextLevel.insert(nextLevel.end(), nodeChildren.begin(), nodeChildren.end());
+        }
+        std::sort(nextLevel.begin(), nextLevel.end());
+        nextLevel.erase(std::unique(nextLevel.begin(), nextLevel.end()), nextLevel.end());
+        std::swap(currentLevel, nextLevel);
+    }
+}
+
+void TemporalTreeTopology::buildHeights() {
+    const size_t numNodes = isLeafNode.size();
+    heights.assign(numNodes, 0);
+
+    // A node is done once all its children are done, starting from the leaves
+    std::vector<size_t> numChildrenLeft(numNodes, 0);
+    std::vector<size_t> ready;
+    for (size_t nodeIndex(0); nodeIndex < numNodes; nodeIndex++) {
+        numChildrenLeft[nodeIndex] = children(nodeIndex).size();
+        if (numChildrenLeft[nodeIndex] == 0) ready.push_back(nodeIndex);
+    }
+
+    size_t maxHeight(0);
+    while (!ready.empty()) {
+        const size_t nodeIndex = ready.back();
+        ready.pop_back();
+        maxHeight = std::max(maxHeight, heights[nodeIndex]);
+        for (const auto parentIndex : parents(nodeIndex)) {
+            heights[parentIndex] = std::max(heights[parentIndex], heights[nodeIndex] + 1);
+            if (--numChildrenLeft[parentIndex] == 0) ready.push_back(parentIndex);
+        }
+    }
+
+    // Bucket the nodes by height, going by index keeps each bucket sorted
+    heightOffsets.assign(numNodes == 0 ? 1 : maxHeight + 2, 0);
+    for (size_t nodeIndex(0); nodeIndex < numNodes; nodeIndex++) {
+        heightOffsets[heights[nodeIndex] + 1]++;
+    }
+    for (size_t heightIndex(0); heightIndex + 1 < heightOffsets.size(); heightIndex++) {
+        heightOffsets[heightIndex + 1] += heightOffsets[heightIndex];
+    }
+    heightNodes.resize(numNodes);
+    std::vector<size_t> fill(heightOffsets.begin(), heightOffsets.end() - 1);
+    for (size_t nodeIndex(0); nodeIndex < numNodes; nodeIndex++) {
+        heightNodes[fill[heights[nodeIndex]]++] = nodeIndex;
+    }
+}
+
+void TemporalTreeTopology::buildTour() {
+    const size_t numNodes = isLeafNode.size();
+    tourEnterIndex.assign(numNodes, InvalidIndex);
+    tourExitIndex.assign(numNodes, InvalidIndex);
+    tourLeafBegin.assign(numNodes, 0);
+    tourLeafEnd.assign(numNodes, 0);
+    tourLeafIndices.clear();
+    subtreeExclusive.assign(numNodes, false);
+    if (numNodes == 0) return;
+
+    // Depth-first from the root, each node is entered through the first parent that reaches it
+    std::vector<std::pair<size_t, size_t>> stack;
+    size_t tourIndex(0);
+
+    auto enter = [&](const size_t nodeIndex) {
+        tourEnterIndex[nodeIndex] = tourIndex++;
+        tourLeafBegin[nodeIndex] = tourLeafIndices.size();
+        if (isLeafNode[nodeIndex]) tourLeafIndices.push_back(nodeIndex);
+        stack.emplace_back(nodeIndex, 0);
+    };
+
+    enter(0);
+    while (!stack.empty()) {
+        auto& top = stack.back();
+        const size_t nodeIndex = top.first;
+        auto nodeChildren = children(nodeIndex);
+
+        if (top.second < nodeChildren.size()) {
+            const size_t childIndex = nodeChildren[top.second++];
+            if (tourEnterIndex[childIndex] == InvalidIndex) enter(childIndex);
+            continue;
+        }
+
+        // All children are done
+        tourExitIndex[nodeIndex] = tourIndex;
+        tourLeafEnd[nodeIndex] = tourLeafIndices.size();
+        bool exclusive(true);
+        for (const auto childIndex : nodeChildren) {
+            if (parents(childIndex).size() != 1 || !subtreeExclusive[childIndex]) {
+                exclusive = false;
+                break;
+            }
+        }
+        subtreeExclusive[nodeIndex] = exclusive;
+        stack.pop_back();
+    }
+}
+
+TemporalTreeTopology::NodeRange TemporalTreeTopology::level(const size_t levelIndex) const {
+    if (levelIndex + 1 >= levelOffsets.size()) return NodeRange{};
+    const size_t* data = levelNodes.data();
+    return NodeRange{data + levelOffsets[levelIndex], data + levelOffsets[levelIndex + 1]};
+}
+
+TemporalTreeTopology::NodeRange TemporalTreeTopology::tourLeaves(const size_t nodeIndex) const {
+    if (tourEnterIndex[nodeIndex] == InvalidIndex) return NodeRange{};
+    const size_t* data = tourLeafIndices.data();
+    return NodeRange{data + tourLeafBegin[nodeIndex], data + tourLeafEnd[nodeIndex]};
+}
+
+void TemporalTreeTopology::getLeaves(const size_t nodeIndex, std::vector<size_t>& leaves) const {
+    leaves.clear();
+
+    // Fast path: the leaves of a subtree without shared nodes are one range in the tour
+    if (tourEnterIndex[nodeIndex] != InvalidIndex && subtreeExclusive[nodeIndex]) {
+        auto range = tourLeaves(nodeIndex);
+        leaves.assign(range.begin(), range.end());
+        std::sort(leaves.begin(), leaves.end());
+        return;
+    }
+
+    std::set<size_t> visited;
+    std::vector<size_t> stack{nodeIndex};
+    while (!stack.empty()) {
+        const size_t current = stack.back();
+        stack.pop_back();
+        if (!visited.insert(current).second) continue;
+
+        if (tourEnterIndex[current] != InvalidIndex && subtreeExclusive[current]) {
+            auto range = tourLeaves(current);
+            leaves.insert(leaves.end(), range.begin(), range.end());
+        } else {
+            auto currentChildren = children(current);
+            stack.insert(stack.end(), currentChildren.begin(), currentChildren.end());
+        }
+    }
+
+    std::sort(leaves.begin(), leaves.end());
+    leaves.erase(std::unique(leaves.begin(), leaves.end()), leaves.end());
+}
+
+void TemporalTreeTopology::getLeaves(const TemporalTree& tree, const size_t nodeIndex,
+                                     const uint64_t initialStartTime,
+                                     const uint64_t initialEndTime, uint64_t startTime,
+                                     uint64_t endTime, std::set<size_t>& leaves) const {
+    const auto& nodes = tree.nodes;
+    const TemporalTree::TNode& node = nodes[nodeIndex];
+
+    if (!TemporalTree::TNode::isOverlappingTemporally(startTime, endTime, node.startTime(),
+                                                      node.endTime())) {
+        return;
+    }
+
+    // Called on a leaf
+    if (isLeafNode[nodeIndex]) {
+        if (initialStartTime == initialEndTime ||
+            (initialStartTime != endTime && initialEndTime != startTime)) {
+            leaves.insert(nodeIndex);
+        }
+        return;
+    }
+
+    startTime = std::max(startTime, node.startTime());
+    endTime = std::min(endTime, node.endTime());
+
+    for (const auto childIndex : children(nodeIndex)) {
+        const TemporalTree::TNode& child = nodes[childIndex];
+        if (!TemporalTree::TNode::isOverlappingTemporally(startTime, endTime, child.startTime(),
+                                                          child.endTime())) {
+            continue;
+        }
+
+        if (isLeafNode[childIndex]) {
+            if (initialStartTime == initialEndTime ||
+                (initialStartTime != child.endTime() && initialEndTime != child.startTime())) {
+                leaves.insert(childIndex);
+            }
+        } else {
+            // Timeframe in which the child overlaps
+            const uint64_t startTimeChild = std::max(startTime, child.startTime());
+            const uint64_t endTimeChild = std::min(endTime, child.endTime());
+            getLeaves(tree, childIndex, startTimeChild, endTimeChild, startTimeChild,
+                      endTimeChild, leaves);
+        }
+    }
+}
+
+}  // namespace kth
+}  // namespace inviwo
@@ -0,0 +1,121 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 20:14:36
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#include <modules/temporaltreemaps/datastructures/treevaluecolumns.h>
+
+namespace inviwo {
+namespace kth {
+
+void TemporalTreeValueColumns::build(const TemporalTree& tree) {
+    timeAxis.clear();
+    for (const auto& node : tree.nodes) {
+        for (const auto& timeValuePair : node.values) {
+            timeAxis.push_back(timeValuePair.first);
+        }
+    }
+    std::sort(timeAxis.begin(), timeAxis.end());
+    timeAxis.erase(std::unique(timeAxis.begin(), timeAxis.end()), timeAxis.end());
+
+    buildColumns(tree);
+}
+
+void TemporalTreeValueColumns::build(const TemporalTree& tree, const std::set<uint64_t>& times) {
+    timeAxis.assign(times.begin(), times.end());
+    buildColumns(tree);
+}
+
+void TemporalTreeValueColumns::buildColumns(const TemporalTree& tree) {
+    const size_t numNodes = tree.nodes.size();
+    startIndices.assign(numNodes, InvalidIndex);
+    endIndices.assign(numNodes, InvalidIndex);
+    offsets.assign(numNodes, 0);
+
+    // Ranges first, so that all columns go into one buffer
+    size_t numValues(0);
+    for (size_t nodeIndex(0); nodeIndex < numNodes; nodeIndex++) {
+        const auto& node = tree.nodes[nodeIndex];
+        offsets[nodeIndex] = numValues;
+        if (node.values.empty()) continue;
+
+        const size_t startIdx = timeIndex(node.startTime());
+        const size_t endIdx = timeIndex(node.endTime());
+        ivwAssert(startIdx != InvalidIndex && endIdx != InvalidIndex,
+                  "Times of the node are not on the time axis.");
+        if (startIdx == InvalidIndex || endIdx == InvalidIndex) continue;
+
+        startIndices[nodeIndex] = startIdx;
+        endIndices[nodeIndex] = endIdx;
+        numValues += endIdx - startIdx + 1;
+    }
+
+    // Left neighbor interpolation, walk along the axis and the values of the node together
+    buffer.resize(numValues);
+    for (size_t nodeIndex(0); nodeIndex < numNodes; nodeIndex++) {
+        if (!hasValues(nodeIndex)) continue;
+
+        const auto& values = tree.nodes[nodeIndex].values;
+        float* nodeColumn = column(nodeIndex);
+        auto itValue = values.begin();
+        float currentValue = itValue->second;
+        for (size_t timeIdx = startIndices[nodeIndex]; timeIdx <= endIndices[nodeIndex];
+             timeIdx++) {
+            if (itValue != values.end() && itValue->first == timeAxis[timeIdx]) {
+                currentValue = itValue->second;
+                itValue++;
+            }
+            nodeColumn[timeIdx - startIndices[nodeIndex]] = currentValue;
+        }
+    }
+}
+
+size_t TemporalTreeValueColumns::timeIndex(const uint64_t time) const {
+    auto it = std::lower_bound(timeAxis.begin(), timeAxis.end(), time);
+    if (it == timeAxis.end() || *it != time) return InvalidIndex;
+    return size_t(it - timeAxis.begin());
+}
+
+float TemporalTreeValueColumns::getValueAt(const size_t nodeIndex, const uint64_t time) const {
+    if (!hasValues(nodeIndex)) return 0.0f;
+
+    // Last time on the axis that is not after the given one
+    auto it = std::upper_bound(timeAxis.begin(), timeAxis.end(), time);
+    if (it == timeAxis.begin()) return 0.0f;
+    const size_t timeIdx = size_t(it - timeAxis.begin()) - 1;
+
+    // After the end, only the end time itself has a value
+    if (timeIdx == endIndices[nodeIndex] && time != timeAxis[timeIdx]) return 0.0f;
+
+    return valueAtIndex(nodeIndex, timeIdx);
+}
+
+TemporalTree::TValueMap TemporalTreeValueColumns::getValueMap(const size_t nodeIndex) const {
+    TemporalTree::TValueMap values;
+    if (!hasValues(nodeIndex)) return values;
+
+    const float* nodeColumn = column(nodeIndex);
+    const size_t startIdx = startIndices[nodeIndex];
+    // The times are sorted, so every value goes to the end of the map
+    for (size_t timeIdx = startIdx; timeIdx <= endIndices[nodeIndex]; timeIdx++) {
+        values.emplace_hint(values.end(), timeAxis[timeIdx], nodeColumn[timeIdx - startIdx]);
+    }
+    return values;
+}
+
+void TemporalTreeValueColumns::writeTo(TemporalTree& tree) const {
+    ivwAssert(tree.nodes.size() == numNodes(), "Tree does not fit with the columns.");
+    const size_t numTreeNodes = std::min(tree.nodes.size(), numNodes());
+    for (size_t nodeIndex(0); nodeIndex < numTreeNodes; nodeIndex++) {
+        tree.nodes[nodeIndex].values = getValueMap(nodeIndex);
+    }
+    tree.touch();
+}
+
+}  // namespace kth
+}  // namespace inviwo
@@ -56,7 +56,7 @@ void TemporalTreeAccumulate::process()
     }
     // Actual accumulation of the values
     // each node now holds values for each global timestep
-    // TODO: Make use of reverse if those has been computed
+    // (bottom-up, nodes of the same height in parallel)
     treeOut->computeAccumulated();
 
     // Set output
@@ -178,6 +178,15 @@ void TemporalTreeColoring::process() {
 
     std::shared_ptr<TemporalTree> pOutTree = std::make_shared<TemporalTree>(TemporalTree(*pInTree));
 
+    TemporalTreeLayoutResult& layout = pOutTree->layout;
+    if (!layout.fitsWithTree(*pOutTree)) {
+        LogProcessorError("The tree does not have a layout.");
+        return;
+    }
+
+    // Colors are computed from scratch
+    layout.clearColors();
+
     auto leaves = pOutTree->getLeaves();
 
     std::vector<dvec4> colorMap;
@@ -325,32 +334,31 @@ void TemporalTreeColoring::process() {
     size_t leafCounter(0);
 
     for (auto leaf : leaves) {
-        TemporalTree::TNode& leafNode = pOutTree->nodes[leaf];
-        TemporalTree::TColorPerTimeMap& colors = leafNode.colors;
-        colors.clear();
+        const TemporalTree::TNode& leafNode = pOutTree->nodes[leaf];
+        if (!layout.hasLimits(leaf)) {
+            leafCounter++;
+            continue;
+        }
 
-        const auto& lowerLimitLeaf = leafNode.lowerLimit;
-        const auto& upperLimitLeaf = leafNode.upperLimit;
+        const size_t startIdxLeaf = layout.startIndex(leaf);
+        const size_t endIdxLeaf = layout.endIndex(leaf);
+        for (size_t timeIdx = startIdxLeaf; timeIdx <= endIdxLeaf; timeIdx++) {
+            if (!layout.isSet(leaf, timeIdx)) continue;
 
-        for (auto itLowerLimit = lowerLimitLeaf.begin(), itUpperLimit = upperLimitLeaf.begin();
-             itLowerLimit != lowerLimitLeaf.end() && itUpperLimit != upperLimitLeaf.end();
-             itLowerLimit++, itUpperLimit++) {
+            const TemporalTreeLayoutResult::TBandLimits& limits = layout.limits(leaf, timeIdx);
+            vec4& color = layout.setColor(leaf, timeIdx);
             switch (propColorScheme.get()) {
                 case 0:
                     // There already exists a color, we only need to expand and handle fading
-                    colors.emplace_hint(colors.end(), itLowerLimit->first,
-                                        vec4(leafNode.color, 1.0f));
+                    color = vec4(leafNode.color, 1.0f);
                     break;
                 case 1:
-                    colors.emplace_hint(colors.end(), itLowerLimit->first, propColorUniform.get());
+                    color = propColorUniform.get();
                     break;
                 case 2:
-                    colors.emplace_hint(
-                        colors.end(), itLowerLimit->first,
-                        propValueTranserFunc.get().sample(
-                            itLowerLimit == lowerLimitLeaf.begin()
-                                ? itUpperLimit->second.second - itLowerLimit->second.second
-                                : itUpperLimit->second.first - itLowerLimit->second.first));
+                    color = propValueTranserFunc.get().sample(
+                        timeIdx == startIdxLeaf ? limits.upper.second - limits.lower.second
+                                                : limits.upper.first - limits.lower.first);
                     break;
                 case 3:
                     // Make sure colors stay the same even if the order changes
@@ -358,15 +366,13 @@ void TemporalTreeColoring::process() {
                     // order)
                     randomGen.seed(
                         static_cast<std::mt19937::result_type>(leaf + propColorSeed.get()));
-                    colors.emplace_hint(
-                        colors.end(), itLowerLimit->first,
-                        vec4(rand(0.0f, 1.0f), rand(0.0f, 1.0f), rand(0.0f, 1.0f), 1.0f));
+                    color = vec4(rand(0.0f, 1.0f), rand(0.0f, 1.0f), rand(0.0f, 1.0f), 1.0f);
                     break;
                 case 4:
-                    colors.emplace_hint(colors.end(), itLowerLimit->first, colorMap[leafCounter]);
+                    color = vec4(colorMap[leafCounter]);
+                    break;
                 default:
-                    colors.emplace_hint(colors.end(), itLowerLimit->first,
-                                        vec4(0.0f, 0.0f, 0.0f, 1.0f));
+                    color = vec4(0.0f, 0.0f, 0.0f, 1.0f);
                     break;
             }
         }
@@ -58,32 +58,114 @@ void TemporalTreeCushionComputation::process() {
     propCushionTo.setMaxValue(levels);
     propCushionFrom.setMaxValue(levels);
 
-    std::set<uint64_t> times = pOutTree->getTimes();
-    uint64_t tMin = *times.begin();
-    uint64_t tMax = *times.rbegin();
+    TemporalTreeLayoutResult& layout = pOutTree->layout;
+    if (!layout.fitsWithTree(*pOutTree) || layout.numTimes() == 0) {
+        LogProcessorError("The tree does not have a layout.");
+        return;
+    }
+
+    if (layout.firstIndex(0) == TemporalTreeLayoutResult::InvalidIndex) {
+        LogProcessorError("The root does not have any values.");
+        return;
+    }
+
+    if (canUpdateLastCushions(*pOutTree)) {
+        // Only some limits changed, update the cushions of these nodes and their descendants
+        layout.shareCushions(pLastOutTree->layout);
+        const std::vector<bool> nodesToUpdate = findNodesToUpdate(*pOutTree);
+
+        // Visit the flagged nodes and all their ancestors
+        std::vector<bool> nodesToVisit(nodesToUpdate);
+        std::vector<size_t> nodesToCheck;
+        for (size_t nodeIndex(0); nodeIndex < nodesToUpdate.size(); nodeIndex++) {
+            if (!nodesToUpdate[nodeIndex]) continue;
+            layout.clearCushions(nodeIndex);
+            nodesToCheck.push_back(nodeIndex);
+        }
+        while (!nodesToCheck.empty()) {
+            const size_t nodeIndex = nodesToCheck.back();
+            nodesToCheck.pop_back();
+            for (auto parent : pOutTree->getHierarchicalParentsWithReverse(nodeIndex)) {
+                if (nodesToVisit[parent]) continue;
+                nodesToVisit[parent] = true;
+                nodesToCheck.push_back(parent);
+            }
+        }
 
-    TemporalTree::TCushionMap& rootCushion = pOutTree->nodes[0].cushion;
+        if (nodesToUpdate[0]) {
+            for (size_t timeIdx = layout.firstIndex(0); timeIdx <= layout.lastIndex(0);
+                 timeIdx++) {
+                layout.setCushion(0, timeIdx) = std::make_pair(vec3(0), vec3(0));
+            }
+        }
 
-    for (auto time : times) {
-        rootCushion.insert({time, {vec3(0), vec3(0)}});
+        if (nodesToVisit[0]) {
+            traverseToLeavesForCushions(*pOutTree, 0, 0, layout.numTimes() - 1, 0,
+                                        nodesToUpdate, nodesToVisit);
+        }
+    } else {
+        // Cushions are computed from scratch, the root starts flat
+        layout.clearCushions();
+        for (size_t timeIdx = layout.firstIndex(0); timeIdx <= layout.lastIndex(0); timeIdx++) {
+            layout.setCushion(0, timeIdx) = std::make_pair(vec3(0), vec3(0));
+        }
+
+        traverseToLeavesForCushions(*pOutTree, 0, 0, layout.numTimes() - 1, 0, {}, {});
     }
 
-    traverseToLeavesForCushions(*pOutTree, 0, tMin, tMax, 0);
+    pLastOutTree = pOutTree;
+    lastBaseHeight = propCushionBaseHeight.get();
+    lastScaleFactor = propCushionScaleFactor.get();
+    lastFrom = propCushionFrom.get();
+    lastTo = propCushionTo.get();
 
     portOutTree.setData(pOutTree);
 }
 
-void TemporalTreeCushionComputation::traverseToLeavesForCushions(TemporalTree& tree,
-                                                                 size_t nodeIndex,
-                                                                 uint64_t startTime,
-                                                                 uint64_t endTime, uint8_t depth) {
+bool TemporalTreeCushionComputation::canUpdateLastCushions(const TemporalTree& tree) const {
+    if (!pLastOutTree || !tree.layout.isUpdateOf(pLastOutTree->layout)) return false;
+
+    // Same parameters and hierarchy
+    return lastBaseHeight == propCushionBaseHeight.get() &&
+           lastScaleFactor == propCushionScaleFactor.get() && lastFrom == propCushionFrom.get() &&
+           lastTo == propCushionTo.get() && pLastOutTree->layout.fitsWithTree(tree) &&
+           pLastOutTree->edgesHierarchy == tree.edgesHierarchy;
+}
+
+std::vector<bool> TemporalTreeCushionComputation::findNodesToUpdate(
+    const TemporalTree& tree) const {
+    // The cushion of a node adds up the cushions of all its ancestors
+    std::vector<bool> nodesToUpdate(tree.nodes.size(), false);
+    std::vector<size_t> nodesToCheck;
+    for (auto nodeIndex : tree.layout.getChangedNodes()) {
+        if (nodesToUpdate[nodeIndex]) continue;
+        nodesToUpdate[nodeIndex] = true;
+        nodesToCheck.push_back(nodeIndex);
+    }
+    while (!nodesToCheck.empty()) {
+        const size_t nodeIndex = nodesToCheck.back();
+        nodesToCheck.pop_back();
+        for (auto child : tree.getHierarchicalChildren(nodeIndex)) {
+            if (nodesToUpdate[child]) continue;
+            nodesToUpdate[child] = true;
+            nodesToCheck.push_back(child);
+        }
+    }
+    return nodesToUpdate;
+}
+
+void TemporalTreeCushionComputation::traverseToLeavesForCushions(
+    TemporalTree& tree, size_t nodeIndex, size_t startIdx, size_t endIdx, uint8_t depth,
+    const std::vector<bool>& nodesToUpdate, const std::vector<bool>& nodesToVisit) {
+    // Nothing below this node changed
+    const bool updateAll = nodesToUpdate.empty();
+    if (!updateAll && !nodesToVisit[nodeIndex]) return;
+
     // Shorthands
-    TemporalTree::TNode& node = tree.nodes[nodeIndex];
-    auto& cushion = node.cushion;
-    auto& lowerLimit = node.lowerLimit;
-    auto& upperLimit = node.upperLimit;
+    TemporalTreeLayoutResult& layout = tree.layout;
+    const std::vector<uint64_t>& times = layout.times();
 
-    if (lowerLimit.empty() || upperLimit.empty()) {
+    if (!layout.hasLimits(nodeIndex)) {
         LogProcessorError("Skipping node"
                           << nodeIndex
                           << " and all of its children because it has no limit information");
@@ -92,36 +174,37 @@ void TemporalTreeCushionComputation::traverseToLeavesForCushions(TemporalTree& t
 
     // A parent might have 0 values that extend over the time of all its children
     // but we will have no limit information for these
-    startTime = std::max(startTime, lowerLimit.begin()->first);
-    endTime = std::min(endTime, lowerLimit.rbegin()->first);
+    startIdx = std::max(startIdx, layout.startIndex(nodeIndex));
+    endIdx = std::min(endIdx, layout.endIndex(nodeIndex));
 
     // Exclude the root and stop spanning cushions
-    if (depth >= propCushionFrom.get() &&
+    if ((updateAll || nodesToUpdate[nodeIndex]) && depth >= propCushionFrom.get() &&
         (propCushionTo.get() == -1 || depth <= propCushionTo.get())) {
         // Span cushions for this node over only the time frame that we want here
-        auto itLowerEnd = std::next(lowerLimit.find(endTime));
-        auto itUpperEnd = std::next(upperLimit.find(endTime));
-        for (auto itLowerLimit = lowerLimit.find(startTime),
-                  itUpperLimit = upperLimit.find(startTime);
-             itLowerLimit != itLowerEnd && itUpperLimit != itUpperEnd;
-             itLowerLimit++, itUpperLimit++) {
-            vec3 first = cushion::makeCushion(
-                itLowerLimit->second.first, itUpperLimit->second.first, propCushionBaseHeight.get(),
-                propCushionScaleFactor.get(), uint8_t(depth - propCushionFrom));
-            vec3 second =
-                cushion::makeCushion(itLowerLimit->second.second, itUpperLimit->second.second,
-                                     propCushionBaseHeight.get(), propCushionScaleFactor.get(),
-                                     uint8_t(depth - propCushionFrom));
-            auto inserted = cushion.emplace(itLowerLimit->first, std::make_pair(first, second));
-            if (!inserted.second) {
-                // inserted.first is the iterator in the map to where we tried to inserted,
-                // but there was already an element there -> second is the pair of cushions and
-                // first is the first one of those We overwrite the element
-                if (itLowerLimit->first != startTime) {
-                    inserted.first->second.first += first;
+        for (size_t timeIdx = startIdx; timeIdx <= endIdx; timeIdx++) {
+            if (!layout.isSet(nodeIndex, timeIdx)) continue;
+
+            const TemporalTreeLayoutResult::TBandLimits& limits =
+                layout.limits(nodeIndex, timeIdx);
+            vec3 first = cushion::makeCushion(limits.lower.first, limits.upper.first,
+                                              propCushionBaseHeight.get(),
+                                              propCushionScaleFactor.get(),
+                                              uint8_t(depth - propCushionFrom));
+            vec3 second = cushion::makeCushion(limits.lower.second, limits.upper.second,
+                                               propCushionBaseHeight.get(),
+                                               propCushionScaleFactor.get(),
+                                               uint8_t(depth - propCushionFrom));
+            if (!layout.hasCushion(nodeIndex, timeIdx)) {
+                layout.setCushion(nodeIndex, timeIdx) = std::make_pair(first, second);
+            } else {
+                // There is a cushion from the parent already, we add ours to it
+                TemporalTreeLayoutResult::TCushion& nodeCushion =
+                    layout.cushion(nodeIndex, timeIdx);
+                if (timeIdx != startIdx) {
+                    nodeCushion.first += first;
                 }
-                if (itLowerLimit->first != endTime) {
-                    inserted.first->second.second += second;
+                if (timeIdx != endIdx) {
+                    nodeCushion.second += second;
                 }
             }
         }
@@ -129,41 +212,43 @@ void TemporalTreeCushionComputation::traverseToLeavesForCushions(TemporalTree& t
 
     // Go to all children
     for (auto& child : tree.getHierarchicalChildren(nodeIndex)) {
-        TemporalTree::TNode& childNode = tree.nodes[child];
+        const TemporalTree::TNode& childNode = tree.nodes[child];
         // Find the time range for which this is the child
 
-        if (!TemporalTree::TNode::isOverlappingTemporally(startTime, endTime, childNode.startTime(),
+        if (!TemporalTree::TNode::isOverlappingTemporally(times[startIdx], times[endIdx],
+                                                          childNode.startTime(),
                                                           childNode.endTime())) {
             continue;
         }
 
-        uint64_t startTimeChild = std::max(startTime, childNode.startTime());
-        uint64_t endTimeChild = std::min(endTime, childNode.endTime());
-
-        auto& cushionChild = childNode.cushion;
+        const size_t startIdxChild = std::max(startIdx, layout.firstIndex(child));
+        const size_t endIdxChild = std::min(endIdx, layout.lastIndex(child));
 
         // Initialize cushions of the child (Overlap - i.e. already inserted should only happen at
         // the beginning and end)
-        auto itParent = cushion.find(startTimeChild);
-        auto itEnd = std::next(cushion.find(endTimeChild));
-        for (; itParent != itEnd; itParent++) {
-            auto inserted = cushionChild.emplace(itParent->first, itParent->second);
-            if (!inserted.second) {
-                // inserted.first is the iterator in the map to where we tried to inserted,
-                // but there was already an element there -> second is the pair of cushions and
-                // first is the first one of those We only want to change the element that we are
-                // concerned with
-                if (itParent->first != startTimeChild) {
-                    inserted.first->second.first = itParent->second.first;
+        const bool updateChild = updateAll || nodesToUpdate[child];
+        for (size_t timeIdx = startIdxChild; updateChild && timeIdx <= endIdxChild; timeIdx++) {
+            if (!layout.hasCushion(nodeIndex, timeIdx)) continue;
+
+            const TemporalTreeLayoutResult::TCushion parentCushion =
+                layout.cushion(nodeIndex, timeIdx);
+            if (!layout.hasCushion(child, timeIdx)) {
+                layout.setCushion(child, timeIdx) = parentCushion;
+            } else {
+                // We only want to change the side that we are concerned with
+                TemporalTreeLayoutResult::TCushion& childCushion = layout.cushion(child, timeIdx);
+                if (timeIdx != startIdxChild) {
+                    childCushion.first = parentCushion.first;
                 }
-                if (itParent->first != endTimeChild) {
-                    inserted.first->second.second = itParent->second.second;
+                if (timeIdx != endIdxChild) {
+                    childCushion.second = parentCushion.second;
                 }
             }
         }
 
         // traverse further until we have reached a leaf
-        traverseToLeavesForCushions(tree, child, startTimeChild, endTimeChild, depth + 1);
+        traverseToLeavesForCushions(tree, child, startIdxChild, endIdxChild, depth + 1,
+                                    nodesToUpdate, nodesToVisit);
     }
 }
 
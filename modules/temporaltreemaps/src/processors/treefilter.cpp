@@ -269,6 +269,9 @@ void TemporalTreeFilter::fadeLeaves(std::shared_ptr<TemporalTree>& tree) {
             }
         }
     }
+
+    // We have added values directly
+    tree->touch();
 }
 
 void TemporalTreeFilter::filterLeaves(std::shared_ptr<TemporalTree>& tree) {
@@ -346,6 +349,9 @@ void TemporalTreeFilter::filterLeaves(std::shared_ptr<TemporalTree>& tree) {
         nodeIndex++;
     }
 
+    // Values have been trimmed to the time span even if no node is removed
+    tree->touch();
+
     if (removeNodes.empty()) {
         return;
     }
@@ -426,6 +432,7 @@ void TemporalTreeFilter::filterLeaves(std::shared_ptr<TemporalTree>& tree) {
     tree->nodes[0].values.clear();
     tree->nodes[0].values[propStartLifespan] = 0.0;
     tree->nodes[0].values[propEndLifespan] = 0.0;
+    tree->touch();
 
     // Maybe we now have new leaves that need to be filtered
     if (filtered) {
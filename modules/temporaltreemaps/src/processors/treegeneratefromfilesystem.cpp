@@ -87,7 +87,7 @@ void ScanRecursively(const fs::path& ScanDir, const size_t idParent, const int L
         // is to scan its content recursively.
         // But we do this without creating a tree below this item.
         // Hence, this item (idParent) becomes a leaf.
-        RecordHistoricalSizes(ScanDir, OutTree.nodes[idParent].values);
+        RecordHistoricalSizes(ScanDir, OutTree.nodes[idParent].values.get());
 
         // It may happen that the entire subtree is empty, i.e., no file with > 0 Bytes.
         // if (OutTree.nodes[idParent].values.empty())
@@ -478,6 +478,7 @@ std::shared_ptr<TemporalTree> TemporalTreeGenerateFromTrackingGraph::CreateOrReu
         pOutTree->nodes.clear();
         pOutTree->edgesHierarchy.clear();
         pOutTree->edgesTime.clear();
+        pOutTree->touch();
     }
 
     return pOutTree;
@@ -35,6 +35,8 @@ TemporalTreeLayoutComputation::TemporalTreeLayoutComputation()
     , propSpaceFilling("spaceFilling", "Space Filling (Normalize Timestepwise)", true)
     , propMaximum("setMax", "Manual Maximum", 0, 0)
     , propActualMaximum("actualMax", "Maximum", "")
+    , propParallel("parallel", "Parallel Layout", true)
+    , propIncremental("incremental", "Incremental Layout", true)
     , propRenderInfo("renderInfo", "Render Info")
     , propUnixTime("unixTime", "Unix Time", false)
     , propTimeMinMax("timeMinxMax", "Time", 0, std::numeric_limits<float>::max())
@@ -58,6 +60,9 @@ TemporalTreeLayoutComputation::TemporalTreeLayoutComputation()
 
     propActualMaximum.setReadOnly(true);
 
+    addProperty(propParallel);
+    addProperty(propIncremental);
+
     addProperty(propRenderInfo);
     propRenderInfo.addProperty(propUnixTime);
     propRenderInfo.addProperty(propTimeMinMax);
@@ -83,10 +88,8 @@ void TemporalTreeLayoutComputation::process() {
     std::set<uint64_t> times = pOutTree->getTimes();
     mapForNormalization = pOutTree->computeAccumulatedRootOnly(times);
 
-    TemporalTree::TDrawingLimitMap upperLimitCurrent;
     float maxValue = std::numeric_limits<float>::min();
     for (auto timeValuePair : mapForNormalization) {
-        upperLimitCurrent.emplace(timeValuePair.first, std::make_pair(0.0f, 0.0f));
         if (timeValuePair.second > maxValue) {
             maxValue = timeValuePair.second;
         }
@@ -126,133 +129,333 @@ void TemporalTreeLayoutComputation::process() {
         pOutTree->computeReverseEdges();
     }
 
-    for (auto leaf : order) {
-        TemporalTree::TNode& leafNode = pOutTree->nodes[leaf];
-        // Shorthand for the values for this band (expand these as well)
-        std::map<uint64_t, float>& expandedValues = leafNode.values;
-        TemporalTree::TNode::fillWithLeftNeighborInterpolation(times, expandedValues);
+    // Values of all nodes on the times of the tree with left neighbor interpolation
+    TemporalTreeValueColumns columns;
+    columns.build(*pOutTree, times);
+
+    // Leaf values are divided by the value of the root or the maximum at each time.
+    // Dividing by infinity gives 0 where the root has no value.
+    std::vector<float> divisors(columns.numTimes(), propMaximum.get());
+    if (propSpaceFilling) {
+        std::fill(divisors.begin(), divisors.end(), std::numeric_limits<float>::infinity());
+        for (auto timeValuePair : mapForNormalization) {
+            const size_t timeIdx = columns.timeIndex(timeValuePair.first);
+            if (timeIdx != TemporalTreeValueColumns::InvalidIndex && timeValuePair.second != 0.0f) {
+                divisors[timeIdx] = timeValuePair.second;
+            }
+        }
+    }
 
-        uint64_t tMinLeaf = leafNode.startTime();
-        uint64_t tMaxLeaf = leafNode.endTime();
+    const TemporalTreeTopology topology(*pOutTree);
 
-        // Set the lower limit for the leaf
-        copyLimitInBetween(upperLimitCurrent, leafNode.lowerLimit, tMinLeaf, tMaxLeaf);
+    TemporalTreeLayoutResult& layout = pOutTree->layout;
+    if (canUpdateLastLayout(*pOutTree, columns)) {
+        // Only the order or the values changed, update the limits of the last run.
+        // Cushions and colors of the last output belong to the old limits.
+        layout.adoptLimits(pLastOutTree->layout);
+        updateLimits(*pOutTree, topology, columns, divisors);
+    } else {
+        // Drawing information is computed from scratch
+        layout.reset(*pOutTree);
 
-        // Add the values for this node
-        updateUpper(upperLimitCurrent, expandedValues, mapForNormalization);
+        const size_t numBlocks = (columns.numTimes() + TimeBlockSize - 1) / TimeBlockSize;
+        computeLeafLimits(order, columns, divisors, std::vector<size_t>(numBlocks, 0), layout);
 
-        // Set the upper limit for the leaf
-        copyLimitInBetween(upperLimitCurrent, leafNode.upperLimit, tMinLeaf, tMaxLeaf);
+        for (auto leaf : order) {
+            if (!columns.hasValues(leaf)) {
+                LogProcessorError("Leaf " << leaf << " does not have any values.");
+            }
+        }
+
+        // Gather the limits of the leaves in all ancestors
+        computeParentLimits(*pOutTree, topology, {});
 
-        // Push this information to all ancestors
-        traverseToRootForLimits(*pOutTree, leaf, tMinLeaf, tMaxLeaf);
+        layout.markLimitsComputed();
     }
 
+    pLastOutTree = pOutTree;
+    lastColumns = std::move(columns);
+    lastDivisors = std::move(divisors);
+
     portOutTree.setData(pOutTree);
 }
 
-float TemporalTreeLayoutComputation::normalValue(TemporalTree::TValueMap mapForNormalization,
-                                                 uint64_t time, float value) const {
-    auto itNormalizeBy = mapForNormalization.find(time);
-    if (itNormalizeBy != mapForNormalization.end() && itNormalizeBy->second != 0.0f) {
-        return value / itNormalizeBy->second;
+void TemporalTreeLayoutComputation::computeLeafLimits(
+    const TemporalTree::TTreeOrder& order, const TemporalTreeValueColumns& columns,
+    const std::vector<float>& divisors, const std::vector<size_t>& firstDirtyPositions,
+    TemporalTreeLayoutResult& layout) {
+    const size_t numTimes = columns.numTimes();
+    const int numBlocks = int(firstDirtyPositions.size());
+
+    // Mark the limits of all leaves to be written as set, the layout may only be written to
+    // through these pointers from here on
+    std::vector<TemporalTreeLayoutResult::TBandLimits*> leafLimits(order.size(), nullptr);
+    for (size_t position(0); position < order.size(); position++) {
+        const size_t leaf = order[position];
+        if (!columns.hasValues(leaf)) continue;
+
+        const size_t startIdx = columns.startIndex(leaf);
+        const size_t endIdx = columns.endIndex(leaf);
+        for (size_t block = startIdx / TimeBlockSize; block <= endIdx / TimeBlockSize; block++) {
+            if (firstDirtyPositions[block] <= position) {
+                leafLimits[position] = layout.setLimits(leaf, startIdx, endIdx);
+                break;
+            }
+        }
     }
-    return 0.0f;
-}
 
-void TemporalTreeLayoutComputation::updateUpper(TemporalTree::TDrawingLimitMap& upperLimitCurrent,
-                                                TemporalTree::TValueMap& values,
-                                                TemporalTree::TValueMap& mapForNormalization) {
-    auto itUpper = upperLimitCurrent.find(values.begin()->first);
-    ;
-    for (auto itAdd = values.begin(); itAdd != values.end(); itAdd++, itUpper++) {
-        if (itUpper->first != itAdd->first) {
-            LogProcessorInfo("Times do not line up");
-        }
-        // Unless we are at the very beginning of the values to be added, update the limit from the
-        // left itUsed->second is the pair with (left limit, right limit) for each timestep
-        if (itAdd->first != values.begin()->first) {
-            itUpper->second.first +=
-                propSpaceFilling ? normalValue(mapForNormalization, itAdd->first, itAdd->second)
-                                 : itAdd->second / propMaximum;
+#pragma omp parallel for schedule(dynamic, 1) if (propParallel.get())
+    for (int block = 0; block < numBlocks; block++) {
+        const size_t firstDirtyPosition = firstDirtyPositions[block];
+        if (firstDirtyPosition >= order.size()) continue;
+
+        const size_t blockStart = size_t(block) * TimeBlockSize;
+        const size_t blockEnd = std::min(blockStart + TimeBlockSize, numTimes);
+
+        // Sum of all bands so far, left and right of each time in the block
+        std::vector<float> upperLeft(blockEnd - blockStart, 0.0f);
+        std::vector<float> upperRight(blockEnd - blockStart, 0.0f);
+
+        for (size_t position(0); position < order.size(); position++) {
+            const size_t leaf = order[position];
+            if (!columns.hasValues(leaf)) continue;
+
+            const size_t startIdx = columns.startIndex(leaf);
+            const size_t endIdx = columns.endIndex(leaf);
+            if (endIdx < blockStart || startIdx >= blockEnd) continue;
+
+            // Limits before the first dirty position are still valid, only sum up their values
+            const bool isDirty = position >= firstDirtyPosition;
+
+            // Offsets of the first time of this block in the leaf and in the block
+            const size_t first = std::max(startIdx, blockStart);
+            const size_t last = std::min(endIdx + 1, blockEnd);
+            const float* values = columns.column(leaf) + (first - startIdx);
+            const float* divisorsLeaf = divisors.data() + first;
+            TemporalTreeLayoutResult::TBandLimits* limitsLeaf =
+                isDirty ? leafLimits[position] + (first - startIdx) : nullptr;
+            float* left = upperLeft.data() + (first - blockStart);
+            float* right = upperRight.data() + (first - blockStart);
+
+            // Lower limits are the sums so far
+            const size_t numValues = last - first;
+            if (isDirty) {
+                for (size_t i = 0; i < numValues; i++) {
+                    limitsLeaf[i].lower = std::make_pair(left[i], right[i]);
+                }
+            }
+
+            // The band starts and ends in a single point, inner times get the value on both
+            // sides. These loops have no branches so that they vectorize.
+            const bool hasStart = first == startIdx;
+            const bool hasEnd = last == endIdx + 1;
+            const size_t innerFirst = hasStart ? 1 : 0;
+            const size_t innerLast = hasEnd ? numValues - 1 : numValues;
+            for (size_t i = innerFirst; i < innerLast; i++) {
+                const float value = values[i] / divisorsLeaf[i];
+                left[i] += value;
+                right[i] += value;
+            }
+            if (startIdx != endIdx) {
+                const size_t i = numValues - 1;
+                if (hasStart) right[0] += values[0] / divisorsLeaf[0];
+                if (hasEnd) left[i] += values[i] / divisorsLeaf[i];
+            }
+
+            if (isDirty) {
+                for (size_t i = 0; i < numValues; i++) {
+                    limitsLeaf[i].upper = std::make_pair(left[i], right[i]);
+                }
+            }
         }
-        // Unless we are at the very end of the values to be added, update the limit from the right
-        if (std::next(itAdd) != values.end()) {
-            itUpper->second.second +=
-                propSpaceFilling ? normalValue(mapForNormalization, itAdd->first, itAdd->second)
-                                 : itAdd->second / propMaximum;
+    }
+}
+
+bool TemporalTreeLayoutComputation::canUpdateLastLayout(
+    const TemporalTree& tree, const TemporalTreeValueColumns& columns) const {
+    if (!propIncremental || !pLastOutTree) return false;
+
+    // Same nodes, hierarchy and times
+    if (pLastOutTree->nodes.size() != tree.nodes.size() ||
+        pLastOutTree->order.size() != tree.order.size() ||
+        pLastOutTree->edgesHierarchy != tree.edgesHierarchy ||
+        !pLastOutTree->layout.fitsWithTree(tree) || lastColumns.times() != columns.times()) {
+        return false;
+    }
+
+    // The limits of a node keep their place as long as its lifetime stays the same
+    for (size_t nodeIndex(0); nodeIndex < tree.nodes.size(); nodeIndex++) {
+        if (lastColumns.startIndex(nodeIndex) != columns.startIndex(nodeIndex) ||
+            lastColumns.endIndex(nodeIndex) != columns.endIndex(nodeIndex)) {
+            return false;
         }
     }
+
+    return true;
 }
 
-void TemporalTreeLayoutComputation::traverseToRootForLimits(TemporalTree& tree, size_t nodeIndex,
-                                                            uint64_t startTime, uint64_t endTime) {
-    TemporalTree::TNode& node = tree.nodes[nodeIndex];
-    auto& lowerLimit = node.lowerLimit;
-    auto& upperLimit = node.upperLimit;
-
-    // Go to all parents
-    for (auto& parent : tree.getHierarchicalParentsWithReverse(nodeIndex)) {
-        TemporalTree::TNode& parentNode = tree.nodes[parent];
-        // Find the time range for which this is the parent
-        if (!TemporalTree::TNode::isOverlappingTemporally(
-                startTime, endTime, parentNode.startTime(), parentNode.endTime())) {
-            continue;
+std::vector<size_t> TemporalTreeLayoutComputation::findDirtyPositions(
+    const TemporalTree::TTreeOrder& order, const TemporalTreeValueColumns& columns,
+    const std::vector<float>& divisors) const {
+    const size_t numBlocks = (columns.numTimes() + TimeBlockSize - 1) / TimeBlockSize;
+    std::vector<size_t> firstDirtyPositions(numBlocks, order.size());
+    auto markDirty = [&](const size_t block, const size_t position) {
+        firstDirtyPositions[block] = std::min(firstDirtyPositions[block], position);
+    };
+
+    // A different normalization changes all leaves at that time
+    for (size_t timeIdx(0); timeIdx < divisors.size(); timeIdx++) {
+        if (divisors[timeIdx] != lastDivisors[timeIdx]) markDirty(timeIdx / TimeBlockSize, 0);
+    }
+
+    // Moved leaves change the limits of all leaves from the first moved one on
+    const TemporalTree::TTreeOrder& lastOrder = pLastOutTree->order;
+    size_t firstMoved(0);
+    while (firstMoved < order.size() && order[firstMoved] == lastOrder[firstMoved]) firstMoved++;
+    size_t lastMoved(order.size());
+    while (lastMoved > firstMoved && order[lastMoved - 1] == lastOrder[lastMoved - 1]) lastMoved--;
+
+    for (size_t position = firstMoved; position < lastMoved; position++) {
+        const size_t leaf = order[position];
+        if (!columns.hasValues(leaf)) continue;
+
+        for (size_t block = columns.startIndex(leaf) / TimeBlockSize;
+             block <= columns.endIndex(leaf) / TimeBlockSize; block++) {
+            markDirty(block, firstMoved);
         }
+    }
 
-        uint64_t startTimeParent = std::max(startTime, parentNode.startTime());
-        uint64_t endTimeParent = std::min(endTime, parentNode.endTime());
-
-        auto& lowerLimitParent = parentNode.lowerLimit;
-        auto& upperLimitParent = parentNode.upperLimit;
-
-        // Update the lower limit of the parent
-        // Lower limit really should only be set once, therefore we insert
-        lowerLimitParent.insert(lowerLimit.find(startTimeParent),
-                                std::next(lowerLimit.find(endTimeParent)));
-        // End and begin could be set by different children (i.e. already exist in the map), so we
-        // need to treat his here
-        lowerLimitParent[startTimeParent].second =
-            std::min(lowerLimitParent[startTimeParent].second, lowerLimit[startTimeParent].second);
-        lowerLimitParent[endTimeParent].first =
-            std::min(lowerLimitParent[endTimeParent].first, lowerLimit[endTimeParent].first);
-
-        // Update the higher limit of the parent (as we lay bands on top of each other, we can
-        // always replace) Skip the first and the last values
-        auto itEnd = upperLimit.find(endTimeParent);
-        for (auto itUpper = upperLimit.find(startTimeParent); itUpper != itEnd; itUpper++) {
-            if (itUpper->first == startTimeParent) {
-                continue;
+    // Changed values change the limits of the leaf and all following leaves
+    for (size_t position(0); position < order.size(); position++) {
+        const size_t leaf = order[position];
+        if (!columns.hasValues(leaf)) continue;
+
+        const float* values = columns.column(leaf);
+        const float* lastValues = lastColumns.column(leaf);
+        const size_t startIdx = columns.startIndex(leaf);
+        for (size_t timeIdx = startIdx; timeIdx <= columns.endIndex(leaf); timeIdx++) {
+            if (values[timeIdx - startIdx] != lastValues[timeIdx - startIdx]) {
+                markDirty(timeIdx / TimeBlockSize, position);
             }
-            upperLimitParent.insert_or_assign(itUpper->first, itUpper->second);
         }
+    }
 
-        auto it = upperLimitParent.find(startTimeParent);
-        if (it != upperLimitParent.end()) {
-            it->second.second = std::max(it->second.second, upperLimit[startTimeParent].second);
-        } else {
-            upperLimitParent.emplace(startTimeParent, upperLimit[startTimeParent]);
+    return firstDirtyPositions;
+}
+
+void TemporalTreeLayoutComputation::updateLimits(TemporalTree& tree,
+                                                 const TemporalTreeTopology& topology,
+                                                 const TemporalTreeValueColumns& columns,
+                                                 const std::vector<float>& divisors) {
+    const TemporalTree::TTreeOrder& order = tree.order;
+    const TemporalTreeLayoutResult& lastLayout = pLastOutTree->layout;
+    TemporalTreeLayoutResult& layout = tree.layout;
+
+    const std::vector<size_t> firstDirtyPositions = findDirtyPositions(order, columns, divisors);
+    computeLeafLimits(order, columns, divisors, firstDirtyPositions, layout);
+
+    // Leaves with new limits
+    std::vector<size_t> changedNodeIndices;
+    for (auto leaf : order) {
+        if (columns.hasValues(leaf) && !layout.hasSameLimits(lastLayout, leaf)) {
+            changedNodeIndices.push_back(leaf);
         }
+    }
 
-        it = upperLimitParent.find(endTimeParent);
-        if (it != upperLimitParent.end()) {
-            it->second.first = std::max(it->second.first, upperLimit[endTimeParent].first);
-        } else {
-            upperLimitParent.emplace(endTimeParent, upperLimit[endTimeParent]);
+    // The limits of their ancestors may change as well
+    std::vector<size_t> nodesToVisit(changedNodeIndices);
+
+    std::vector<bool> nodesToUpdate(tree.nodes.size(), false);
+    std::vector<size_t> ancestors;
+    while (!nodesToVisit.empty()) {
+        const size_t nodeIndex = nodesToVisit.back();
+        nodesToVisit.pop_back();
+        for (auto parent : topology.parents(nodeIndex)) {
+            if (nodesToUpdate[parent]) continue;
+            nodesToUpdate[parent] = true;
+            ancestors.push_back(parent);
+            nodesToVisit.push_back(parent);
         }
+    }
+
+    // All their ancestors get their limits again from their children
+    for (auto ancestor : ancestors) layout.clearLimits(ancestor);
+    computeParentLimits(tree, topology, nodesToUpdate);
 
-        // traverse further to the root
-        traverseToRootForLimits(tree, parent, startTimeParent, endTimeParent);
+    for (auto ancestor : ancestors) {
+        if (!layout.hasSameLimits(lastLayout, ancestor)) changedNodeIndices.push_back(ancestor);
     }
+
+    std::sort(changedNodeIndices.begin(), changedNodeIndices.end());
+    layout.markLimitsUpdated(std::move(changedNodeIndices));
 }
 
-void TemporalTreeLayoutComputation::copyLimitInBetween(TemporalTree::TDrawingLimitMap& limitToCopy,
-                                                       TemporalTree::TDrawingLimitMap& limitToFill,
-                                                       uint64_t startTime, uint64_t endTime) {
-    if (startTime > endTime) {
-        LogProcessorError("Start Time larger then End Time?");
+void TemporalTreeLayoutComputation::computeParentLimits(TemporalTree& tree,
+                                                        const TemporalTreeTopology& topology,
+                                                        const std::vector<bool>& nodesToUpdate) {
+    TemporalTreeLayoutResult& layout = tree.layout;
+
+    // Inner nodes to compute, grouped by their height above the leaves
+    std::vector<std::vector<size_t>> nodesPerHeight(topology.numHeights());
+    for (size_t heightIndex(1); heightIndex < topology.numHeights(); heightIndex++) {
+        for (auto nodeIndex : topology.nodesOfHeight(heightIndex)) {
+            if (nodesToUpdate.empty() || nodesToUpdate[nodeIndex]) {
+                nodesPerHeight[heightIndex].push_back(nodeIndex);
+            }
+        }
+    }
+
+    // Each node only writes its own limits from here on
+    layout.detachLimits();
+    const TemporalTreeLayoutResult& readLayout = layout;
+
+    std::vector<TemporalTreeLayoutResult::TBandLimits> envelope;
+    std::vector<uint8_t> isSet;
+    for (const auto& nodes : nodesPerHeight) {
+#pragma omp parallel for schedule(dynamic, 16) private(envelope, isSet) \
+    if (propParallel.get() && nodes.size() > 1)
+        for (int i = 0; i < int(nodes.size()); i++) {
+            const size_t nodeIndex = nodes[i];
+            const size_t firstIdx = layout.firstIndex(nodeIndex);
+            const size_t lastIdx = layout.lastIndex(nodeIndex);
+            if (firstIdx == TemporalTreeLayoutResult::InvalidIndex) continue;
+
+            envelope.resize(lastIdx - firstIdx + 1);
+            isSet.assign(lastIdx - firstIdx + 1, 0);
+
+            // The band spans from the lowest to the highest child at each time,
+            // for a child that changes its parent only while it is below this node
+            for (auto child : topology.children(nodeIndex)) {
+                if (!readLayout.hasLimits(child)) continue;
+
+                const size_t startIdx = std::max(firstIdx, readLayout.startIndex(child));
+                const size_t endIdx = std::min(lastIdx, readLayout.endIndex(child));
+                for (size_t timeIdx = startIdx; timeIdx <= endIdx; timeIdx++) {
+                    if (!readLayout.isSet(child, timeIdx)) continue;
+
+                    const TemporalTreeLayoutResult::TBandLimits& childLimits =
+                        readLayout.limits(child, timeIdx);
+                    TemporalTreeLayoutResult::TBandLimits& limits = envelope[timeIdx - firstIdx];
+                    if (!isSet[timeIdx - firstIdx]) {
+                        limits = childLimits;
+                        isSet[timeIdx - firstIdx] = 1;
+                        continue;
+                    }
+
+                    limits.lower.first = std::min(limits.lower.first, childLimits.lower.first);
+                    limits.lower.second = std::min(limits.lower.second, childLimits.lower.second);
+                    limits.upper.first = std::max(limits.upper.first, childLimits.upper.first);
+                    limits.upper.second = std::max(limits.upper.second, childLimits.upper.second);
+                }
+            }
+
+            for (size_t timeIdx = firstIdx; timeIdx <= lastIdx; timeIdx++) {
+                if (isSet[timeIdx - firstIdx]) {
+                    layout.setLimits(nodeIndex, timeIdx) = envelope[timeIdx - firstIdx];
+                }
+            }
+        }
     }
-    limitToFill.insert(limitToCopy.find(startTime), std::next(limitToCopy.find(endTime)));
 }
 
 }  // namespace kth
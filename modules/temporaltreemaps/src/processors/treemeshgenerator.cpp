@@ -81,6 +81,11 @@ void TemporalTreeMeshGenerator::process() {
         return;
     }
 
+    if (!pTree->layout.fitsWithTree(*pTree) || pTree->layout.numTimes() == 0) {
+        LogProcessorError("The tree does not have a layout.");
+        return;
+    }
+
     // Make a new mesh and new vertex arrays
     auto meshLines = std::make_shared<BasicMesh>();
     std::vector<BasicMesh::Vertex> verticesLines;
@@ -101,9 +106,10 @@ void TemporalTreeMeshGenerator::makeMesh(const TemporalTree& tree,
                                          std::vector<BasicMesh::Vertex>& verticesBands,
                                          std::shared_ptr<BasicMesh> meshLines,
                                          std::vector<BasicMesh::Vertex>& verticesLines) {
-    auto times = tree.getTimes();
-    uint64_t tMin = *times.begin();
-    uint64_t tMax = *times.rbegin();
+    const TemporalTreeLayoutResult& layout = tree.layout;
+    const std::vector<uint64_t>& times = layout.times();
+    uint64_t tMin = times.front();
+    uint64_t tMax = times.back();
 
     auto indexBufferLine = meshLines->addIndexBuffer(DrawType::Lines, ConnectivityType::Strip);
     auto indexBufferSplitsMerges =
@@ -118,8 +124,7 @@ void TemporalTreeMeshGenerator::makeMesh(const TemporalTree& tree,
 
     size_t leafCounter(0);
 
-    TemporalTree::TTreeOrderMap orderMap;
-    treeorder::toOrderMap(orderMap, tree.order);
+    const treeorder::Permutation leafOrder(tree.order, tree.nodes.size());
 
     for (auto leaf : tree.order) {
         if (propNumLeaves.get() != -1 && leafCounter >= propNumLeaves.get()) {
@@ -131,45 +136,34 @@ void TemporalTreeMeshGenerator::makeMesh(const TemporalTree& tree,
 
         const TemporalTree::TNode& leafNode = tree.nodes[leaf];
 
-        auto& lowerLimitLeaf = leafNode.lowerLimit;
-        auto& upperLimitLeaf = leafNode.upperLimit;
-        auto& cushionLeaf = leafNode.cushion;
-        auto& colorsLeaf = leafNode.colors;
-
-        if (leafNode.values.size() < lowerLimitLeaf.size()) {
-            LogProcessorError("Drawing limits do not have enough values for band to draw "
-                              << leafCounter << ".");
-            return;
-        }
-
-        if (lowerLimitLeaf.size() != upperLimitLeaf.size()) {
-            LogProcessorError("Upper and lower limit for band to draw "
-                              << leafCounter << " have different sizes.");
-            return;
+        if (!layout.hasLimits(leaf) || layout.startIndex(leaf) == layout.endIndex(leaf)) {
+            LogProcessorWarn("Skipping a leaf with less then two values");
+            continue;
         }
 
-        if (lowerLimitLeaf.size() != upperLimitLeaf.size()) {
-            LogProcessorError("Upper and lower limit for band to draw "
-                              << leafCounter << " have different sizes.");
-            return;
-        }
+        const size_t startIdxLeaf = layout.startIndex(leaf);
+        const size_t endIdxLeaf = layout.endIndex(leaf);
 
-        if (colorsLeaf.size() != upperLimitLeaf.size()) {
-            LogProcessorError("Colors and limits for band to draw " << leafCounter
-                                                                    << " have different sizes.");
-            return;
-        }
-        if (cushionLeaf.size() != upperLimitLeaf.size()) {
-            LogProcessorError("Cushions and limits for band to draw " << leafCounter
-                                                                      << " have different sizes.");
-            return;
+        for (size_t timeIdx = startIdxLeaf; timeIdx <= endIdxLeaf; timeIdx++) {
+            if (!layout.isSet(leaf, timeIdx)) {
+                LogProcessorError("Drawing limits for band to draw " << leafCounter
+                                                                     << " have gaps.");
+                return;
+            }
+            if (!layout.hasColor(leaf, timeIdx)) {
+                LogProcessorError("Colors and limits for band to draw " << leafCounter
+                                                                        << " do not line up.");
+                return;
+            }
+            if (!layout.hasCushion(leaf, timeIdx)) {
+                LogProcessorError("Cushions and limits for band to draw " << leafCounter
+                                                                          << " do not line up.");
+                return;
+            }
         }
 
-        uint64_t tMinLeaf = lowerLimitLeaf.begin()->first;
-        uint64_t tMaxLeaf = lowerLimitLeaf.rbegin()->first;
-
-        auto itCushion = cushionLeaf.begin();
-        auto itColor = colorsLeaf.begin();
+        const uint64_t tMinLeaf = times[startIdxLeaf];
+        const uint64_t tMaxLeaf = times[endIdxLeaf];
 
         const auto& successors = tree.getTemporalSuccessors(leaf);
         const bool isSplit = successors.size() > 1
@@ -182,55 +176,42 @@ void TemporalTreeMeshGenerator::makeMesh(const TemporalTree& tree,
 
         const bool isMerge = tree.getTemporalPredecessorsWithReverse(leaf).size() > 1;
 
-        if (lowerLimitLeaf.size() < 2) {
-            LogProcessorWarn("Skipping a leaf with less then two values");
-            continue;
-        }
-
-        const uint64_t tSecondToLast = upperLimitLeaf.size() > 1
-                                           ? std::next(upperLimitLeaf.rbegin())->first
-                                           : upperLimitLeaf.rbegin()->first;
+        const uint64_t tSecondToLast = times[endIdxLeaf - 1];
         const float splitTime =
             isSplit ? std::max(normalTime(tMaxLeaf, tMin, tMax) - propMergeSplitBlend.get(),
                                normalTime(tSecondToLast, tMin, tMax))
                     : std::numeric_limits<float>::max();
 
-        const uint64_t tSecond = upperLimitLeaf.size() > 1
-                                     ? std::next(upperLimitLeaf.begin())->first
-                                     : upperLimitLeaf.begin()->first;
+        const uint64_t tSecond = times[startIdxLeaf + 1];
         const float mergeTime =
             isMerge ? std::min(normalTime(tMinLeaf, tMin, tMax) + propMergeSplitBlend.get(),
                                normalTime(tSecond, tMin, tMax))
                     : std::numeric_limits<float>::max();
 
-        for (auto itLowerLimit = lowerLimitLeaf.begin(), itUpperLimit = upperLimitLeaf.begin();
-             itLowerLimit != lowerLimitLeaf.end() && itUpperLimit != upperLimitLeaf.end();
-             itLowerLimit++, itUpperLimit++, itCushion++, itColor++) {
-            float normalTimeLeaf = normalTime(itLowerLimit->first, tMin, tMax);
+        for (size_t timeIdx = startIdxLeaf; timeIdx <= endIdxLeaf; timeIdx++) {
+            float normalTimeLeaf = normalTime(times[timeIdx], tMin, tMax);
 
             if (normalTimeLeaf >= splitTime) {
                 // Take already this line and split it up
-                if (itLowerLimit->first == tSecondToLast) {
-                    itLowerLimit++;
-                    itUpperLimit++;
-                    itCushion++;
-                    itColor++;
-                    normalTimeLeaf = normalTime(itLowerLimit->first, tMin, tMax);
+                if (timeIdx == endIdxLeaf - 1) {
+                    timeIdx++;
+                    normalTimeLeaf = normalTime(times[timeIdx], tMin, tMax);
                 }
                 // Make a new line before
+                const auto& limitsLeft = layout.limits(leaf, timeIdx - 1);
+                const auto& limitsRight = layout.limits(leaf, timeIdx);
 
                 // Get left and right cushion and interpolate
-                vec3 cushionLeft = std::prev(itCushion)->second.second;
+                vec3 cushionLeft = layout.cushion(leaf, timeIdx - 1).second;
 
-                vec3 xLeft = vec3(std::prev(itLowerLimit)->second.second, 0.0f,
-                                  std::prev(itUpperLimit)->second.second);
+                vec3 xLeft = vec3(limitsLeft.lower.second, 0.0f, limitsLeft.upper.second);
                 vec3 xLeftCushion = xLeft;
                 vec3 yLeft = vec3(0.0f);
                 cushion::getPoints(xLeftCushion, yLeft, cushionLeft);
 
-                vec3 cushionRight = itCushion->second.first;
+                vec3 cushionRight = layout.cushion(leaf, timeIdx).first;
 
-                vec3 xRight = vec3(itLowerLimit->second.first, 0.0f, itUpperLimit->second.first);
+                vec3 xRight = vec3(limitsRight.lower.first, 0.0f, limitsRight.upper.first);
                 vec3 xRightCushion = xRight;
                 vec3 yRight = vec3(0.0f);
                 cushion::getPoints(xRightCushion, yRight, cushionRight);
@@ -248,8 +229,14 @@ void TemporalTreeMeshGenerator::makeMesh(const TemporalTree& tree,
                     if (!tree.isLeaf(split)) {
                         t = 1.0;
                     }
-                    spliteeSum += tree.nodes[split].upperLimit.at(tMaxLeaf).second -
-                                  tree.nodes[split].lowerLimit.at(tMaxLeaf).second;
+                    if (!layout.isSet(split, endIdxLeaf)) {
+                        LogProcessorError("Band to draw " << leafCounter << " splits into node "
+                                                          << split << " which has no limits at "
+                                                          << tMaxLeaf << ".");
+                        return;
+                    }
+                    const auto& limitsSplit = layout.limits(split, endIdxLeaf);
+                    spliteeSum += limitsSplit.upper.second - limitsSplit.lower.second;
                 }
 
                 vec3 xInterpolatedCushion = t * xRightCushion + (1 - t) * xLeftCushion;
@@ -265,11 +252,11 @@ void TemporalTreeMeshGenerator::makeMesh(const TemporalTree& tree,
                     xInterpolated.y = (xInterpolated.x + xInterpolated.z) / 2.0f;
                 }
 
-                vec4 oldColor = itColor->second;
+                vec4 oldColor = layout.color(leaf, timeIdx);
 
-                drawLineVertex(tSecondToLastNormal, std::prev(itUpperLimit)->second.second,
-                               *indexBufferLine, verticesLines);
-                drawLineVertex(normalTimeLeaf, itUpperLimit->second.first, *indexBufferLine,
+                drawLineVertex(tSecondToLastNormal, limitsLeft.upper.second, *indexBufferLine,
+                               verticesLines);
+                drawLineVertex(normalTimeLeaf, limitsRight.upper.first, *indexBufferLine,
                                verticesLines);
 
                 // Lower vertex for the new line
@@ -300,22 +287,30 @@ void TemporalTreeMeshGenerator::makeMesh(const TemporalTree& tree,
                 }
 
                 // Go through these in the order that there are drawn in
-                treeorder::sortNodesByOrder(orderMap, tree, splitees);
+                treeorder::sortNodesByOrder(leafOrder, tree, splitees);
 
                 float ratio = (xRight.z - xRight.x) / spliteeSum;
 
                 float xLower = xRight.x;
 
                 for (auto split : splitees) {
-                    float splitValue = tree.nodes[split].upperLimit.at(tMaxLeaf).second -
-                                       tree.nodes[split].lowerLimit.at(tMaxLeaf).second;
+                    if (!layout.hasCushion(split, endIdxLeaf) ||
+                        !layout.hasColor(split, endIdxLeaf)) {
+                        LogProcessorError("Band to draw "
+                                          << leafCounter << " splits into node " << split
+                                          << " which has no cushion or color at " << tMaxLeaf
+                                          << ".");
+                        return;
+                    }
+                    const auto& limitsSplit = layout.limits(split, endIdxLeaf);
+                    float splitValue = limitsSplit.upper.second - limitsSplit.lower.second;
                     float xUpper = xLower + splitValue * ratio;
 
-                    vec3 cushionSplit = tree.nodes[split].cushion.at(tMaxLeaf).second;
+                    vec3 cushionSplit = layout.cushion(split, endIdxLeaf).second;
                     vec3 xSplit = vec3(xLower, 0.0f, xUpper);
                     vec3 ySplit = vec3(0.0f);
                     cushion::getPoints(xSplit, ySplit, cushionSplit);
-                    vec4 splitColor = tree.nodes[split].colors.at(tMaxLeaf);
+                    vec4 splitColor = layout.color(split, endIdxLeaf);
 
                     indexBufferSplitsMerges->add(static_cast<std::uint32_t>(splitLineMiddleVertex));
                     verticesBands.push_back(
@@ -358,22 +353,26 @@ void TemporalTreeMeshGenerator::makeMesh(const TemporalTree& tree,
                 break;
             }
 
-            if (itLowerLimit->first == tMinLeaf) {
+            // Shorthands for the drawing information at this time
+            const auto& limitsLeaf = layout.limits(leaf, timeIdx);
+            const auto& cushionLeaf = layout.cushion(leaf, timeIdx);
+            const vec4& colorLeaf = layout.color(leaf, timeIdx);
+
+            if (timeIdx == startIdxLeaf) {
                 if (mergeTime > normalTimeLeaf && mergeTime <= normalTime(tSecond, tMin, tMax)) {
                     // Get left and right cushion and interpolate
                     // @todo: Put cushion interpolation somewhere else
-                    vec3 cushionLeft = itCushion->second.second;
+                    const auto& limitsRight = layout.limits(leaf, timeIdx + 1);
+                    vec3 cushionLeft = cushionLeaf.second;
 
-                    vec3 xLeft =
-                        vec3(itLowerLimit->second.second, 0.0f, itUpperLimit->second.second);
+                    vec3 xLeft = vec3(limitsLeaf.lower.second, 0.0f, limitsLeaf.upper.second);
                     vec3 xLeftCushion = xLeft;
                     vec3 yLeft = vec3(0.0f);
                     cushion::getPoints(xLeftCushion, yLeft, cushionLeft);
 
-                    vec3 cushionRight = std::next(itCushion)->second.first;
+                    vec3 cushionRight = layout.cushion(leaf, timeIdx + 1).first;
 
-                    vec3 xRight = vec3(std::next(itLowerLimit)->second.first, 0.0f,
-                                       std::next(itUpperLimit)->second.first);
+                    vec3 xRight = vec3(limitsRight.lower.first, 0.0f, limitsRight.upper.first);
                     vec3 xRightCushion = xRight;
                     vec3 yRight = vec3(0.0f);
                     cushion::getPoints(xRightCushion, yRight, cushionRight);
@@ -406,12 +405,12 @@ void TemporalTreeMeshGenerator::makeMesh(const TemporalTree& tree,
                     }
 
                     // Indices of the last upper and lower vertex
-                    vec4 newColor = std::next(itColor)->second;
+                    vec4 newColor = layout.color(leaf, timeIdx + 1);
 
-                    drawLineVertex(normalTimeLeaf, itUpperLimit->second.second, *indexBufferLine,
+                    drawLineVertex(normalTimeLeaf, limitsLeaf.upper.second, *indexBufferLine,
+                                   verticesLines);
+                    drawLineVertex(tSecondNormal, limitsRight.upper.first, *indexBufferLine,
                                    verticesLines);
-                    drawLineVertex(tSecondNormal, std::next(itUpperLimit)->second.first,
-                                   *indexBufferLine, verticesLines);
 
                     // Lower vertex for the new line
                     verticesBands.push_back({vec3(mergeTime, xInterpolated.x, 0.0f),
@@ -446,20 +445,29 @@ void TemporalTreeMeshGenerator::makeMesh(const TemporalTree& tree,
                     }
 
                     // Go through these in the order that there are drawn in
-                    treeorder::sortNodesByOrder(orderMap, tree, mergees);
+                    treeorder::sortNodesByOrder(leafOrder, tree, mergees);
 
                     float xLower = xLeft.x;
 
                     for (auto merge : mergees) {
-                        float mergeValue = tree.nodes[merge].upperLimit.at(tMinLeaf).first -
-                                           tree.nodes[merge].lowerLimit.at(tMinLeaf).first;
+                        if (!layout.isSet(merge, startIdxLeaf) ||
+                            !layout.hasCushion(merge, startIdxLeaf) ||
+                            !layout.hasColor(merge, startIdxLeaf)) {
+                            LogProcessorError("Band to draw "
+                                              << leafCounter << " merges from node " << merge
+                                              << " which has no drawing information at "
+                                              << tMinLeaf << ".");
+                            return;
+                        }
+                        const auto& limitsMerge = layout.limits(merge, startIdxLeaf);
+                        float mergeValue = limitsMerge.upper.first - limitsMerge.lower.first;
                         float xUpper = xLower + mergeValue;
 
-                        vec3 cushionMerge = tree.nodes[merge].cushion.at(tMinLeaf).first;
+                        vec3 cushionMerge = layout.cushion(merge, startIdxLeaf).first;
                         vec3 xMerge = vec3(xLower, 0.0f, xUpper);
                         vec3 yMerge = vec3(0.0f);
                         cushion::getPoints(xMerge, yMerge, cushionMerge);
-                        vec4 mergeColor = tree.nodes[merge].colors.at(tMinLeaf);
+                        vec4 mergeColor = layout.color(merge, startIdxLeaf);
 
                         indexBufferSplitsMerges->add(
                             static_cast<std::uint32_t>(mergeLineMiddleVertex));
@@ -502,40 +510,34 @@ void TemporalTreeMeshGenerator::makeMesh(const TemporalTree& tree,
 
                     if (std::fabs(mergeTime - normalTime(tSecond, tMin, tMax)) <
                         std::numeric_limits<float>::epsilon()) {
-                        itLowerLimit++;
-                        itUpperLimit++;
-                        itCushion++;
+                        timeIdx++;
                     }
                 } else {
-                    drawVertexPair(normalTimeLeaf, itLowerLimit->second.second,
-                                   itUpperLimit->second.second, itCushion->second.second,
-                                   itColor->second, *indexBufferBand, verticesBands);
-                    drawLineVertex(normalTimeLeaf, itUpperLimit->second.second, *indexBufferLine,
+                    drawVertexPair(normalTimeLeaf, limitsLeaf.lower.second, limitsLeaf.upper.second,
+                                   cushionLeaf.second, colorLeaf, *indexBufferBand, verticesBands);
+                    drawLineVertex(normalTimeLeaf, limitsLeaf.upper.second, *indexBufferLine,
                                    verticesLines);
                     // Either we fade in or we merge -> both cases need just one edge
-                    // updateUpper(normalTimeLeaf, normalTimeLeaf, itLowerLimit->second.second,
+                    // updateUpper(normalTimeLeaf, normalTimeLeaf, limitsLeaf.lower.second,
                     // indexBufferLine, verticesLines);
                 }
-            } else if (itLowerLimit->first == tMaxLeaf) {
-                drawVertexPair(normalTimeLeaf, itLowerLimit->second.first,
-                               itUpperLimit->second.first, itCushion->second.first, itColor->second,
-                               *indexBufferBand, verticesBands);
-                drawLineVertex(normalTimeLeaf, itUpperLimit->second.first, *indexBufferLine,
+            } else if (timeIdx == endIdxLeaf) {
+                drawVertexPair(normalTimeLeaf, limitsLeaf.lower.first, limitsLeaf.upper.first,
+                               cushionLeaf.first, colorLeaf, *indexBufferBand, verticesBands);
+                drawLineVertex(normalTimeLeaf, limitsLeaf.upper.first, *indexBufferLine,
                                verticesLines);
                 // Either we fade out or we split -> both cases do not need a closing edge
             } else {
-                drawVertexPair(normalTimeLeaf, itLowerLimit->second.first,
-                               itUpperLimit->second.first, itCushion->second.first, itColor->second,
-                               *indexBufferBand, verticesBands);
-                drawLineVertex(normalTimeLeaf, itUpperLimit->second.first, *indexBufferLine,
+                drawVertexPair(normalTimeLeaf, limitsLeaf.lower.first, limitsLeaf.upper.first,
+                               cushionLeaf.first, colorLeaf, *indexBufferBand, verticesBands);
+                drawLineVertex(normalTimeLeaf, limitsLeaf.upper.first, *indexBufferLine,
                                verticesLines);
                 // Suffices to test for one, we have added the same value to both anyways
-                if (std::fabs(itLowerLimit->second.second - itLowerLimit->second.first) >
+                if (std::fabs(limitsLeaf.lower.second - limitsLeaf.lower.first) >
                     std::numeric_limits<float>::epsilon()) {
-                    drawVertexPair(normalTimeLeaf, itLowerLimit->second.second,
-                                   itUpperLimit->second.second, itCushion->second.second,
-                                   itColor->second, *indexBufferBand, verticesBands);
-                    drawLineVertex(normalTimeLeaf, itUpperLimit->second.second, *indexBufferLine,
+                    drawVertexPair(normalTimeLeaf, limitsLeaf.lower.second, limitsLeaf.upper.second,
+                                   cushionLeaf.second, colorLeaf, *indexBufferBand, verticesBands);
+                    drawLineVertex(normalTimeLeaf, limitsLeaf.upper.second, *indexBufferLine,
                                    verticesLines);
                 }
             }
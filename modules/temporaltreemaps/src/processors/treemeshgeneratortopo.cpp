@@ -10,6 +10,7 @@
 
 #include <modules/temporaltreemaps/processors/treemeshgeneratortopo.h>
 #include <inviwo/core/util/colorconversion.h>
+#include <modules/temporaltreemaps/datastructures/treetopology.h>
 
 namespace inviwo {
 namespace kth {
@@ -44,9 +45,10 @@ TemporalTreeMeshGeneratorTopo::TemporalTreeMeshGeneratorTopo()
 
 namespace {
 
-void GetLayerOrder(const TemporalTree& Tree, const std::vector<size_t>& LeafOrder,
+void GetLayerOrder(const TemporalTree& Tree, const TemporalTreeTopology& Topology,
+                   const std::vector<size_t>& LeafOrder,
                    const std::map<size_t, size_t>& LeafOrderMap,
-                   const std::vector<size_t>& LevelIndices,
+                   const TemporalTreeTopology::NodeRange& LevelIndices,
                    TemporalTreeMeshGeneratorTopo::TLayerOrder& LayerOrder) {
     // Prepare memory
     const size_t NumLeaves = LeafOrder.size();
@@ -62,7 +64,8 @@ void GetLayerOrder(const TemporalTree& Tree, const std::vector<size_t>& LeafOrde
         const uint64_t tMinParent = Tree.nodes[idxParent].startTime();
         const uint64_t tMaxParent = Tree.nodes[idxParent].endTime();
 
-        Tree.getLeaves(idxParent, tMinParent, tMaxParent, tMinParent, tMaxParent, LeavesOfParent);
+        Topology.getLeaves(Tree, idxParent, tMinParent, tMaxParent, tMinParent, tMaxParent,
+                           LeavesOfParent);
 
         // Add to render queue
         size_t MinOrderRow(NumLeaves);
@@ -252,22 +255,22 @@ void TemporalTreeMeshGeneratorTopo::process() {
 
     // Mesh!
     TLayerOrder LayerOrder;
+    const TemporalTreeTopology Topology(*pTree);
     size_t Level(1);
-    size_t MaxLevel(pTree->getNumLevels(0));
-    std::vector<size_t> LevelIndices;
-    LevelIndices = pTree->getLevel(Level, LevelIndices, 0);
+    size_t MaxLevel(Topology.numLevels());
+    auto LevelIndices = Topology.level(Level);
     while (!LevelIndices.empty()) {
         ivwAssert(Level <= MaxLevel, "Too deep!");
 
         // Create an order of nodes in this layer, but depending on the leaves layer
-        GetLayerOrder(*pTree, Order, OrderMap, LevelIndices, LayerOrder);
+        GetLayerOrder(*pTree, Topology, Order, OrderMap, LevelIndices, LayerOrder);
 
         // Create the actual mesh
         CreateMesh(*pTree, Level, MaxLevel, NumLeaves, LayerOrder, MeshBands, Vertices);
 
         // Forward to the next level
-        LevelIndices = pTree->getLevel(Level + 1, LevelIndices, Level);
         Level++;
+        LevelIndices = Topology.level(Level);
     }
 
     // Push it out!
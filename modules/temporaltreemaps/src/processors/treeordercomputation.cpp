@@ -9,8 +9,11 @@
  */
 
 #include <inviwo/core/util/utilities.h>
+#include <inviwo/core/common/inviwoapplication.h>
 #include <modules/temporaltreemaps/processors/treeordercomputation.h>
 #include <random>
+#include <chrono>
+#include <numeric>
 
 namespace inviwo {
 namespace kth {
@@ -48,6 +51,7 @@ TemporalTreeOrderOptimization::TemporalTreeOrderOptimization()
     , propWeightSize("weightSize", "Size", 1, 0.l, 10.0)
     , propWeightByLevel("weightByLevel", "Weight By Level", false)
     , propWeightLevel("weightLevel", "Level", 1.0, 0.l, 10.0)
+    , propVerifyEvery("verifyEvery", "Verify Every n-th Evaluation", 1000, 0, 1000000, 1)
     , propInitialOrder("initialOrder", "Initial Order")
     , propUseInputOrder("useInputOrder", "Use input order", false)
     , propRandomizeOrder("randomizeInitial", "Randomize initial order", false)
@@ -56,12 +60,18 @@ TemporalTreeOrderOptimization::TemporalTreeOrderOptimization()
     , propRandomnessOptimization("randomnessOptimization", "Randomness")
     , propRandomOrSeedOptimization("randomOrSeedOptimization", "Random Seed for Optimization", true)
     , propSeedOptimization("seedOptimization", "Seed for Optimization", 0, 0, RAND_MAX + 1, 1)
+    , propDecomposition("decomposition", "Decomposition")
+    , propDecompose("decompose", "Optimize Components Separately", false)
+    , propParallelComponents("parallelComponents", "Parallel Components", true)
     // Buttons for starting/stopping/resetting
     , propControls("controls", "Controls")
     , propRestart("restart", "Initialize/Restart")
     , propSingleStep("SingleStep", "Single Step")
     , propRunStepWise("runStepwise", "Run Stepwise")
     , propRunUntilConvergence("runConvergence", "Run until Convergence")
+    , propRunInBackground("runBackground", "Run in Background")
+    , propPauseBackground("pauseBackground", "Pause")
+    , propPublishInterval("publishInterval", "Publish Interval (ms)", 250, 10, 10000, 10)
     , runTimer(std::chrono::milliseconds{10}, []() {})
     // Current State
     , propCurrentState("currentState", "Current State")
@@ -72,6 +82,7 @@ TemporalTreeOrderOptimization::TemporalTreeOrderOptimization()
     , propStatisticsMergeSplit("statisticsMergeSplit", "Merge/Split", "")
     , propStatisticsHierarchy("statisticsHierarchy", "Hierarchy", "")
     , propObjectiveValue("objectiveValue", "Value", 0.f, 0.f, 10000.f, 0.1f)
+    , propObjectiveLowerBound("objectiveLowerBound", "Lower Bound", 0.f, 0.f, 10000.f, 0.1f)
     , propTimeForLastAction("timeForLastAction", "Time for Last Action", 0.f, 0.f, 3600.f, 0.001f)
     , propTimeUntilBest("timeuntilBest", "Time until Best", 0.f, 0.f, 3600.f, 0.001f)
     /// Save
@@ -83,6 +94,7 @@ TemporalTreeOrderOptimization::TemporalTreeOrderOptimization()
     // Ports
     addPort(portInTree);
     portInTree.onChange([&]() {
+        stopBackgroundRun();
         initializeResources();
         updateOutput();
     });
@@ -92,6 +104,12 @@ TemporalTreeOrderOptimization::TemporalTreeOrderOptimization()
     addPort(portOutLogOptimization);
 
     initialized = false;
+    timeUntilBest = 0.f;
+    numDeltaEvaluations = 0;
+    backgroundCancel = false;
+    backgroundPause = false;
+    backgroundPublished = false;
+    backgroundPublishRequested = false;
 
     /* Settings */
 
@@ -150,6 +168,11 @@ TemporalTreeOrderOptimization::TemporalTreeOrderOptimization()
         if (!propRandomOrSeedOptimization.get()) restart();
     });
 
+    propSettings.addProperty(propDecomposition);
+
+    propDecomposition.addProperty(propDecompose);
+    propDecomposition.addProperty(propParallelComponents);
+
     propSettings.addProperty(propObjectiveFunction);
 
     propObjectiveFunction.addProperty(propWeightByType);
@@ -195,6 +218,9 @@ TemporalTreeOrderOptimization::TemporalTreeOrderOptimization()
         }
     });
 
+    propObjectiveFunction.addProperty(propVerifyEvery);
+    propVerifyEvery.setSemantics(PropertySemantics::Text);
+
     util::hide(propWeightSize, propWeightLevel, propWeightMergeSplit, propWeightHierarchy);
     util::hide(propWeightBySize, propWeightByType, propWeightByLevel);
 
@@ -206,6 +232,10 @@ TemporalTreeOrderOptimization::TemporalTreeOrderOptimization()
     propControls.addProperty(propSingleStep);
     propControls.addProperty(propRunStepWise);
     propControls.addProperty(propRunUntilConvergence);
+    propControls.addProperty(propRunInBackground);
+    propControls.addProperty(propPauseBackground);
+    propControls.addProperty(propPublishInterval);
+    propPublishInterval.setSemantics(PropertySemantics::Text);
 
     propRunStepWise.onChange([&]() {
         if (runTimer.isRunning()) {
@@ -213,12 +243,33 @@ TemporalTreeOrderOptimization::TemporalTreeOrderOptimization()
             runTimer.stop();
             propRunStepWise.setDisplayName("Run Stepwise");
         } else {
+            stopBackgroundRun();
             performanceTimer.Reset();
             runTimer.start();
             propRunStepWise.setDisplayName("Stop");
         }
     });
 
+    propRunInBackground.onChange([&]() {
+        if (isRunningInBackground()) {
+            stopBackgroundRun();
+            propTimeForLastAction.set(performanceTimer.ElapsedTimeAndReset());
+            updateOutput();
+        } else {
+            startBackgroundRun();
+        }
+    });
+
+    propPauseBackground.onChange([&]() {
+        if (!isRunningInBackground()) return;
+        {
+            std::lock_guard<std::mutex> lock(backgroundMutex);
+            backgroundPause = !backgroundPause;
+        }
+        backgroundCondition.notify_all();
+        propPauseBackground.setDisplayName(backgroundPause ? "Resume" : "Pause");
+    });
+
     /* Current State */
 
     addProperty(propCurrentState);
@@ -232,7 +283,18 @@ TemporalTreeOrderOptimization::TemporalTreeOrderOptimization()
     propBestIteration.setSemantics(PropertySemantics::Text);
 
     propCurrentState.addProperty(propOutputBestOrder);
-    propOutputBestOrder.onChange([&]() { updateOutput(); });
+    propOutputBestOrder.onChange([&]() {
+        // The worker owns the state while it runs, it publishes with the new setting
+        if (isRunningInBackground()) {
+            {
+                std::lock_guard<std::mutex> lock(backgroundMutex);
+                backgroundPublishRequested = true;
+            }
+            backgroundCondition.notify_all();
+            return;
+        }
+        updateOutput();
+    });
 
     propCurrentState.addProperty(propFulfilledConstraintsTotal);
     propFulfilledConstraintsTotal.setReadOnly(true);
@@ -241,6 +303,10 @@ TemporalTreeOrderOptimization::TemporalTreeOrderOptimization()
     propObjectiveValue.setReadOnly(true);
     propObjectiveValue.setSemantics(PropertySemantics::Text);
 
+    propCurrentState.addProperty(propObjectiveLowerBound);
+    propObjectiveLowerBound.setReadOnly(true);
+    propObjectiveLowerBound.setSemantics(PropertySemantics::Text);
+
     propCurrentState.addProperty(propStatisticsMergeSplit);
     propStatisticsMergeSplit.setReadOnly(true);
 
@@ -309,6 +375,11 @@ void TemporalTreeOrderOptimization::fillStatistics(const ConstraintsStatistic& s
     propStatisticsHierarchy.set(hierarchy);
 }
 
+std::shared_ptr<const TemporalTree> TemporalTreeOrderOptimization::getTreeToOrder() const {
+    if (pComponentTree) return pComponentTree;
+    return portInTree.getData();
+}
+
 void TemporalTreeOrderOptimization::setInitialOrder() {
 
     currentState.order.clear();
@@ -346,8 +417,11 @@ void TemporalTreeOrderOptimization::setInitialOrder() {
 }
 
 void TemporalTreeOrderOptimization::initializeResources() {
+    // The worker must not see the resources change
+    stopBackgroundRun();
+
     // Get tree
-    std::shared_ptr<const TemporalTree> pTreeIn = portInTree.getData();
+    std::shared_ptr<const TemporalTree> pTreeIn = getTreeToOrder();
     if (!pTreeIn) return;
 
     // Copy tree to compute reverse edges
@@ -356,6 +430,10 @@ void TemporalTreeOrderOptimization::initializeResources() {
     pInputTree = std::const_pointer_cast<const TemporalTree>(pCopyTree);
 
     constraints.clear();
+    // The evaluator refers to the old tree and constraints, it is rebuilt on demand
+    evaluator = IncrementalEvaluator();
+    lowerBoundWeights.clear();
+    objectiveLowerBound = 0;
 
     // Extract constraints from the tree
     numByLevelHierarchy.clear();
@@ -365,6 +443,8 @@ void TemporalTreeOrderOptimization::initializeResources() {
     extractMergeSplitConstraints(pInputTree, constraints, numByLevelMergeSplit);
     numConstraintsMergeSplit = constraints.size() - numConstraintsHierarchy;
 
+    flatConstraints.build(*pInputTree, constraints);
+
     maxConstraintSize = 0;
     maxConstraintLevel = 0;
     for (auto& constraint : constraints) {
@@ -410,11 +490,17 @@ double TemporalTreeOrderOptimization::evaluateOrder(const TemporalTree::TTreeOrd
         (*statistic).clear();
     }
 
-    TemporalTree::TTreeOrderMap orderMap;
-    treeorder::toOrderMap(orderMap, order);
-
-    for (auto& constraint : constraints) {
-        if (!isFulFilled(constraint, pInputTree, order, orderMap)) {
+    // Reuses the memory from the last evaluation
+    evaluationPermutation.set(order, pInputTree->nodes.size());
+    timesByPosition(flatConstraints, evaluationPermutation, evaluationStartByPosition,
+                    evaluationEndByPosition);
+
+    for (size_t constraintId(0); constraintId < constraints.size(); constraintId++) {
+        auto& constraint = constraints[constraintId];
+        constraint.fulfilled =
+            isFulFilled(flatConstraints, constraintId, evaluationPermutation,
+                        evaluationStartByPosition, evaluationEndByPosition);
+        if (!constraint.fulfilled) {
             value += weighUnfulfilledConstraint(constraint);
         }
         // If a ConstraintsStatistic is given
@@ -430,9 +516,68 @@ double TemporalTreeOrderOptimization::evaluateOrder(const TemporalTree::TTreeOrd
     return evaluateOrder(order, nullptr);
 }
 
+double TemporalTreeOrderOptimization::resetOrderEvaluation(const TemporalTree::TTreeOrder& order,
+                                                           ConstraintsStatistic* statistic) {
+    if (!evaluator.isInitialized()) {
+        evaluator.initialize(*pInputTree, flatConstraints, constraints);
+    }
+
+    // Weights might have changed since the last time
+    std::vector<double> weights;
+    weights.reserve(constraints.size());
+    for (auto& constraint : constraints) {
+        weights.push_back(weighUnfulfilledConstraint(constraint));
+    }
+
+    return evaluator.evaluate(order, weights, statistic);
+}
+
+double TemporalTreeOrderOptimization::evaluateOrderDelta(const TemporalTree::TTreeOrder& order,
+                                                         ConstraintsStatistic* statistic) {
+    return evaluateOrderDelta(order, 0, order.size(), statistic);
+}
+
+double TemporalTreeOrderOptimization::evaluateOrderDelta(const TemporalTree::TTreeOrder& order,
+                                                         const size_t firstPosition,
+                                                         const size_t endPosition,
+                                                         ConstraintsStatistic* statistic) {
+    if (isEstimatingObjective()) {
+        return evaluator.estimate(order, firstPosition, endPosition, evaluationSampleEvery,
+                                  randomGen);
+    }
+
+    const double deltaValue = evaluator.update(order, firstPosition, endPosition, statistic);
+
+    ivwAssert(std::abs(evaluator.value() - evaluateOrder(order)) <
+                  std::numeric_limits<float>::epsilon(),
+              "Incremental evaluation differs from the full evaluation.");
+
+    // The assertion is gone in release builds, a full evaluation every now and then
+    // still tells if the incremental one is off
+    numDeltaEvaluations++;
+    if (propVerifyEvery > 0 && numDeltaEvaluations % propVerifyEvery == 0) {
+        const double fullValue = evaluateOrder(order);
+        if (std::abs(evaluator.value() - fullValue) >= std::numeric_limits<float>::epsilon()) {
+            std::stringstream message;
+            message << "Incremental evaluation differs from the full evaluation: "
+                    << evaluator.value() << " instead of " << fullValue << ".";
+            logInfo(message.str());
+        }
+    }
+
+    return deltaValue;
+}
+
+void TemporalTreeOrderOptimization::revertOrderDelta(ConstraintsStatistic* statistic) {
+    evaluator.revert(statistic);
+}
+
 void TemporalTreeOrderOptimization::restart() {
+    // The worker must not see the state change
+    stopBackgroundRun();
+
     // Get tree
-    std::shared_ptr<const TemporalTree> pTreeIn = portInTree.getData();
+    std::shared_ptr<const TemporalTree> pTreeIn = getTreeToOrder();
     if (!pTreeIn) return;
 
     if (!initialized || !pInputTree) {
@@ -447,19 +592,248 @@ void TemporalTreeOrderOptimization::restart() {
 
     currentState.iteration = 0;
     currentState.statistic.clear();
+    numDeltaEvaluations = 0;
     setInitialOrder();
     currentState.value = evaluateOrder(currentState.order, &currentState.statistic);
 
+    updateLowerBound();
+
     setFileNames();
 }
 
+void TemporalTreeOrderOptimization::updateLowerBound() {
+    std::vector<double> weights;
+    weights.reserve(constraints.size());
+    for (auto& constraint : constraints) {
+        weights.push_back(weighUnfulfilledConstraint(constraint));
+    }
+
+    // The conflicts only depend on the constraints, only compute again for new weights
+    if (weights == lowerBoundWeights && !lowerBoundWeights.empty()) return;
+
+    objectiveLowerBound = lowerBoundUnfulfilled(flatConstraints, weights);
+    lowerBoundWeights = std::move(weights);
+}
+
+bool TemporalTreeOrderOptimization::hasReachedLowerBound() const {
+    return bestState.value - objectiveLowerBound < std::numeric_limits<float>::epsilon();
+}
+
+void TemporalTreeOrderOptimization::getComponents(
+    std::vector<std::vector<size_t>>& components) const {
+    const size_t numNodes = pInputTree->nodes.size();
+
+    // Union-find over the leaves, each constraint joins all its leaves
+    std::vector<size_t> representative(numNodes);
+    std::iota(representative.begin(), representative.end(), 0);
+    auto find = [&](size_t node) {
+        while (representative[node] != node) {
+            representative[node] = representative[representative[node]];
+            node = representative[node];
+        }
+        return node;
+    };
+
+    for (const auto& constraint : constraints) {
+        if (constraint.leaves.empty()) continue;
+        const size_t first = find(*constraint.leaves.begin());
+        for (auto leaf : constraint.leaves) {
+            representative[find(leaf)] = first;
+        }
+    }
+
+    const size_t noComponent = std::numeric_limits<size_t>::max();
+    std::vector<size_t> componentByRepresentative(numNodes, noComponent);
+    components.clear();
+    for (auto leaf : currentState.order) {
+        size_t& componentId = componentByRepresentative[find(leaf)];
+        if (componentId == noComponent) {
+            componentId = components.size();
+            components.emplace_back();
+        }
+        components[componentId].push_back(leaf);
+    }
+}
+
+std::shared_ptr<TemporalTree> TemporalTreeOrderOptimization::createComponentTree(
+    const std::vector<size_t>& leaves, std::vector<size_t>& inputNodes) const {
+    const TemporalTree& tree = *pInputTree;
+    const size_t numNodes = tree.nodes.size();
+
+    // The leaves and all their ancestors, the root is always part of it
+    std::vector<bool> isIncluded(numNodes, false);
+    isIncluded[0] = true;
+    std::vector<size_t> toVisit(leaves);
+    while (!toVisit.empty()) {
+        const size_t node = toVisit.back();
+        toVisit.pop_back();
+        if (isIncluded[node]) continue;
+        isIncluded[node] = true;
+        for (auto parent : tree.getHierarchicalParentsWithReverse(node)) {
+            toVisit.push_back(parent);
+        }
+    }
+
+    // Keep the nodes in the same order, such that the root stays at index 0
+    auto pComponent = std::make_shared<TemporalTree>();
+    std::vector<size_t> componentNodes(numNodes, std::numeric_limits<size_t>::max());
+    inputNodes.clear();
+    for (size_t node(0); node < numNodes; node++) {
+        if (!isIncluded[node]) continue;
+        componentNodes[node] = pComponent->addNode(tree.nodes[node]);
+        inputNodes.push_back(node);
+    }
+
+    for (auto node : inputNodes) {
+        for (auto child : tree.getHierarchicalChildren(node)) {
+            if (isIncluded[child]) {
+                pComponent->addHierarchyEdge(componentNodes[node], componentNodes[child]);
+            }
+        }
+        for (auto successor : tree.getTemporalSuccessors(node)) {
+            if (isIncluded[successor]) {
+                pComponent->addTemporalEdge(componentNodes[node], componentNodes[successor]);
+            }
+        }
+    }
+    pComponent->computeReverseEdges();
+
+    // The current order is the input order of the component
+    for (auto leaf : currentState.order) {
+        if (isIncluded[leaf]) pComponent->order.push_back(componentNodes[leaf]);
+    }
+
+    return pComponent;
+}
+
+void TemporalTreeOrderOptimization::runUntilConvergenceByComponents() {
+    if (!propDecompose || !pInputTree) {
+        runUntilConvergence();
+        return;
+    }
+
+    std::vector<std::vector<size_t>> components;
+    getComponents(components);
+    if (components.size() < 2) {
+        runUntilConvergence();
+        return;
+    }
+
+    // Single leaves stay as they are, all other components get an optimizer
+    std::vector<size_t> optimizerByComponent(components.size(),
+                                             std::numeric_limits<size_t>::max());
+    std::vector<std::unique_ptr<TemporalTreeOrderOptimization>> optimizers;
+    std::vector<std::vector<size_t>> inputNodes;
+    for (size_t componentId(0); componentId < components.size(); componentId++) {
+        if (components[componentId].size() < 2) continue;
+
+        std::unique_ptr<TemporalTreeOrderOptimization> optimizer = createComponentOptimizer();
+        if (!optimizer) {
+            LogProcessorWarn("This optimization cannot be split into components, optimizing all "
+                             "leaves at once.");
+            runUntilConvergence();
+            return;
+        }
+
+        // Same settings, but starting from the current order with a seed of its own
+        optimizer->propSettings.set(&propSettings);
+        optimizer->propUseInputOrder.set(true);
+        optimizer->propRandomizeOrder.set(false);
+        optimizer->propRandomOrSeedOptimization.set(false);
+        std::seed_seq componentSeed{propSeedOptimization.get(), int(componentId)};
+        std::vector<std::uint32_t> seed(1);
+        componentSeed.generate(seed.begin(), seed.end());
+        optimizer->propSeedOptimization.set(int(seed[0] % RAND_MAX));
+
+        inputNodes.emplace_back();
+        optimizer->pComponentTree = createComponentTree(components[componentId], inputNodes.back());
+
+        optimizerByComponent[componentId] = optimizers.size();
+        optimizers.push_back(std::move(optimizer));
+    }
+
+    // Properties and logs are only touched on this thread, the workers only run the steps
+    for (auto& optimizer : optimizers) {
+        optimizer->initializeResources();
+        optimizer->performanceTimer.Reset();
+    }
+
+    const int numOptimizers = int(optimizers.size());
+    const int numThreads =
+        int(std::min(std::thread::hardware_concurrency(), (unsigned int)std::max(numOptimizers, 1)));
+#pragma omp parallel for schedule(dynamic, 1) num_threads(numThreads) if (propParallelComponents.get())
+    for (int optimizerId = 0; optimizerId < numOptimizers; optimizerId++) {
+        optimizers[optimizerId]->runUntilConvergence();
+    }
+
+    for (size_t optimizerId(0); optimizerId < optimizers.size(); optimizerId++) {
+        for (const auto& message : optimizers[optimizerId]->componentMessages) {
+            LogProcessorInfo("Component " << optimizerId << ": " << message);
+        }
+    }
+
+    // Put the components one after another. They are sorted by their first leaf,
+    // so the hierarchy is kept as in the initial order.
+    TemporalTree::TTreeOrder order;
+    order.reserve(currentState.order.size());
+    size_t numIterations(0);
+    for (size_t componentId(0); componentId < components.size(); componentId++) {
+        const size_t optimizerId = optimizerByComponent[componentId];
+        const OptimizationState* pComponentBest =
+            optimizerId < optimizers.size() ? &optimizers[optimizerId]->bestState : nullptr;
+        if (!pComponentBest || pComponentBest->order.size() != components[componentId].size()) {
+            order.insert(order.end(), components[componentId].begin(),
+                         components[componentId].end());
+            continue;
+        }
+
+        const OptimizationState& componentBest = *pComponentBest;
+        for (auto leaf : componentBest.order) {
+            order.push_back(inputNodes[optimizerId][leaf]);
+        }
+        numIterations += componentBest.iteration;
+    }
+
+    currentState.order = order;
+    currentState.iteration = numIterations;
+    currentState.value = resetOrderEvaluation(currentState.order, &currentState.statistic);
+    if (currentState.value < bestState.value) {
+        timeUntilBest = performanceTimer.ElapsedTime();
+        bestState = currentState;
+    }
+    currentOrderChanged();
+    logStep();
+
+    LogProcessorInfo("Optimized " << optimizers.size() << " components separately, "
+                                  << components.size() - optimizers.size()
+                                  << " single leaves were kept in place.");
+}
+
+void TemporalTreeOrderOptimization::logInfo(const std::string& message) {
+    if (pComponentTree) {
+        componentMessages.push_back(message);
+        return;
+    }
+    LogProcessorInfo(message);
+}
+
 void TemporalTreeOrderOptimization::updateOutput() {
-    std::shared_ptr<const TemporalTree> pTreeIn = portInTree.getData();
+    std::shared_ptr<const TemporalTree> pTreeIn = getTreeToOrder();
     if (!pTreeIn) return;
 
     // Copy tree to output things
     std::shared_ptr<TemporalTree> pTreeOut = std::make_shared<TemporalTree>(TemporalTree(*pTreeIn));
 
+    updateStateProperties();
+
+    // Set the order
+    pTreeOut->order = propOutputBestOrder ? bestState.order : currentState.order;
+
+    // Set data
+    portOutTree.setData(pTreeOut);
+}
+
+void TemporalTreeOrderOptimization::updateStateProperties() {
     propCurrentIteration.set(int(currentState.iteration) - 1);
     propBestIteration.set(int(bestState.iteration) - 1);
 
@@ -467,12 +841,114 @@ void TemporalTreeOrderOptimization::updateOutput() {
     fillStatistics(propOutputBestOrder ? bestState.statistic : currentState.statistic);
     propObjectiveValue.set(propOutputBestOrder ? float(bestState.value)
                                                : float(currentState.value));
+    propObjectiveLowerBound.set(float(objectiveLowerBound));
 
-    // Set the order
-    pTreeOut->order = propOutputBestOrder ? bestState.order : currentState.order;
+    propTimeUntilBest.set(timeUntilBest);
+}
 
-    // Set data
-    portOutTree.setData(pTreeOut);
+void TemporalTreeOrderOptimization::startBackgroundRun() {
+    if (!getTreeToOrder()) return;
+    if (!initialized) initializeResources();
+
+    stopBackgroundRun();
+    if (runTimer.isRunning()) {
+        runTimer.stop();
+        propRunStepWise.setDisplayName("Run Stepwise");
+    }
+
+    backgroundCancel = false;
+    backgroundPause = false;
+    backgroundPublishRequested = false;
+    backgroundToken = std::make_shared<bool>(true);
+
+    performanceTimer.Reset();
+    propRunInBackground.setDisplayName("Cancel");
+    propPauseBackground.setDisplayName("Pause");
+
+    // Properties are read here, the worker should not touch them
+    backgroundWorker =
+        std::thread(&TemporalTreeOrderOptimization::runInBackground, this,
+                    std::weak_ptr<bool>(backgroundToken),
+                    std::chrono::milliseconds(std::max(propPublishInterval.get(), 1)));
+}
+
+void TemporalTreeOrderOptimization::stopBackgroundRun() {
+    if (!backgroundWorker.joinable()) return;
+    if (backgroundWorker.get_id() == std::this_thread::get_id()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(backgroundMutex);
+        backgroundCancel = true;
+    }
+    backgroundCondition.notify_all();
+    backgroundWorker.join();
+
+    // Drop updates the worker has requested but that have not been done yet
+    backgroundToken.reset();
+
+    propRunInBackground.setDisplayName("Run in Background");
+    propPauseBackground.setDisplayName("Pause");
+}
+
+void TemporalTreeOrderOptimization::runInBackground(std::weak_ptr<bool> token,
+                                                    const std::chrono::milliseconds interval) {
+    bool converged = false;
+    while (!converged) {
+        // Wait while paused, unless the main thread asks for an output
+        {
+            std::unique_lock<std::mutex> lock(backgroundMutex);
+            backgroundCondition.wait(lock, [this]() {
+                return backgroundCancel || !backgroundPause || backgroundPublishRequested;
+            });
+            if (backgroundCancel) return;
+        }
+
+        // Run a batch of steps
+        const auto batchStart = std::chrono::steady_clock::now();
+        while (!backgroundCancel && !backgroundPause && !backgroundPublishRequested &&
+               !(converged = isConverged()) &&
+               std::chrono::steady_clock::now() - batchStart < interval) {
+            singleStep();
+        }
+
+        // Output and properties are updated on the main thread. We wait for it,
+        // such that the state does not change in the meantime.
+        std::unique_lock<std::mutex> lock(backgroundMutex);
+        backgroundPublished = false;
+        backgroundPublishRequested = false;
+        dispatchFront([this, token]() {
+            if (token.expired()) return;
+            updateOutput();
+            invalidate(InvalidationLevel::InvalidOutput);
+            {
+                std::lock_guard<std::mutex> lock(backgroundMutex);
+                backgroundPublished = true;
+            }
+            backgroundCondition.notify_all();
+        });
+        backgroundCondition.wait(lock,
+                                 [this]() { return backgroundCancel || backgroundPublished; });
+        if (backgroundCancel) return;
+    }
+
+    dispatchFront([this, token]() {
+        if (token.expired()) return;
+        finishBackgroundRun();
+    });
+}
+
+void TemporalTreeOrderOptimization::finishBackgroundRun() {
+    if (backgroundWorker.joinable()) backgroundWorker.join();
+    backgroundToken.reset();
+
+    propRunInBackground.setDisplayName("Run in Background");
+    propPauseBackground.setDisplayName("Pause");
+    propTimeForLastAction.set(performanceTimer.ElapsedTimeAndReset());
+    if (propSaveLog) {
+        saveLog();
+    }
+    updateOutput();
+    invalidate(InvalidationLevel::InvalidOutput);
 }
 
 void TemporalTreeOrderOptimization::saveLog() {
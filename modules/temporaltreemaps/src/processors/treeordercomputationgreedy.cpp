@@ -42,6 +42,7 @@ TemporalTreeOrderComputationGreedy::TemporalTreeOrderComputationGreedy()
     });
 
     propSingleStep.onChange([&]() {
+        stopBackgroundRun();
         if (!initialized) initializeResources();
         performanceTimer.Reset();
         singleStep();
@@ -62,10 +63,11 @@ TemporalTreeOrderComputationGreedy::TemporalTreeOrderComputationGreedy()
     });
 
     propRunUntilConvergence.onChange([&]() {
+        stopBackgroundRun();
         if (!initialized || currentState.iteration != 0) initializeResources();
         restart();
         performanceTimer.Reset();
-        runUntilConvergence();
+        runUntilConvergenceByComponents();
         propTimeForLastAction.set(performanceTimer.ElapsedTimeAndReset());
         if (propSaveLog) {
             saveLog();
@@ -81,6 +83,9 @@ void TemporalTreeOrderComputationGreedy::resolveConstraint() {
     std::vector<std::pair<size_t, size_t>> bestIds;
     double bestValue = std::numeric_limits<double>::max();
 
+    // Positions of all leaves in the current order
+    const treeorder::Permutation currentPermutation(currentState.order, pInputTree->nodes.size());
+
     for (auto& constraintId : unfulfilledConstraints) {
         Constraint& constraint = constraints[constraintId];
 
@@ -89,7 +94,7 @@ void TemporalTreeOrderComputationGreedy::resolveConstraint() {
         TemporalTree::TTreeOrder conflictingLeaves;
         TemporalTree::TTreeOrder nonConflictingAndConstraintLeaves;
         TemporalTreeOrderComputationHeuristic::findConflictingLeaves(
-            pInputTree, constraint, currentState.order, minOrder, maxOrder, conflictingLeaves,
+            pInputTree, constraint, currentPermutation, minOrder, maxOrder, conflictingLeaves,
             nonConflictingAndConstraintLeaves);
 
         TemporalTree::TTreeOrder temporaryOrder;
@@ -126,7 +131,7 @@ void TemporalTreeOrderComputationGreedy::resolveConstraint() {
     TemporalTree::TTreeOrder conflictingLeaves;
     TemporalTree::TTreeOrder nonConflictingAndConstraintLeaves;
     TemporalTreeOrderComputationHeuristic::findConflictingLeaves(
-        pInputTree, constraints[solution.first], currentState.order, minOrder, maxOrder,
+        pInputTree, constraints[solution.first], currentPermutation, minOrder, maxOrder,
         conflictingLeaves, nonConflictingAndConstraintLeaves);
 
     TemporalTree::TTreeOrder temporaryOrder;
@@ -156,18 +161,30 @@ void TemporalTreeOrderComputationGreedy::restart() {
     logStep();
 }
 
+void TemporalTreeOrderComputationGreedy::currentOrderChanged() {
+    // The constraints keep track of whether they are fulfilled
+    evaluateOrder(currentState.order);
+    prepareNextStep();
+}
+
 bool TemporalTreeOrderComputationGreedy::isConverged() {
     // the iteration number is an index starting at 0, the max is a number >= -1
     if (currentState.iteration > propIterationsMax - 1) {
-        LogProcessorInfo("Converged by reaching maximum number of iterations.");
+        logInfo("Converged by reaching maximum number of iterations.");
         return true;
     }
     if (std::abs(currentState.value) < std::numeric_limits<float>::epsilon()) {
-        LogProcessorInfo("Converged by reaching a global optimum.");
+        logInfo("Converged by reaching a global optimum.");
+        return true;
+    }
+    if (hasReachedLowerBound()) {
+        std::stringstream message;
+        message << "Converged by reaching the lower bound " << objectiveLowerBound << ".";
+        logInfo(message.str());
         return true;
     }
     if (unfulfilledConstraints.size() == 0) {
-        LogProcessorInfo("Converged by no more constraints to fulfill");
+        logInfo("Converged by no more constraints to fulfill");
         return true;
     }
     return false;
@@ -193,7 +210,7 @@ void TemporalTreeOrderComputationGreedy::runUntilConvergence() {
         currentState.iteration++;
         logStep();
         if (currentState.value < bestState.value) {
-            propTimeUntilBest.set(performanceTimer.ElapsedTime());
+            timeUntilBest = performanceTimer.ElapsedTime();
             bestState = currentState;
         }
         prepareNextStep();
@@ -230,7 +247,7 @@ void TemporalTreeOrderComputationGreedy::logProperties() {
         std::to_string(propSeedOrder),        std::to_string(propSeedOptimization),
         std::to_string(propIterationsMax),    std::to_string(propWeightByTypeOnly),
         std::to_string(propWeightTypeOnly),   std::to_string(bestState.iteration),
-        std::to_string(bestState.value),      std::to_string(propTimeUntilBest),
+        std::to_string(bestState.value),      std::to_string(timeUntilBest),
         std::to_string(propTimeForLastAction)};
 
     optimizationSettings = createDataFrame({exampleRow}, colHeaders);
@@ -53,6 +53,7 @@ TemporalTreeOrderComputationHeuristic::TemporalTreeOrderComputationHeuristic()
     });
 
     propSingleStep.onChange([&]() {
+        stopBackgroundRun();
         if (!initialized) initializeResources();
         performanceTimer.Reset();
         singleStep();
@@ -73,10 +74,11 @@ TemporalTreeOrderComputationHeuristic::TemporalTreeOrderComputationHeuristic()
     });
 
     propRunUntilConvergence.onChange([&]() {
+        stopBackgroundRun();
         if (!initialized || currentState.iteration != 0) initializeResources();
         restart();
         performanceTimer.Reset();
-        runUntilConvergence();
+        runUntilConvergenceByComponents();
         propTimeForLastAction.set(performanceTimer.ElapsedTimeAndReset());
         if (propSaveLog) {
             saveLog();
@@ -89,47 +91,32 @@ TemporalTreeOrderComputationHeuristic::TemporalTreeOrderComputationHeuristic()
 
 void TemporalTreeOrderComputationHeuristic::findConflictingLeaves(
     std::shared_ptr<const TemporalTree>& tree, const Constraint& constraint,
-    const TemporalTree::TTreeOrder& order, size_t& minOrder, size_t& maxOrder,
+    const treeorder::Permutation& order, size_t& minOrder, size_t& maxOrder,
     TemporalTree::TTreeOrder& conflictingLeaves,
     TemporalTree::TTreeOrder& nonConflictingAndConstraintLeaves) {
 
     conflictingLeaves.clear();
     nonConflictingAndConstraintLeaves.clear();
 
+    // Find first and last constraint leaf directly from their positions
+    minOrder = order.size();
+    maxOrder = 0;
+    for (const auto leaf : constraint.leaves) {
+        const size_t position = order.positionOf(leaf);
+        if (position < minOrder) minOrder = position;
+        if (position > maxOrder) maxOrder = position;
+    }
+
     // Seperate everything between minimum and maximum for constraint
     // into conflicting and non-conflicting leaves
+    for (size_t r(minOrder); r <= maxOrder; r++) {
+        size_t leaf = order.nodeAt(r);
 
-    bool foundFirstLeaf = false;
-
-    size_t foundConstraintLeaves = 0;
-
-    for (size_t r(0); r < order.size(); r++) {
-        size_t leaf = order[r];
-
-        if (constraint.leaves.find(order[r]) != constraint.leaves.end()) {
-            foundConstraintLeaves++;
-            if (!foundFirstLeaf) {
-                minOrder = r;
-                foundFirstLeaf = true;
-            }
-            // First leaf has been found
-            if (foundFirstLeaf && foundConstraintLeaves <= constraint.leaves.size()) {
-                nonConflictingAndConstraintLeaves.push_back(leaf);
-            }
-            if (foundConstraintLeaves == constraint.leaves.size()) {
-                // Found the last constraint leaf, we are done
-                maxOrder = r;
-                break;
-            }
-
+        if (constraint.leaves.find(leaf) != constraint.leaves.end() ||
+            !isOverlappingWithConstraint(tree->nodes[leaf], constraint)) {
+            nonConflictingAndConstraintLeaves.push_back(leaf);
         } else {
-            if (foundFirstLeaf) {
-                if (!isOverlappingWithConstraint(tree->nodes[order[r]], constraint)) {
-                    nonConflictingAndConstraintLeaves.push_back(leaf);
-                } else {
-                    conflictingLeaves.push_back(leaf);
-                }
-            }
+            conflictingLeaves.push_back(leaf);
         }
     }
 }
@@ -174,7 +161,7 @@ bool TemporalTreeOrderComputationHeuristic::resolveConstraint(
     TemporalTree::TTreeOrder conflictingLeaves;
     TemporalTree::TTreeOrder nonConflictingAndConstraintLeaves;
 
-    findConflictingLeaves(pInputTree, constraint, currentState.order, minOrder, maxOrder,
+    findConflictingLeaves(pInputTree, constraint, currentPermutation, minOrder, maxOrder,
                           conflictingLeaves, nonConflictingAndConstraintLeaves);
 
     TemporalTree::TTreeOrder temporaryOrder;
@@ -207,8 +194,7 @@ bool TemporalTreeOrderComputationHeuristic::resolveConstraint(
     buildNewOrder(temporaryOrder, currentState.order, bestIds[solutionId], conflictingLeaves,
                   nonConflictingAndConstraintLeaves, minOrder, maxOrder);
     currentState.order = temporaryOrder;
-    currentOrderMap.clear();
-    treeorder::toOrderMap(currentOrderMap, currentState.order);
+    currentPermutation.set(currentState.order, pInputTree->nodes.size());
     currentState.statistic.clear();
     currentState.value = evaluateOrder(currentState.order, &currentState.statistic);
 
@@ -228,8 +214,7 @@ void TemporalTreeOrderComputationHeuristic::initializeResources() {
 void TemporalTreeOrderComputationHeuristic::restart() {
     TemporalTreeOrderOptimization::restart();
 
-    currentOrderMap.clear();
-    treeorder::toOrderMap(currentOrderMap, currentState.order);
+    currentPermutation.set(currentState.order, pInputTree->nodes.size());
 
     constraintOrder = std::vector<size_t>(constraints.size());
     // Fill the order with the index
@@ -298,18 +283,33 @@ void TemporalTreeOrderComputationHeuristic::restart() {
     logStep();
 }
 
+void TemporalTreeOrderComputationHeuristic::currentOrderChanged() {
+    currentPermutation.set(currentState.order, pInputTree->nodes.size());
+
+    // The constraints keep track of whether they are fulfilled
+    evaluateOrder(currentState.order);
+    constraintsQueue = std::queue<size_t>();
+    prepareNextStep();
+}
+
 bool TemporalTreeOrderComputationHeuristic::isConverged() {
     // the iteration number is an index starting at 0, the max is a number >= -1
     if (currentState.iteration > propIterationsMax - 1) {
-        LogProcessorInfo("Converged by reaching maximum number of iterations.");
+        logInfo("Converged by reaching maximum number of iterations.");
         return true;
     }
     if (std::abs(currentState.value) < std::numeric_limits<float>::epsilon()) {
-        LogProcessorInfo("Converged by reaching a global optimum.");
+        logInfo("Converged by reaching a global optimum.");
+        return true;
+    }
+    if (hasReachedLowerBound()) {
+        std::stringstream message;
+        message << "Converged by reaching the lower bound " << objectiveLowerBound << ".";
+        logInfo(message.str());
         return true;
     }
     if (constraintsQueue.empty()) {
-        LogProcessorInfo("Converged by no more constraints to fulfill");
+        logInfo("Converged by no more constraints to fulfill");
         return true;
     }
     return false;
@@ -324,7 +324,7 @@ void TemporalTreeOrderComputationHeuristic::singleStep() {
     // resolve There might be constraint in the queue that are already fulfilled, an interation
     // fulfills another constraint
     while (!isConverged() &&
-           !resolveConstraint(portInTree.getData(), constraints[constraintsQueue.front()])) {
+           !resolveConstraint(getTreeToOrder(), constraints[constraintsQueue.front()])) {
         // If resolve Constraint was true we have to pop the fulfilled constraint
         constraintsQueue.pop();
     }
@@ -340,11 +340,11 @@ void TemporalTreeOrderComputationHeuristic::singleStep() {
 
 void TemporalTreeOrderComputationHeuristic::runUntilConvergence() {
     while (!isConverged()) {
-        if (resolveConstraint(portInTree.getData(), constraints[constraintsQueue.front()])) {
+        if (resolveConstraint(getTreeToOrder(), constraints[constraintsQueue.front()])) {
             currentState.iteration++;
             logStep();
             if (currentState.value < bestState.value) {
-                propTimeUntilBest.set(performanceTimer.ElapsedTime());
+                timeUntilBest = performanceTimer.ElapsedTime();
                 bestState = currentState;
             }
         } else {
@@ -385,7 +385,7 @@ void TemporalTreeOrderComputationHeuristic::logProperties() {
         std::to_string(propIterationsMax),    std::to_string(propInitialConstraintOrder.get()),
         std::to_string(propWeightByTypeOnly), std::to_string(propWeightTypeOnly),
         std::to_string(bestState.iteration),  std::to_string(bestState.value),
-        std::to_string(propTimeUntilBest),    std::to_string(propTimeForLastAction)};
+        std::to_string(timeUntilBest),    std::to_string(propTimeForLastAction)};
 
     optimizationSettings = createDataFrame({exampleRow}, colHeaders);
     optimizationSettings->addRow(exampleRow);
@@ -0,0 +1,433 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 14:05:12
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#include <modules/temporaltreemaps/processors/treeordercomputationparalleltempering.h>
+#include <modules/temporaltreemaps/processors/treeordercomputationheuristic.h>
+#include <thread>
+
+namespace inviwo {
+namespace kth {
+
+// The Class Identifier has to be globally unique. Use a reverse DNS naming scheme
+const ProcessorInfo TemporalTreeOrderComputationParallelTempering::processorInfo_{
+    "org.inviwo.TemporalTreeOrderComputationParallelTempering",  // Class identifier
+    "Tree Order Parallel Tempering",                             // Display name
+    "Temporal Tree",                                             // Category
+    CodeState::Experimental,                                     // Code state
+    Tags::None,                                                  // Tags
+};
+
+const ProcessorInfo TemporalTreeOrderComputationParallelTempering::getProcessorInfo() const {
+    return processorInfo_;
+}
+
+TemporalTreeOrderComputationParallelTempering::TemporalTreeOrderComputationParallelTempering()
+    : TemporalTreeSimulatedAnnealing()
+    , propParallelTempering("parallelTempering", "Parallel Tempering")
+    , propNumReplicas("numReplicas", "Replicas", 8, 2, 64, 1)
+    , propTemperatureRatio("temperatureRatio", "T Ratio", 0.5, 0.01, 0.99, 0.01)
+    , propStepsPerExchange("stepsPerExchange", "Steps per Exchange", 10, 1, 10000, 1)
+    , propResolveConstraints("resolveConstraints", "Resolve Constraints", true)
+    , propParallel("parallel", "Parallel Replicas", true)
+    , propExchanges("exchanges", "Exchanges", "") {
+    /* Settings */
+
+    propSettings.addProperty(propParallelTempering);
+
+    propParallelTempering.addProperty(propNumReplicas);
+    propNumReplicas.onChange([&]() { restart(); });
+    propNumReplicas.setSemantics(PropertySemantics::Text);
+
+    propParallelTempering.addProperty(propTemperatureRatio);
+    propTemperatureRatio.onChange([&]() { restart(); });
+    propTemperatureRatio.setSemantics(PropertySemantics::Text);
+
+    propParallelTempering.addProperty(propStepsPerExchange);
+    propStepsPerExchange.onChange([&]() { restart(); });
+    propStepsPerExchange.setSemantics(PropertySemantics::Text);
+
+    propParallelTempering.addProperty(propResolveConstraints);
+    propResolveConstraints.onChange([&]() { restart(); });
+
+    propParallelTempering.addProperty(propParallel);
+
+    // Replicas run at a whole ladder of temperatures, sampling neighbors of a single state
+    // does not tell us much about the hottest one
+    propEstimateInitialTemperature.set(false);
+    propEstimateInitialTemperature.setVisible(false);
+
+    // Replicas evaluate with their own evaluators, always exactly
+    propSampledEvaluation.set(false);
+    propSampledEvaluation.setVisible(false);
+
+    /* Current state */
+
+    propCurrentState.addProperty(propExchanges);
+    propExchanges.setReadOnly(true);
+
+    /* Controls */
+
+    propRestart.onChange([&]() {
+        if (!initialized) {
+            initializeResources();
+        } else {
+            restart();
+        }
+        updateOutput();
+    });
+
+    propSingleStep.onChange([&]() {
+        stopBackgroundRun();
+        if (!initialized) initializeResources();
+        performanceTimer.Reset();
+        if (!isConverged()) {
+            singleStep();
+        }
+        propTimeForLastAction.set(performanceTimer.ElapsedTimeAndReset());
+        updateOutput();
+    });
+
+    runTimer.setCallback([this]() {
+        if (!initialized) initializeResources();
+        singleStep();
+        // Stop timer and performance timer when we have converged
+        if (isConverged()) {
+            propTimeForLastAction.set(performanceTimer.ElapsedTimeAndReset());
+            runTimer.stop();
+            propRunStepWise.setDisplayName("Run Stepwise");
+        }
+        updateOutput();
+    });
+
+    propRunUntilConvergence.onChange([&]() {
+        stopBackgroundRun();
+        if (!initialized || currentState.iteration != 0) initializeResources();
+        restart();
+        performanceTimer.Reset();
+        runUntilConvergenceByComponents();
+        propTimeForLastAction.set(performanceTimer.ElapsedTimeAndReset());
+        if (propSaveLog) {
+            saveLog();
+        }
+        updateOutput();
+    });
+
+    logPrefix = "parallelTempering";
+}
+
+bool TemporalTreeOrderComputationParallelTempering::acceptReplicaNeighbor(
+    double deltaEnergy, double temperature, std::mt19937& replicaRandomGen) {
+    // Same Metropolis criterion as in the simulated annealing, but with the replica temperature
+    if (!(deltaEnergy <= 0)) {
+        const double probabilityThreshold =
+            temperature > 0 ? std::exp(-(deltaEnergy) / temperature) : -1.0;
+        std::uniform_real_distribution<> replicaUniformReal(0.0, 1.0);
+        if (replicaUniformReal(replicaRandomGen) > probabilityThreshold) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::pair<size_t, size_t> TemporalTreeOrderComputationParallelTempering::replicaNeighbor(
+    Replica& replica) const {
+    const auto& unfulfilled = replica.evaluator.getUnfulfilled();
+
+    if (propNeighborhood.get() == BlockMoves) {
+        replica.neighborOrder = replica.state.order;
+        return moveBlock(replica.neighborOrder, replica.evaluator.getPermutation(),
+                         replica.randomGen);
+    } else if (propResolveConstraints && !unfulfilled.empty()) {
+        std::uniform_int_distribution<int> chooseConstraintToResolve(
+            0, static_cast<int>(unfulfilled.size()) - 1);
+        const Constraint& constraint =
+            constraints[unfulfilled[size_t(chooseConstraintToResolve(replica.randomGen))]];
+
+        size_t minOrder(replica.state.order.size());
+        size_t maxOrder(0);
+        TemporalTree::TTreeOrder conflictingLeaves;
+        TemporalTree::TTreeOrder nonConflictingAndConstraintLeaves;
+
+        // The evaluator of the replica holds the positions for its order
+        std::shared_ptr<const TemporalTree> tree = pInputTree;
+        TemporalTreeOrderComputationHeuristic::findConflictingLeaves(
+            tree, constraint, replica.evaluator.getPermutation(), minOrder, maxOrder,
+            conflictingLeaves, nonConflictingAndConstraintLeaves);
+
+        // Chose the resolution randomly
+        std::uniform_int_distribution<int> chooseResolution(
+            0, static_cast<int>(conflictingLeaves.size()));
+
+        TemporalTreeOrderComputationHeuristic::buildNewOrder(
+            replica.neighborOrder, replica.state.order, chooseResolution(replica.randomGen),
+            conflictingLeaves, nonConflictingAndConstraintLeaves, minOrder, maxOrder);
+    } else {
+        replica.neighborOrder = replica.state.order;
+        if (replica.neighborOrder.size() < 2) return {0, 0};
+
+        std::uniform_int_distribution<int> chooseSwapNodes(
+            0, static_cast<int>(replica.neighborOrder.size()) - 1);
+        int swapA = chooseSwapNodes(replica.randomGen);
+        int swapB = chooseSwapNodes(replica.randomGen);
+        while (swapA == swapB) {
+            swapB = chooseSwapNodes(replica.randomGen);
+        }
+        std::swap(replica.neighborOrder[swapA], replica.neighborOrder[swapB]);
+    }
+
+    return {0, replica.neighborOrder.size()};
+}
+
+void TemporalTreeOrderComputationParallelTempering::replicaStep(Replica& replica) const {
+    // Nothing left to improve for this replica
+    if (replica.evaluator.getUnfulfilled().empty()) {
+        replica.lastDeltaEnergy = 0;
+        replica.lastAccepted = false;
+        return;
+    }
+
+    const auto changedRange = replicaNeighbor(replica);
+
+    // The statistic of the replica is kept up to date along with its value
+    replica.lastDeltaEnergy =
+        replica.evaluator.update(replica.neighborOrder, changedRange.first, changedRange.second,
+                                 &replica.state.statistic);
+    replica.lastAccepted =
+        acceptReplicaNeighbor(replica.lastDeltaEnergy, replica.temperature, replica.randomGen);
+
+    if (!replica.lastAccepted) {
+        replica.evaluator.revert(&replica.state.statistic);
+        return;
+    }
+
+    std::swap(replica.state.order, replica.neighborOrder);
+    replica.state.value = replica.evaluator.value();
+
+    if (replica.state.value < replica.bestValue) {
+        replica.bestValue = replica.state.value;
+        replica.bestOrder = replica.state.order;
+    }
+}
+
+void TemporalTreeOrderComputationParallelTempering::setReplicaTemperatures() {
+    double temperature = currentTemperature;
+    for (auto& replica : replicas) {
+        replica.temperature = temperature;
+        temperature *= propTemperatureRatio;
+    }
+}
+
+void TemporalTreeOrderComputationParallelTempering::neighborSolution() {
+    const int numReplicas = static_cast<int>(replicas.size());
+    const int numSteps = propStepsPerExchange;
+
+    // Replicas only share read-only data, each one uses its own random stream
+    const int numThreads =
+        int(std::min(std::thread::hardware_concurrency(), (unsigned int)std::max(numReplicas, 1)));
+#pragma omp parallel for schedule(static, 1) num_threads(numThreads) if (propParallel.get())
+    for (int replicaId = 0; replicaId < numReplicas; replicaId++) {
+        Replica& replica = replicas[replicaId];
+        for (int step = 0; step < numSteps; step++) {
+            replicaStep(replica);
+        }
+    }
+}
+
+void TemporalTreeOrderComputationParallelTempering::prepareNextStep() {
+    // Alternate between even and odd pairs such that every pair gets its chance
+    for (size_t replicaId = currentState.iteration % 2; replicaId + 1 < replicas.size();
+         replicaId += 2) {
+        Replica& hotter = replicas[replicaId];
+        Replica& colder = replicas[replicaId + 1];
+
+        // Metropolis criterion for exchanging the states of both temperatures:
+        // accept with probability min(1, exp((1/T_colder - 1/T_hotter) * (E_colder - E_hotter)))
+        const double deltaEnergy = colder.state.value - hotter.state.value;
+        bool accept = deltaEnergy >= 0;
+        if (!accept && hotter.temperature > 0 && colder.temperature > 0) {
+            const double probabilityThreshold =
+                std::exp((1.0 / colder.temperature - 1.0 / hotter.temperature) * deltaEnergy);
+            accept = uniformReal(randomGen) <= probabilityThreshold;
+        }
+
+        numExchangesAttempted++;
+        if (accept) {
+            std::swap(hotter.state, colder.state);
+            std::swap(hotter.evaluator, colder.evaluator);
+            numExchangesAccepted++;
+        }
+    }
+}
+
+void TemporalTreeOrderComputationParallelTempering::initializeResources() {
+    stopBackgroundRun();
+
+    std::shared_ptr<const TemporalTree> pTreeIn = getTreeToOrder();
+    if (!pTreeIn) return;
+
+    pInputTree = pTreeIn;
+
+    /* Initialize merge/split constraints */
+    TemporalTreeOrderOptimization::initializeResources();
+
+    initialized = true;
+    restart();
+}
+
+void TemporalTreeOrderComputationParallelTempering::restart() {
+    TemporalTreeSimulatedAnnealing::restart();
+
+    lastState = currentState;
+    bestState = currentState;
+    lastDeltaEnergy = 0;
+    lastAccepted = false;
+    numExchangesAccepted = 0;
+    numExchangesAttempted = 0;
+    propExchanges.set("");
+
+    // All replicas start from the initial order, copies of the evaluator share its index
+    replicas.assign(size_t(propNumReplicas.get()), Replica());
+    for (size_t replicaId(0); replicaId < replicas.size(); replicaId++) {
+        Replica& replica = replicas[replicaId];
+        replica.state = currentState;
+        replica.evaluator = evaluator;
+        // Streams only depend on the seed and the replica, not on the thread running it
+        std::seed_seq replicaSeed{propSeedOptimization.get(), int(replicaId)};
+        replica.randomGen.seed(replicaSeed);
+    }
+
+    setReplicaTemperatures();
+}
+
+bool TemporalTreeOrderComputationParallelTempering::isConverged() {
+    // Nothing to optimize without a tree
+    if (replicas.empty()) return true;
+
+    // Any replica might have found the optimum
+    if (std::abs(bestState.value) < std::numeric_limits<float>::epsilon()) {
+        logInfo("Converged by reaching a global optimum.");
+        return true;
+    }
+
+    return TemporalTreeSimulatedAnnealing::isConverged();
+}
+
+void TemporalTreeOrderComputationParallelTempering::singleStep() {
+    if (isConverged()) {
+        return;
+    }
+
+    setLastToCurrent();
+
+    // All replicas anneal independently
+    neighborSolution();
+
+    // Collect the best order any replica has seen
+    auto itBest = std::min_element(
+        replicas.begin(), replicas.end(),
+        [](const Replica& a, const Replica& b) { return a.bestValue < b.bestValue; });
+    const bool isBetter = itBest->bestValue < bestState.value;
+    if (isBetter) {
+        bestState.order = itBest->bestOrder;
+    }
+    for (auto& replica : replicas) {
+        replica.bestValue = std::numeric_limits<double>::max();
+    }
+
+    // Neighboring replicas exchange states
+    prepareNextStep();
+
+    // The coldest replica is our current state, it knows its value and statistic
+    const Replica& coldest = replicas.back();
+    currentState.order = coldest.state.order;
+    currentState.value = coldest.state.value;
+    currentState.statistic = coldest.state.statistic;
+    lastDeltaEnergy = coldest.lastDeltaEnergy;
+    lastAccepted = coldest.lastAccepted;
+    if (lastAccepted) numAcceptedAtTemperature++;
+
+    if (isBetter) {
+        timeUntilBest = performanceTimer.ElapsedTime();
+        setBest();
+        bestTemperature = currentTemperature;
+    }
+
+    // Update for the next step
+    currentState.iteration++;
+    logStep();
+
+    // The ladder follows the hottest temperature
+    if (updateTemperature()) {
+        setReplicaTemperatures();
+    }
+}
+
+void TemporalTreeOrderComputationParallelTempering::currentOrderChanged() {
+    lastState = currentState;
+    for (auto& replica : replicas) {
+        replica.state = currentState;
+        replica.evaluator = evaluator;
+    }
+}
+
+void TemporalTreeOrderComputationParallelTempering::setLastToCurrent() {
+    lastState = currentState;
+}
+
+void TemporalTreeOrderComputationParallelTempering::setCurrentToLast() {
+    currentState = lastState;
+}
+
+void TemporalTreeOrderComputationParallelTempering::setBest() {
+    // The best order is already set, evaluate it fully for the statistic
+    bestState.iteration = currentState.iteration;
+    bestState.value = evaluateOrder(bestState.order, &bestState.statistic);
+}
+
+void TemporalTreeOrderComputationParallelTempering::updateStateProperties() {
+    TemporalTreeSimulatedAnnealing::updateStateProperties();
+    propExchanges.set(std::to_string(numExchangesAccepted) + " / " +
+                      std::to_string(numExchangesAttempted));
+}
+
+void TemporalTreeOrderComputationParallelTempering::logProperties() {
+    const std::vector<std::string> colHeaders{
+        propSeedOrder.getDisplayName(),          propSeedOptimization.getDisplayName(),
+        propIterationsMax.getDisplayName(),      propInitialTemperature.getDisplayName(),
+        propMinimumTemperature.getDisplayName(), propTemperatureDecay.getDisplayName(),
+        propIterationsPerTemp.getDisplayName(),  propNeighborhood.getDisplayName(),
+        propNumReplicas.getDisplayName(),        propTemperatureRatio.getDisplayName(),
+        propStepsPerExchange.getDisplayName(),   propWeightByTypeOnly.getDisplayName(),
+        propWeightTypeOnly.getDisplayName(),     propBestIteration.getDisplayName(),
+        propObjectiveValue.getDisplayName(),     propTimeUntilBest.getDisplayName(),
+        propTimeForLastAction.getDisplayName()};
+
+    const std::vector<std::string> exampleRow{
+        std::to_string(propSeedOrder),          std::to_string(propSeedOptimization),
+        std::to_string(propIterationsMax),      std::to_string(propInitialTemperature),
+        std::to_string(propMinimumTemperature), std::to_string(propTemperatureDecay),
+        std::to_string(propIterationsPerTemp),  propNeighborhood.getSelectedIdentifier(),
+        std::to_string(propNumReplicas),        std::to_string(propTemperatureRatio),
+        std::to_string(propStepsPerExchange),   std::to_string(propWeightByTypeOnly),
+        std::to_string(propWeightTypeOnly),     std::to_string(bestState.iteration),
+        std::to_string(bestState.value),        std::to_string(timeUntilBest),
+        std::to_string(propTimeForLastAction)};
+
+    optimizationSettings = createDataFrame({exampleRow}, colHeaders);
+    optimizationSettings->addRow(exampleRow);
+}
+
+void TemporalTreeOrderComputationParallelTempering::process() {
+    // Nothing to do here: All buttons
+}
+
+}  // namespace kth
+}  // namespace inviwo
@@ -0,0 +1,261 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 17:02:48
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#include <modules/temporaltreemaps/processors/treeordercomputationpqtree.h>
+#include <algorithm>
+
+namespace inviwo {
+namespace kth {
+
+// The Class Identifier has to be globally unique. Use a reverse DNS naming scheme
+const ProcessorInfo TemporalTreeOrderComputationPQTree::processorInfo_{
+    "org.inviwo.TemporalTreeOrderComputationPQTree",  // Class identifier
+    "Tree Order Computation PQ-Tree",                 // Display name
+    "Temporal Tree",                                  // Category
+    CodeState::Experimental,                          // Code state
+    Tags::None,                                       // Tags
+};
+
+const ProcessorInfo TemporalTreeOrderComputationPQTree::getProcessorInfo() const {
+    return processorInfo_;
+}
+
+TemporalTreeOrderComputationPQTree::TemporalTreeOrderComputationPQTree()
+    : TemporalTreeOrderOptimization()
+    , propHeaviestFirst("heaviestFirst", "Heaviest First", true)
+    , propConsecutive("consecutive", "Consecutive", "")
+    , numProcessed(0)
+    , numAccepted(0) {
+    /* Settings */
+
+    propSettings.addProperty(propHeaviestFirst);
+    propHeaviestFirst.onChange([&]() { restart(); });
+
+    /* Current state */
+
+    propCurrentState.addProperty(propConsecutive);
+    propConsecutive.setReadOnly(true);
+
+    /* Constrols */
+
+    propRestart.onChange([&]() {
+        if (!initialized) {
+            initializeResources();
+        } else {
+            restart();
+        }
+        updateOutput();
+    });
+
+    propSingleStep.onChange([&]() {
+        stopBackgroundRun();
+        if (!initialized) initializeResources();
+        performanceTimer.Reset();
+        singleStep();
+        propTimeForLastAction.set(performanceTimer.ElapsedTimeAndReset());
+        updateOutput();
+    });
+
+    runTimer.setCallback([this]() {
+        if (!initialized) initializeResources();
+        singleStep();
+        // Stop timer and performance timer when we have converged
+        if (isConverged()) {
+            propTimeForLastAction.set(performanceTimer.ElapsedTimeAndReset());
+            runTimer.stop();
+            propRunStepWise.setDisplayName("Run Stepwise");
+        }
+        updateOutput();
+    });
+
+    propRunUntilConvergence.onChange([&]() {
+        stopBackgroundRun();
+        if (!initialized || currentState.iteration != 0) initializeResources();
+        restart();
+        performanceTimer.Reset();
+        runUntilConvergenceByComponents();
+        propTimeForLastAction.set(performanceTimer.ElapsedTimeAndReset());
+        if (propSaveLog) {
+            saveLog();
+        }
+        updateOutput();
+    });
+
+    logPrefix = "pqTree";
+}
+
+void TemporalTreeOrderComputationPQTree::addConstraint() {
+    const Constraint& constraint = constraints[constraintQueue[numProcessed]];
+    const std::vector<size_t> leaves(constraint.leaves.begin(), constraint.leaves.end());
+
+    // The tree stays as it is if the leaves cannot be consecutive together with the others
+    if (pqTree.reduce(leaves)) {
+        numAccepted++;
+    }
+    numProcessed++;
+}
+
+void TemporalTreeOrderComputationPQTree::updateCurrentOrder() {
+    pqTree.frontier(currentState.order);
+    currentState.statistic.clear();
+    currentState.value = evaluateOrder(currentState.order, &currentState.statistic);
+}
+
+void TemporalTreeOrderComputationPQTree::initializeResources() {
+    TemporalTreeOrderOptimization::initializeResources();
+
+    initialized = true;
+    restart();
+}
+
+void TemporalTreeOrderComputationPQTree::restart() {
+    TemporalTreeOrderOptimization::restart();
+    if (!getTreeToOrder()) return;
+
+    // The initial order decides between all orders that remain possible
+    pqTree.initialize(currentState.order, pInputTree->nodes.size());
+
+    constraintQueue.resize(constraints.size());
+    std::iota(constraintQueue.begin(), constraintQueue.end(), 0);
+    if (propHeaviestFirst) {
+        std::vector<double> weights(constraints.size());
+        for (size_t constraintId(0); constraintId < constraints.size(); constraintId++) {
+            weights[constraintId] = weighUnfulfilledConstraint(constraints[constraintId]);
+        }
+        std::stable_sort(constraintQueue.begin(), constraintQueue.end(),
+                         [&](const size_t a, const size_t b) { return weights[a] > weights[b]; });
+    }
+
+    numProcessed = 0;
+    numAccepted = 0;
+
+    bestState = currentState;
+
+    logStep();
+}
+
+void TemporalTreeOrderComputationPQTree::currentOrderChanged() {
+    pqTree.initialize(currentState.order, pInputTree->nodes.size());
+
+    // Constraints can only be checked again by a restart
+    std::vector<size_t> positions(pInputTree->nodes.size(), 0);
+    for (size_t position(0); position < currentState.order.size(); position++) {
+        positions[currentState.order[position]] = position;
+    }
+    numProcessed = constraintQueue.size();
+    numAccepted = 0;
+    for (const auto& constraint : constraints) {
+        if (constraint.leaves.empty()) continue;
+        const auto range = std::minmax_element(
+            constraint.leaves.begin(), constraint.leaves.end(),
+            [&](const size_t a, const size_t b) { return positions[a] < positions[b]; });
+        if (positions[*range.second] - positions[*range.first] + 1 == constraint.leaves.size()) {
+            numAccepted++;
+        }
+    }
+}
+
+bool TemporalTreeOrderComputationPQTree::isConverged() {
+    return numProcessed >= constraintQueue.size() || hasReachedLowerBound();
+}
+
+void TemporalTreeOrderComputationPQTree::logConvergence() {
+    if (numProcessed < constraintQueue.size()) {
+        std::stringstream message;
+        message << "Converged by reaching the lower bound " << objectiveLowerBound << ", "
+                << constraintQueue.size() - numProcessed << " constraints were not added.";
+        logInfo(message.str());
+        return;
+    }
+
+    logInfo("Converged by adding all constraints, " + std::to_string(numAccepted) + " of " +
+            std::to_string(constraintQueue.size()) + " are consecutive.");
+    if (numAccepted < constraintQueue.size()) {
+        logInfo("No order keeps the leaves of all constraints consecutive, " +
+                std::to_string(constraintQueue.size() - numAccepted) +
+                " constraints were skipped. Use this order as the input order for the annealing "
+                "to optimize further.");
+    }
+}
+
+void TemporalTreeOrderComputationPQTree::singleStep() {
+    if (!isConverged()) {
+        addConstraint();
+        currentState.iteration++;
+        updateCurrentOrder();
+        logStep();
+        if (currentState.value < bestState.value) {
+            bestState = currentState;
+        }
+        if (isConverged()) logConvergence();
+    }
+}
+
+void TemporalTreeOrderComputationPQTree::runUntilConvergence() {
+    if (isConverged()) return;
+
+    // The order is taken from the tree only now and then, often enough to stop at the lower
+    // bound once the best order has reached it
+    const size_t evaluateEvery = std::max(size_t(1), constraintQueue.size() / 32);
+    while (!isConverged()) {
+        addConstraint();
+        currentState.iteration++;
+
+        if (numProcessed % evaluateEvery == 0 && numProcessed < constraintQueue.size()) {
+            updateCurrentOrder();
+            logStep();
+            if (currentState.value < bestState.value) {
+                timeUntilBest = performanceTimer.ElapsedTime();
+                bestState = currentState;
+            }
+        }
+    }
+
+    updateCurrentOrder();
+    logStep();
+    // Steps done before might have found a better order than the final one
+    if (currentState.value < bestState.value) {
+        timeUntilBest = performanceTimer.ElapsedTime();
+        bestState = currentState;
+    }
+
+    logConvergence();
+}
+
+void TemporalTreeOrderComputationPQTree::updateStateProperties() {
+    TemporalTreeOrderOptimization::updateStateProperties();
+    propConsecutive.set(std::to_string(numAccepted) + " / " + std::to_string(numProcessed));
+}
+
+void TemporalTreeOrderComputationPQTree::logProperties() {
+    const std::vector<std::string> colHeaders{
+        propSeedOrder.getDisplayName(),        propSeedOptimization.getDisplayName(),
+        propHeaviestFirst.getDisplayName(),    propWeightByTypeOnly.getDisplayName(),
+        propWeightTypeOnly.getDisplayName(),   propConsecutive.getDisplayName(),
+        propObjectiveValue.getDisplayName(),   propTimeUntilBest.getDisplayName(),
+        propTimeForLastAction.getDisplayName()};
+
+    const std::vector<std::string> exampleRow{
+        std::to_string(propSeedOrder),        std::to_string(propSeedOptimization),
+        std::to_string(propHeaviestFirst),    std::to_string(propWeightByTypeOnly),
+        std::to_string(propWeightTypeOnly),   std::to_string(numAccepted),
+        std::to_string(bestState.value),      std::to_string(timeUntilBest),
+        std::to_string(propTimeForLastAction)};
+
+    optimizationSettings = createDataFrame({exampleRow}, colHeaders);
+    optimizationSettings->addRow(exampleRow);
+}
+
+void TemporalTreeOrderComputationPQTree::process() {
+    // Do nothing
+}
+
+}  // namespace kth
+}  // namespace inviwo
@@ -34,6 +34,16 @@ TemporalTreeSimulatedAnnealing::TemporalTreeSimulatedAnnealing()
     , propMinimumTemperature("minimumTemperature", "Minimum T", 0, 0, 1, 10e-6)
     , propTemperatureDecay("temperatureDecay", "T Decay", 0.9, 0.6, 0.99, 0.1)
     , propIterationsPerTemp("iterationsPerTemp", "Iters Per T", 10, 1, 1000, 1)
+    , propNeighborhood("neighborhood", "Neighborhood")
+    , propCoolingSchedule("coolingSchedule", "Cooling")
+    , propEstimateInitialTemperature("estimateInitialTemperature", "Estimate Initial T", false)
+    , propInitialAcceptance("initialAcceptance", "Initial Acceptance", 0.8, 0.01, 0.99, 0.01)
+    , propTemperatureSamples("temperatureSamples", "T Samples", 100, 1, 10000, 1)
+    , propReheatAfter("reheatAfter", "Reheat After", 0, 0, 1000000000, 1)
+    , propStopAfter("stopAfter", "Stop After", 0, 0, 1000000000, 1)
+    , propSampledEvaluation("sampledEvaluation", "Sampled Evaluation", false)
+    , propInitialSampleFraction("initialSampleFraction", "Initial Sample", 0.1, 0.001, 1, 0.01)
+    , propExactBelow("exactBelow", "Exact Below T", 0.1, 0.001, 1, 0.01)
     // Current State
     , propCurrentTemperature("currentTemperature", "Current T", 0, 0, 1000, 10e-6) {
     /* Settings */
@@ -56,13 +66,65 @@ TemporalTreeSimulatedAnnealing::TemporalTreeSimulatedAnnealing()
     propIterationsPerTemp.onChange([&]() { restart(); });
     propIterationsPerTemp.setSemantics(PropertySemantics::Text);
 
+    propSimulatedAnnealing.addProperty(propNeighborhood);
+    propNeighborhood.addOption("processorMoves", "Processor Moves", ProcessorMoves);
+    propNeighborhood.addOption("blockMoves", "Subtree and Constraint Blocks", BlockMoves);
+    propNeighborhood.onChange([&]() { restart(); });
+
+    propSimulatedAnnealing.addProperty(propCoolingSchedule);
+    propCoolingSchedule.addOption("exponential", "Exponential", Exponential);
+    propCoolingSchedule.addOption("adaptive", "Adaptive to Acceptance", Adaptive);
+    propCoolingSchedule.onChange([&]() { restart(); });
+
+    propSimulatedAnnealing.addProperty(propEstimateInitialTemperature);
+    propEstimateInitialTemperature.onChange([&]() {
+        propInitialAcceptance.setVisible(propEstimateInitialTemperature);
+        propTemperatureSamples.setVisible(propEstimateInitialTemperature);
+        restart();
+    });
+
+    propSimulatedAnnealing.addProperty(propInitialAcceptance);
+    propInitialAcceptance.onChange([&]() { restart(); });
+    propInitialAcceptance.setSemantics(PropertySemantics::Text);
+    propInitialAcceptance.setVisible(false);
+
+    propSimulatedAnnealing.addProperty(propTemperatureSamples);
+    propTemperatureSamples.onChange([&]() { restart(); });
+    propTemperatureSamples.setSemantics(PropertySemantics::Text);
+    propTemperatureSamples.setVisible(false);
+
+    // Both count iterations since the best state was found
+    propSimulatedAnnealing.addProperty(propReheatAfter);
+    propReheatAfter.setSemantics(PropertySemantics::Text);
+
+    propSimulatedAnnealing.addProperty(propStopAfter);
+    propStopAfter.setSemantics(PropertySemantics::Text);
+
+    propSimulatedAnnealing.addProperty(propSampledEvaluation);
+    propSampledEvaluation.onChange([&]() {
+        propInitialSampleFraction.setVisible(propSampledEvaluation);
+        propExactBelow.setVisible(propSampledEvaluation);
+        restart();
+    });
+
+    propSimulatedAnnealing.addProperty(propInitialSampleFraction);
+    propInitialSampleFraction.onChange([&]() { restart(); });
+    propInitialSampleFraction.setSemantics(PropertySemantics::Text);
+    propInitialSampleFraction.setVisible(false);
+
+    // Relative to the initial temperature
+    propSimulatedAnnealing.addProperty(propExactBelow);
+    propExactBelow.onChange([&]() { restart(); });
+    propExactBelow.setSemantics(PropertySemantics::Text);
+    propExactBelow.setVisible(false);
+
     /* Current state */
     propCurrentState.addProperty(propCurrentTemperature);
     propCurrentTemperature.setSemantics(PropertySemantics::Text);
     propCurrentTemperature.setReadOnly(true);
 }
 
-void TemporalTreeSimulatedAnnealing::swapNodes(std::vector<size_t>& nodes) {
+std::pair<size_t, size_t> TemporalTreeSimulatedAnnealing::swapNodes(std::vector<size_t>& nodes) {
     std::uniform_int_distribution<int> chooseSwapNodes(0, static_cast<int>(nodes.size()) - 1);
     // We have at least two nodes, so we can definately find a pair of nodes to swap
     int swapA = chooseSwapNodes(randomGen);
@@ -74,18 +136,185 @@ void TemporalTreeSimulatedAnnealing::swapNodes(std::vector<size_t>& nodes) {
 
     // LogInfo("Swapped positions " << swapA << " and " << swapB << ".");
     std::swap(nodes[swapA], nodes[swapB]);
+
+    if (swapA > swapB) std::swap(swapA, swapB);
+    return {static_cast<size_t>(swapA), static_cast<size_t>(swapB)};
+}
+
+std::pair<size_t, size_t> TemporalTreeSimulatedAnnealing::moveBlock(
+    TemporalTree::TTreeOrder& order, const treeorder::Permutation& positions,
+    std::mt19937& generator) const {
+    const size_t numLeaves = order.size();
+    if (numLeaves < 2) return {0, 0};
+
+    // Blocks are the leaves of constraints (subtrees for hierarchy constraints)
+    // or single leaves, the latter make sure every leaf can move on its own
+    const size_t numConstraints = flatConstraints.size();
+    std::uniform_int_distribution<size_t> chooseBlock(0, numConstraints + numLeaves - 1);
+    const size_t blockId = chooseBlock(generator);
+
+    size_t begin = 0;
+    size_t end = 0;
+    if (blockId < numConstraints) {
+        begin = numLeaves;
+        std::for_each(flatConstraints.leavesBegin(blockId), flatConstraints.leavesEnd(blockId),
+                      [&](const size_t leaf) {
+                          const size_t position = positions.positionOf(leaf);
+                          begin = std::min(begin, position);
+                          end = std::max(end, position + 1);
+                      });
+        // Constraints without leaves in this order
+        if (begin >= end) return {0, 0};
+    } else {
+        begin = blockId - numConstraints;
+        end = begin + 1;
+    }
+
+    const size_t size = end - begin;
+    const bool canMove = size < numLeaves;
+    const bool canReverse = size > 1;
+
+    auto itBegin = order.begin() + begin;
+    auto itEnd = order.begin() + end;
+    // Local distributions such that replicas can move blocks in parallel
+    std::bernoulli_distribution chooseReverse(0.5);
+    if (canReverse && (!canMove || chooseReverse(generator))) {
+        std::reverse(itBegin, itEnd);
+        return {begin, end};
+    }
+
+    // Move by at most the size of the block to either side
+    const size_t maxLeft = std::min(size, begin);
+    const size_t maxRight = std::min(size, numLeaves - end);
+    std::uniform_int_distribution<size_t> chooseShift(1, maxLeft + maxRight);
+    const size_t shift = chooseShift(generator);
+    if (shift <= maxLeft) {
+        std::rotate(itBegin - shift, itBegin, itEnd);
+        return {begin - shift, end};
+    } else {
+        std::rotate(itBegin, itEnd, itEnd + (shift - maxLeft));
+        return {begin, end + (shift - maxLeft)};
+    }
 }
 
 void TemporalTreeSimulatedAnnealing::decayTemperature() {
+    const double decay = propTemperatureDecay;
+
+    if (propCoolingSchedule.get() == Adaptive) {
+        // Almost everything is accepted: the walk is random, get through this quickly.
+        // Moderate acceptance: this is where the structure of the order forms, spend more
+        // time here. Almost nothing is accepted: back to the usual decay.
+        const double acceptanceRatio =
+            double(numAcceptedAtTemperature) / double(propIterationsPerTemp.get());
+        if (acceptanceRatio > 0.8) {
+            currentTemperature *= decay * decay;
+        } else if (acceptanceRatio > 0.15) {
+            currentTemperature *= std::sqrt(decay);
+        } else {
+            currentTemperature *= decay;
+        }
+        numAcceptedAtTemperature = 0;
+        return;
+    }
+
     // Exponential multiplicative cooling: 0.8 <= temperatureDecay <= 0.9
-    currentTemperature *= propTemperatureDecay;
+    currentTemperature *= decay;
+    numAcceptedAtTemperature = 0;
 
     // Others:
     // Logarithmical multiplicative cooling: temperatureDecay > 1
     // currentTemperature = initialTemperature / 1 + temperatureDecay*(log(1 + currentIteration +
     // 1));
     // ... (7 or so others)
-    propCurrentTemperature.set(currentTemperature);
+}
+
+bool TemporalTreeSimulatedAnnealing::updateTemperature() {
+    bool changed = false;
+
+    // Decay temperature after we have done the specified number of iterations
+    if (currentState.iteration % propIterationsPerTemp == 0) {
+        decayTemperature();
+        changed = true;
+    }
+
+    // Stagnation: go back to the temperature at which we found the best state
+    if (propReheatAfter > 0 &&
+        currentState.iteration - std::max(bestState.iteration, lastReheatIteration) >=
+            size_t(propReheatAfter.get())) {
+        if (bestTemperature > currentTemperature) {
+            currentTemperature = bestTemperature;
+            numAcceptedAtTemperature = 0;
+            changed = true;
+        }
+        lastReheatIteration = currentState.iteration;
+    }
+
+    if (changed) updateSampling();
+
+    return changed;
+}
+
+double TemporalTreeSimulatedAnnealing::proposeNeighbor() {
+    // Generate a neighbor state (Changes current State) and evaluate it
+    if (propNeighborhood.get() == BlockMoves) {
+        // Only the moved block and the leaves it was moved past need to be checked
+        lastBlockRange = moveBlock(currentState.order, evaluator.getPermutation(), randomGen);
+        return evaluateOrderDelta(currentState.order, lastBlockRange.first, lastBlockRange.second,
+                                  &currentState.statistic);
+    } else {
+        neighborSolution();
+        return evaluateNeighbor();
+    }
+}
+
+double TemporalTreeSimulatedAnnealing::estimateInitialTemperature() {
+    // Sample neighbors and reject all of them
+    double sumUphill = 0;
+    size_t numUphill = 0;
+    for (int sample = 0; sample < propTemperatureSamples; sample++) {
+        setLastToCurrent();
+        const double deltaEnergy = proposeNeighbor();
+        revertOrderDelta(&currentState.statistic);
+        setCurrentToLast();
+
+        if (deltaEnergy > 0) {
+            sumUphill += deltaEnergy;
+            numUphill++;
+        }
+    }
+
+    // No uphill moves at all, keep what we have
+    if (numUphill == 0) return currentTemperature;
+
+    // Solve exp(-averageUphill / T) = acceptance for T
+    return -(sumUphill / numUphill) / std::log(propInitialAcceptance.get());
+}
+
+void TemporalTreeSimulatedAnnealing::updateSampling() {
+    if (!propSampledEvaluation) {
+        evaluationSampleEvery = 1;
+        return;
+    }
+
+    const double exactTemperature = propExactBelow * startTemperature;
+    if (currentTemperature <= exactTemperature) {
+        if (isEstimatingObjective()) {
+            // Value, statistic and evaluator are exact again from here on,
+            // as is everything the optimization keeps about the current order
+            evaluationSampleEvery = 1;
+            currentState.value = resetOrderEvaluation(currentState.order, &currentState.statistic);
+            currentOrderChanged();
+        }
+        return;
+    }
+
+    // The fraction grows geometrically from the initial one at the start temperature
+    // to all constraints at the exact temperature
+    const double progress =
+        std::min(1.0, std::max(0.0, std::log(startTemperature / currentTemperature) /
+                                        std::log(startTemperature / exactTemperature)));
+    const double fraction = std::pow(propInitialSampleFraction.get(), 1.0 - progress);
+    evaluationSampleEvery = std::max(size_t(1), size_t(std::round(1.0 / fraction)));
 }
 
 bool TemporalTreeSimulatedAnnealing::acceptNeighbor(double deltaEnergy) const {
@@ -110,24 +339,29 @@ bool TemporalTreeSimulatedAnnealing::acceptNeighbor(double deltaEnergy) const {
     return true;
 }
 
+void TemporalTreeSimulatedAnnealing::updateStateProperties() {
+    TemporalTreeOrderOptimization::updateStateProperties();
+    propCurrentTemperature.set(currentTemperature);
+}
+
 void TemporalTreeSimulatedAnnealing::logProperties() {
     const std::vector<std::string> colHeaders{
         propSeedOrder.getDisplayName(),          propSeedOptimization.getDisplayName(),
         propIterationsMax.getDisplayName(),      propInitialTemperature.getDisplayName(),
         propMinimumTemperature.getDisplayName(), propTemperatureDecay.getDisplayName(),
-        propIterationsPerTemp.getDisplayName(),  propWeightByTypeOnly.getDisplayName(),
-        propWeightTypeOnly.getDisplayName(),     propBestIteration.getDisplayName(),
-        propObjectiveValue.getDisplayName(),     propTimeUntilBest.getDisplayName(),
-        propTimeForLastAction.getDisplayName()};
+        propIterationsPerTemp.getDisplayName(),  propNeighborhood.getDisplayName(),
+        propWeightByTypeOnly.getDisplayName(),   propWeightTypeOnly.getDisplayName(),
+        propBestIteration.getDisplayName(),      propObjectiveValue.getDisplayName(),
+        propTimeUntilBest.getDisplayName(),      propTimeForLastAction.getDisplayName()};
 
     const std::vector<std::string> exampleRow{
         std::to_string(propSeedOrder),          std::to_string(propSeedOptimization),
         std::to_string(propIterationsMax),      std::to_string(propInitialTemperature),
         std::to_string(propMinimumTemperature), std::to_string(propTemperatureDecay),
-        std::to_string(propIterationsPerTemp),  std::to_string(propWeightByTypeOnly),
-        std::to_string(propWeightTypeOnly),     std::to_string(bestState.iteration),
-        std::to_string(bestState.value),        std::to_string(propTimeUntilBest),
-        std::to_string(propTimeForLastAction)};
+        std::to_string(propIterationsPerTemp),  propNeighborhood.getSelectedIdentifier(),
+        std::to_string(propWeightByTypeOnly),   std::to_string(propWeightTypeOnly),
+        std::to_string(bestState.iteration),    std::to_string(bestState.value),
+        std::to_string(timeUntilBest),          std::to_string(propTimeForLastAction)};
 
     optimizationSettings = createDataFrame({exampleRow}, colHeaders);
     optimizationSettings->addRow(exampleRow);
@@ -187,73 +421,121 @@ void TemporalTreeSimulatedAnnealing::restart() {
 
     TemporalTreeOrderOptimization::restart();
 
+    // Nothing to evaluate without a tree
+    if (!getTreeToOrder()) return;
+
+    // Steps are evaluated incrementally with respect to this order
+    evaluationSampleEvery = 1;
+    currentState.value = resetOrderEvaluation(currentState.order, &currentState.statistic);
+
     currentTemperature = propInitialTemperature;
     propCurrentTemperature.set(currentTemperature);
 
+    // The processor might still change the current state after this restart,
+    // so we estimate right before the first step
+    needsTemperatureEstimate = propEstimateInitialTemperature;
+    numAcceptedAtTemperature = 0;
+    bestTemperature = currentTemperature;
+    lastReheatIteration = 0;
+    startTemperature = currentTemperature;
+    updateSampling();
+
     logStep();
 }
 
 bool TemporalTreeSimulatedAnnealing::isConverged() {
     // the iteration number is an index starting at 0, the max is a number >= -1
     if (currentState.iteration > propIterationsMax - 1) {
-        LogProcessorInfo("Converged by reaching maximum number of iterations.");
+        logInfo("Converged by reaching maximum number of iterations.");
         return true;
     }
     if (currentTemperature < propMinimumTemperature) {
-        LogProcessorInfo("Converged by temperature falling below the minimum.");
+        logInfo("Converged by temperature falling below the minimum.");
         return true;
     }
     if (std::abs(currentState.value) < std::numeric_limits<float>::epsilon()) {
-        LogProcessorInfo("Converged by reaching a global optimum.");
+        logInfo("Converged by reaching a global optimum.");
+        return true;
+    }
+    if (hasReachedLowerBound()) {
+        std::stringstream message;
+        message << "Converged by reaching the lower bound " << objectiveLowerBound << ".";
+        logInfo(message.str());
+        return true;
+    }
+
+    if (propStopAfter > 0 &&
+        currentState.iteration - bestState.iteration >= size_t(propStopAfter.get())) {
+        logInfo("Converged by not improving for " + std::to_string(propStopAfter.get()) +
+                " iterations.");
         return true;
     }
 
-    // TODO: Iterations with no improvement
     return false;
 }
 
+double TemporalTreeSimulatedAnnealing::evaluateNeighbor() {
+    // Only constraints affected by the change need to be checked
+    return evaluateOrderDelta(currentState.order, &currentState.statistic);
+}
+
 void TemporalTreeSimulatedAnnealing::singleStep() {
     if (isConverged()) {
         return;
     }
 
-    setLastToCurrent();
-
-    // Generate a neighbor state (Changes current State)
-    neighborSolution();
+    if (needsTemperatureEstimate) {
+        // Estimate from exact changes in energy
+        evaluationSampleEvery = 1;
+        currentTemperature = estimateInitialTemperature();
+        bestTemperature = currentTemperature;
+        startTemperature = currentTemperature;
+        needsTemperatureEstimate = false;
+        std::stringstream message;
+        message << "Estimated initial temperature: " << currentTemperature;
+        logInfo(message.str());
+        updateSampling();
+    }
 
-    // Evaluate new state
-    currentState.statistic.clear();
-    currentState.value = evaluateOrder(currentState.order, &currentState.statistic);
+    setLastToCurrent();
 
-    lastDeltaEnergy = currentState.value - lastState.value;
+    lastDeltaEnergy = proposeNeighbor();
+    // The evaluator does not know the value of an estimate
+    currentState.value =
+        isEstimatingObjective() ? currentState.value + lastDeltaEnergy : evaluator.value();
 
     // Check if we can accept the new solution
-    if (!acceptNeighbor(currentState.value - lastState.value)) {
-        // Go back to the previous state
+    if (!acceptNeighbor(lastDeltaEnergy)) {
+        // Go back to the previous state, the statistic is reverted along with the evaluation
+        // for states that do not keep a copy of it
+        revertOrderDelta(&currentState.statistic);
         setCurrentToLast();
         lastAccepted = false;
     } else {
+        // Estimates might be off, the best state is only updated with exact values
+        if (currentState.value < bestState.value && isEstimatingObjective()) {
+            currentState.value = resetOrderEvaluation(currentState.order, &currentState.statistic);
+        }
+
         // Prepare the next step
         prepareNextStep();
 
         // Update best
         if (currentState.value < bestState.value) {
-            propTimeUntilBest.set(performanceTimer.ElapsedTime());
+            timeUntilBest = performanceTimer.ElapsedTime();
             setBest();
+            bestTemperature = currentTemperature;
         }
 
         lastAccepted = true;
+        numAcceptedAtTemperature++;
     }
 
     // Update for the next step
     currentState.iteration++;
     logStep();
 
-    // Decay temperature after we have done the specified number of iterations
-    if (currentState.iteration % propIterationsPerTemp == 0) {
-        decayTemperature();
-    }
+    updateTemperature();
 }
 
 void TemporalTreeSimulatedAnnealing::runUntilConvergence() {
@@ -46,6 +46,7 @@ TemporalTreeOrderComputationSAConstraints::TemporalTreeOrderComputationSAConstra
     });
 
     propSingleStep.onChange([&]() {
+        stopBackgroundRun();
         if (!initialized) initializeResources();
         performanceTimer.Reset();
         if (!isConverged()) {
@@ -68,10 +69,11 @@ TemporalTreeOrderComputationSAConstraints::TemporalTreeOrderComputationSAConstra
     });
 
     propRunUntilConvergence.onChange([&]() {
+        stopBackgroundRun();
         if (!initialized || currentState.iteration != 0) initializeResources();
         restart();
         performanceTimer.Reset();
-        runUntilConvergence();
+        runUntilConvergenceByComponents();
         propTimeForLastAction.set(performanceTimer.ElapsedTimeAndReset());
         if (propSaveLog) {
             saveLog();
@@ -92,8 +94,9 @@ void TemporalTreeOrderComputationSAConstraints::resolveConstraint(
     TemporalTree::TTreeOrder conflictingLeaves;
     TemporalTree::TTreeOrder nonConflictingAndConstraintLeaves;
 
+    // The evaluator holds the positions for the current order
     TemporalTreeOrderComputationHeuristic::findConflictingLeaves(
-        pInputTree, constraint, currentState.order, minOrder, maxOrder, conflictingLeaves,
+        pInputTree, constraint, evaluator.getPermutation(), minOrder, maxOrder, conflictingLeaves,
         nonConflictingAndConstraintLeaves);
 
     TemporalTree::TTreeOrder temporaryOrder;
@@ -108,7 +111,9 @@ void TemporalTreeOrderComputationSAConstraints::resolveConstraint(
                 temporaryOrder, currentState.order, numConflictBefore, conflictingLeaves,
                 nonConflictingAndConstraintLeaves, minOrder, maxOrder);
 
-            double newValue = evaluateOrder(temporaryOrder);
+            // Only evaluate the change and go back to the current order afterwards
+            double newValue = currentState.value + evaluateOrderDelta(temporaryOrder, nullptr);
+            revertOrderDelta();
 
             // The new value is the same as best
             if (std::abs(bestValue - newValue) < std::numeric_limits<double>::epsilon()) {
@@ -145,6 +150,9 @@ void TemporalTreeOrderComputationSAConstraints::resolveConstraint(
 }
 
 void TemporalTreeOrderComputationSAConstraints::neighborSolution() {
+    // Nothing to resolve, the order stays as it is
+    if (unfulfilledConstraints.empty()) return;
+
     std::uniform_int_distribution<int> chooseConstraintToResolve(
         0, static_cast<int>(unfulfilledConstraints.size()) - 1);
 
@@ -154,7 +162,9 @@ void TemporalTreeOrderComputationSAConstraints::neighborSolution() {
 }
 
 void TemporalTreeOrderComputationSAConstraints::initializeResources() {
-    std::shared_ptr<const TemporalTree> pTreeIn = portInTree.getData();
+    stopBackgroundRun();
+
+    std::shared_ptr<const TemporalTree> pTreeIn = getTreeToOrder();
     if (!pTreeIn) return;
 
     pInputTree = pTreeIn;
@@ -176,6 +186,11 @@ void TemporalTreeOrderComputationSAConstraints::restart() {
     prepareNextStep();
 }
 
+void TemporalTreeOrderComputationSAConstraints::currentOrderChanged() {
+    lastState = currentState;
+    prepareNextStep();
+}
+
 void TemporalTreeOrderComputationSAConstraints::setLastToCurrent() { lastState = currentState; }
 
 void TemporalTreeOrderComputationSAConstraints::setCurrentToLast() { currentState = lastState; }
@@ -183,14 +198,14 @@ void TemporalTreeOrderComputationSAConstraints::setCurrentToLast() { currentStat
 void TemporalTreeOrderComputationSAConstraints::setBest() { bestState = currentState; }
 
 void TemporalTreeOrderComputationSAConstraints::prepareNextStep() {
-    unfulfilledConstraints.clear();
-
-    size_t constraintId(0);
-    for (auto& constraint : constraints) {
-        if (!constraint.fulfilled) {
-            unfulfilledConstraints.push_back(constraintId);
-        }
-        constraintId++;
+    // The evaluator keeps track of the unfulfilled constraints for the current order
+    unfulfilledConstraints = evaluator.getUnfulfilled();
+
+    // While estimating, constraints that were not sampled keep their previous state.
+    // Unfulfilled constraints might be missing, we only know for sure after a full evaluation.
+    if (unfulfilledConstraints.empty() && isEstimatingObjective()) {
+        currentState.value = resetOrderEvaluation(currentState.order, &currentState.statistic);
+        unfulfilledConstraints = evaluator.getUnfulfilled();
     }
 }
 
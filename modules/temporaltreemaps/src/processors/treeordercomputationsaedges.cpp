@@ -9,6 +9,7 @@
  */
 
 #include <modules/temporaltreemaps/processors/treeordercomputationsaedges.h>
+#include <functional>
 
 namespace inviwo {
 namespace kth {
@@ -29,6 +30,13 @@ const ProcessorInfo TemporalTreeOrderComputationSAEdges::getProcessorInfo() cons
 TemporalTreeOrderComputationSAEdges::TemporalTreeOrderComputationSAEdges()
     : TemporalTreeSimulatedAnnealing() {
 
+    /* Settings */
+
+    // Swapping children already moves whole subtree blocks, the moves need to stay consistent
+    // with the heuristic edges such that rejected swaps can be undone
+    propNeighborhood.setSelectedValue(ProcessorMoves);
+    propNeighborhood.setVisible(false);
+
     /* Controls */
 
     propRestart.onChange([&]() {
@@ -41,6 +49,7 @@ TemporalTreeOrderComputationSAEdges::TemporalTreeOrderComputationSAEdges()
     });
 
     propSingleStep.onChange([&]() {
+        stopBackgroundRun();
         if (!initialized) initializeResources();
         performanceTimer.Reset();
         singleStep();
@@ -61,10 +70,11 @@ TemporalTreeOrderComputationSAEdges::TemporalTreeOrderComputationSAEdges()
     });
 
     propRunUntilConvergence.onChange([&]() {
+        stopBackgroundRun();
         if (!initialized || currentState.iteration != 0) initializeResources();
         restart();
         performanceTimer.Reset();
-        runUntilConvergence();
+        runUntilConvergenceByComponents();
         propTimeForLastAction.set(performanceTimer.ElapsedTimeAndReset());
         if (propSaveLog) {
             saveLog();
@@ -93,7 +103,17 @@ void TemporalTreeOrderComputationSAEdges::restart() {
 
     currentState.order.clear();
     treeorder::orderAsDepthFirst(currentState.order, *pInputTree, currentEdges);
-    currentState.value = evaluateOrder(currentState.order, &currentState.statistic);
+    currentState.value = resetOrderEvaluation(currentState.order, &currentState.statistic);
+
+    // Leaf blocks of the heuristic edges in the order, swaps only move these blocks around
+    const size_t numNodes = pInputTree->nodes.size();
+    parentInEdges.assign(numNodes, std::numeric_limits<size_t>::max());
+    numLeavesInEdges.assign(numNodes, 0);
+    offsetInEdges.assign(numNodes, 0);
+    computeLeafRanges(0, 0);
+    ivwAssert(numLeavesInEdges[0] == currentState.order.size(),
+              "Leaf blocks need to cover the whole order.");
+    lastSwap = SwapRecord();
 
     float averageDegree = 0;
 
@@ -112,28 +132,69 @@ void TemporalTreeOrderComputationSAEdges::restart() {
                                  << " with average degree: " << averageDegree / activeNodes.size());
     }
 
-    lastEdges = currentEdges;
-    bestEdges = currentEdges;
-
     bestState = currentState;
     lastState = currentState;
 
     logStep();
 }
 
-void TemporalTreeOrderComputationSAEdges::setLastToCurrent() {
-    lastEdges = currentEdges;
+void TemporalTreeOrderComputationSAEdges::currentOrderChanged() {
+    // Children are sorted by the first position of a leaf below them
+    const size_t numNodes = pInputTree->nodes.size();
+    const size_t noPosition = std::numeric_limits<size_t>::max();
+    std::vector<size_t> firstPositions(numNodes, noPosition);
+    for (size_t position(0); position < currentState.order.size(); position++) {
+        firstPositions[currentState.order[position]] = position;
+    }
+    std::function<size_t(size_t)> sortChildren = [&](const size_t nodeIndex) {
+        size_t firstPosition = firstPositions[nodeIndex];
+        const auto itEdges = currentEdges.find(nodeIndex);
+        if (itEdges == currentEdges.end()) return firstPosition;
+        for (auto child : itEdges->second) {
+            firstPosition = std::min(firstPosition, sortChildren(child));
+        }
+        std::stable_sort(itEdges->second.begin(), itEdges->second.end(),
+                         [&](const size_t a, const size_t b) {
+                             return firstPositions[a] < firstPositions[b];
+                         });
+        firstPositions[nodeIndex] = firstPosition;
+        return firstPosition;
+    };
+    sortChildren(0);
+
+    // The order might not be reachable with the heuristic edges, we continue from the closest one
+    TemporalTree::TTreeOrder order;
+    treeorder::orderAsDepthFirst(order, *pInputTree, currentEdges);
+    if (order != currentState.order) {
+        currentState.order = order;
+        currentState.value = resetOrderEvaluation(currentState.order, &currentState.statistic);
+    }
+
+    computeLeafRanges(0, 0);
+    lastSwap = SwapRecord();
     lastState = currentState;
 }
 
+void TemporalTreeOrderComputationSAEdges::setLastToCurrent() {
+    // Edges and order are restored by undoing the last swap,
+    // the statistic is restored by the evaluator
+    lastState.iteration = currentState.iteration;
+    lastState.value = currentState.value;
+}
+
 void TemporalTreeOrderComputationSAEdges::setCurrentToLast() {
-    currentEdges = lastEdges;
-    currentState = lastState;
+    // Swapping the same two children again undoes the swap
+    std::vector<size_t>& children = currentEdges.at(lastSwap.node);
+    std::swap(children[lastSwap.first], children[lastSwap.second]);
+    exchangeLeafBlocks(lastSwap.node, lastSwap.first, lastSwap.second);
+
+    currentState.iteration = lastState.iteration;
+    currentState.value = lastState.value;
 }
 
 void TemporalTreeOrderComputationSAEdges::setBest() {
+    // The order is all we output, the edges are not needed for that
     bestState = currentState;
-    bestEdges = currentEdges;
 }
 
 void TemporalTreeOrderComputationSAEdges::prepareNextStep() {
@@ -143,17 +204,86 @@ void TemporalTreeOrderComputationSAEdges::prepareNextStep() {
 void TemporalTreeOrderComputationSAEdges::neighborSolution() {
     // TODO: Maybe consider Dynamic Neighbourhood Size in Simulated Annealing
     // Choose one node for which we want to swap to children
-    std::vector<size_t>& nodes = currentEdges.at(activeNodes[chooseNode(randomGen)]);
+    const size_t nodeIndex = activeNodes[chooseNode(randomGen)];
+    std::vector<size_t>& nodes = currentEdges.at(nodeIndex);
     ivwAssert(nodes.size() >= 2, "");
     // LogInfo("Swapped at position " << index << ".");
-    swapNodes(nodes);
+    const auto swapped = swapNodes(nodes);
 
-    currentState.order.clear();
-    treeorder::orderAsDepthFirst(currentState.order, *pInputTree, currentEdges);
+    // Instead of a new depth first order, only the leaves of the
+    // two children and everything in between are moved
+    exchangeLeafBlocks(nodeIndex, swapped.first, swapped.second);
+}
+
+double TemporalTreeOrderComputationSAEdges::evaluateNeighbor() {
+    return evaluateOrderDelta(currentState.order, lastSwap.beginPosition, lastSwap.endPosition,
+                              &currentState.statistic);
+}
+
+size_t TemporalTreeOrderComputationSAEdges::computeLeafRanges(const size_t nodeIndex,
+                                                              const size_t offset) {
+    offsetInEdges[nodeIndex] = offset;
+
+    // Same as the depth first order: a leaf comes before its children in the heuristic edges
+    size_t numLeaves = pInputTree->isLeaf(nodeIndex) ? 1 : 0;
+
+    const auto itEdges = currentEdges.find(nodeIndex);
+    if (itEdges != currentEdges.end()) {
+        for (auto child : itEdges->second) {
+            parentInEdges[child] = nodeIndex;
+            numLeaves += computeLeafRanges(child, numLeaves);
+        }
+    }
+
+    numLeavesInEdges[nodeIndex] = numLeaves;
+    return numLeaves;
+}
+
+size_t TemporalTreeOrderComputationSAEdges::firstLeafPosition(size_t nodeIndex) const {
+    size_t position = 0;
+    while (nodeIndex != 0) {
+        position += offsetInEdges[nodeIndex];
+        nodeIndex = parentInEdges[nodeIndex];
+    }
+    return position;
+}
+
+void TemporalTreeOrderComputationSAEdges::exchangeLeafBlocks(const size_t nodeIndex,
+                                                             const size_t first,
+                                                             const size_t second) {
+    const std::vector<size_t>& children = currentEdges.at(nodeIndex);
+    // Children have already been swapped, offsets still refer to the previous arrangement
+    const size_t nodeA = children[second];
+    const size_t nodeB = children[first];
+    const size_t sizeA = numLeavesInEdges[nodeA];
+    const size_t sizeB = numLeavesInEdges[nodeB];
+
+    const size_t parentPosition = firstLeafPosition(nodeIndex);
+    const size_t beginPosition = parentPosition + offsetInEdges[nodeA];
+    const size_t endPosition = parentPosition + offsetInEdges[nodeB] + sizeB;
+
+    // [A][between][B] -> [B][A][between] -> [B][between][A]
+    auto itBegin = currentState.order.begin() + beginPosition;
+    auto itEnd = currentState.order.begin() + endPosition;
+    std::rotate(itBegin, itEnd - sizeB, itEnd);
+    std::rotate(itBegin + sizeB, itBegin + sizeB + sizeA, itEnd);
+
+    // Only the children in between change their offsets, everything below moves along
+    size_t offset = offsetInEdges[nodeA];
+    for (size_t i = first; i <= second; i++) {
+        offsetInEdges[children[i]] = offset;
+        offset += numLeavesInEdges[children[i]];
+    }
+
+    lastSwap.node = nodeIndex;
+    lastSwap.first = first;
+    lastSwap.second = second;
+    lastSwap.beginPosition = beginPosition;
+    lastSwap.endPosition = endPosition;
 }
 
 void TemporalTreeOrderComputationSAEdges::initializeResources() {
-    std::shared_ptr<const TemporalTree> pTreeIn = portInTree.getData();
+    std::shared_ptr<const TemporalTree> pTreeIn = getTreeToOrder();
     if (!pTreeIn) return;
 
     /* Initialize merge/split constraints and tree */
@@ -0,0 +1,73 @@
+/*********************************************************************
+ *  Author  : Tino Weinkauf and Wiebke Koepp
+ *  Init    : Saturday, October 17, 2026 - 19:31:05
+ *
+ *  Project : KTH Inviwo Modules
+ *
+ *  License : Follows the Inviwo BSD license model
+ *********************************************************************
+ */
+
+#include <modules/temporaltreemaps/processors/treesnapshot.h>
+
+namespace inviwo {
+namespace kth {
+
+// The Class Identifier has to be globally unique. Use a reverse DNS naming scheme
+const ProcessorInfo TemporalTreeSnapshot::processorInfo_{
+    "org.inviwo.TemporalTreeSnapshot",  // Class identifier
+    "Tree Snapshot",                    // Display name
+    "Temporal Tree",                    // Category
+    CodeState::Experimental,            // Code state
+    Tags::None,                         // Tags
+};
+
+const ProcessorInfo TemporalTreeSnapshot::getProcessorInfo() const { return processorInfo_; }
+
+TemporalTreeSnapshot::TemporalTreeSnapshot()
+    : Processor()
+    , portInTree("inTree")
+    , portOutTree("outTree")
+    , propTime("time", "Time", 0)
+    , propDeltaTime("deltaTime", "Duration", 1, 1)
+    , propAccumulate("accumulate", "Accumulate", true) {
+    addPort(portInTree);
+    addPort(portOutTree);
+
+    portInTree.onChange([this]() {
+        std::shared_ptr<const TemporalTree> pInTree = portInTree.getData();
+        if (!pInTree || pInTree->nodes.empty()) return;
+        const uint64_t tMin = pInTree->nodes[0].startTime();
+        const uint64_t tMax = pInTree->nodes[0].endTime();
+        propTime.setMinValue(tMin);
+        propTime.setMaxValue(tMax);
+        propTime.set(std::min(std::max(propTime.get(), size_t(tMin)), size_t(tMax)));
+    });
+
+    addProperty(propTime);
+    addProperty(propDeltaTime);
+    addProperty(propAccumulate);
+}
+
+void TemporalTreeSnapshot::process() {
+    std::shared_ptr<const TemporalTree> pInTree = portInTree.getData();
+    if (!pInTree) return;
+
+    // Only index the tree again if it has changed
+    if (pInTree != pIndexedTree) {
+        intervalIndex.build(*pInTree);
+        pIndexedTree = pInTree;
+    }
+
+    auto pOutTree = std::make_shared<TemporalTree>(pInTree->getHierarchyAt(
+        intervalIndex, propTime.get(), propAccumulate.get(), propDeltaTime.get()));
+
+    if (pOutTree->nodes.empty()) {
+        LogProcessorWarn("The tree does not exist at time " << propTime.get() << ".");
+    }
+
+    portOutTree.setData(pOutTree);
+}
+
+}  // namespace kth
+}  // namespace inviwo
@@ -9,6 +9,8 @@
  */
 
 #include <modules/temporaltreemaps/processors/treestatistics.h>
+#include <modules/temporaltreemaps/datastructures/treetopology.h>
+#include <modules/temporaltreemaps/datastructures/treevaluecolumns.h>
 
 #ifndef __clang__
 #include <omp.h>
@@ -77,17 +79,20 @@ void TemporalTreeStatistics::process() {
     if (!pTree) return;
 
     // Statistics for the given tree in its current, likely aggregated, form
-    const size_t MaxLevel(pTree->getNumLevels(0));
-    const size_t NumLeaves = pTree->getLeaves().size();
+    const TemporalTreeTopology Topology(*pTree);
+    const size_t MaxLevel(Topology.numLevels());
+    const size_t NumLeaves = Topology.leaves().size();
     uint64_t tMin, tMax;
     pTree->getMinMaxTime(0, tMin, tMax);
     const size_t NumNodes(pTree->nodes.size());
     const size_t NumHierarchyEdges(pTree->getNumHierarchyEdges());
     const size_t NumTimeEdges(pTree->getNumTimeEdges());
 
-    // Get all time steps
+    // Get all time steps, nodes know their range on them
     std::set<uint64_t> AllTimeSteps;
     pTree->getTimes(0, AllTimeSteps);
+    TemporalTreeValueColumns Columns;
+    Columns.build(*pTree, AllTimeSteps);
 
     GenerateStatisticsString(MaxLevel, NumLeaves, tMin, tMax, NumNodes, NumHierarchyEdges,
                              NumTimeEdges, AllTimeSteps.size(), propStatGivenTree);
@@ -108,28 +113,24 @@ void TemporalTreeStatistics::process() {
     //NANumLeaves)
     for (signed long long i(0); i < iNumNodes; i++) {
         // This node would be as many nodes as we have time steps in its interval
-        const uint64_t tNodeMin = pTree->nodes[i].startTime();
-        const uint64_t tNodeMax = pTree->nodes[i].endTime();
-        auto itStart = AllTimeSteps.find(tNodeMin);
-        auto itEnd = AllTimeSteps.find(tNodeMax);
-        const size_t NumAggregatedTimeStepHops = std::distance(itStart, itEnd);
+        const size_t idxNodeMin = Columns.startIndex(i);
+        const size_t idxNodeMax = Columns.endIndex(i);
+        const size_t NumAggregatedTimeStepHops = idxNodeMax - idxNodeMin;
 
         NANumNodes += NumAggregatedTimeStepHops + 1;
         NANumTimeEdges += NumAggregatedTimeStepHops;
 
         // Leaf?
-        if (pTree->isLeaf(i)) NANumLeaves += NumAggregatedTimeStepHops + 1;
+        if (Topology.isLeaf(i)) NANumLeaves += NumAggregatedTimeStepHops + 1;
 
         // The children of this node have as many edges as we have overlapping time steps
-        const auto Children = pTree->getHierarchicalChildren(i);
+        const auto Children = Topology.children(i);
         for (const size_t& idxChild : Children) {
-            const uint64_t tChildMin = pTree->nodes[idxChild].startTime();
-            const uint64_t tChildMax = pTree->nodes[idxChild].endTime();
+            const size_t idxChildMin = Columns.startIndex(idxChild);
+            const size_t idxChildMax = Columns.endIndex(idxChild);
 
-            auto itChildNodeStart = AllTimeSteps.find(tChildMin > tNodeMin ? tChildMin : tNodeMin);
-            auto itChildNodeEnd = AllTimeSteps.find(tChildMax < tNodeMax ? tChildMax : tNodeMax);
             const size_t NumAggregatedChildTimeStepHops =
-                std::distance(itChildNodeStart, itChildNodeEnd);
+                std::min(idxChildMax, idxNodeMax) - std::max(idxChildMin, idxNodeMin);
 
             NANumHierarchyEdges += NumAggregatedChildTimeStepHops + 1;
         }
@@ -27,11 +27,14 @@
 #include <modules/temporaltreemaps/processors/treelayoutcomputation.h>
 #include <modules/temporaltreemaps/processors/treecushioncomputation.h>
 #include <modules/temporaltreemaps/processors/treestatistics.h>
+#include <modules/temporaltreemaps/processors/treesnapshot.h>
 #include <modules/temporaltreemaps/processors/treeordercomputationheuristic.h>
 #include <modules/temporaltreemaps/processors/treeordercomputationsaconstraints.h>
 #include <modules/temporaltreemaps/processors/treeordercomputationsanodes.h>
 #include <modules/temporaltreemaps/processors/treeordercomputationsaedges.h>
 #include <modules/temporaltreemaps/processors/treeordercomputationgreedy.h>
+#include <modules/temporaltreemaps/processors/treeordercomputationparalleltempering.h>
+#include <modules/temporaltreemaps/processors/treeordercomputationpqtree.h>
 #include <modules/temporaltreemaps/processors/ntgrenderer.h>
 
 namespace inviwo {
@@ -61,11 +64,14 @@ TemporalTreeMapsModule::TemporalTreeMapsModule(InviwoApplication* app)
     registerProcessor<TemporalTreeCushionComputation>();
     registerProcessor<TemporalTreeGenerateFromCSV>();
     registerProcessor<TemporalTreeStatistics>();
+    registerProcessor<TemporalTreeSnapshot>();
     registerProcessor<TemporalTreeOrderComputationHeuristic>();
     registerProcessor<TemporalTreeOrderComputationSAEdges>();
     registerProcessor<TemporalTreeOrderComputationSAConstraints>();
     registerProcessor<TemporalTreeOrderComputationSANodes>();
     registerProcessor<TemporalTreeOrderComputationGreedy>();
+    registerProcessor<TemporalTreeOrderComputationParallelTempering>();
+    registerProcessor<TemporalTreeOrderComputationPQTree>();
     registerProcessor<NTGRenderer>();
 
     // Properties